@@ -0,0 +1,487 @@
+#include "ModelBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <date/date.h>
+#include <fmt/format.h>
+
+#include "Market/Model/CandlePatterns.h"
+#include "Market/Model/CorrelationMatrix.h"
+#include "Market/Model/DataLoader.h"
+#include "Market/Model/PatternScanner.h"
+#include "Market/Model/Screener.h"
+#include "Utility/Stopwatch.h"
+#include "Utility/WorkStealingPool.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr uint32_t MODEL_REPEATS = 5;    // Loads are timed as the best of this many runs.
+
+constexpr uint32_t CORRELATION_DAYS    = 250;
+constexpr double CORRELATION_TOLERANCE = 1e-5;    // Largest difference allowed between two computations of a correlation.
+
+constexpr uint32_t PATTERN_ROWS  = 1024;    // Rows of the synthetic candles, the capacity of the ring.
+constexpr uint32_t PATTERN_PAGE  = 64;      // Rows added or dropped at once.
+constexpr uint32_t PATTERN_STEPS = 1000;    // Pages timed, and pages added and dropped before the check.
+constexpr uint32_t PATTERN_SEED  = 7;
+
+// Latest close above its 200-date average on a volume spike, ranked by the size of the spike. RecomputeScreen spells it out.
+constexpr std::string_view SCREEN_TEXT = "close > sma(close, 200) and volume > 1.5 * avg(volume, 20) rank by volume / avg(volume, 20) desc limit 50";
+constexpr uint32_t SCREEN_DAYS         = 300;    // Dates of the universe, deeper than the screen needs.
+
+
+// Closes of every code on the dates of a correlation window, one row of closes per date in the order of the codes, NaN where a code
+// did not trade.
+struct CloseRows
+{
+    std::vector<date::sys_days> dates;
+    std::vector<float> closes;
+};
+
+
+CloseRows LoadCloseRows(DataLoader& aDataLoader, const std::vector<std::string>& aCodes, const uint32_t aDays)
+{
+    CloseRows lRows;
+
+    aDataLoader.LoadCloses(date::sys_days{}, aDays + 1, [&lRows, &aCodes](const std::string& aCode, const date::sys_days aDate, const float aClose) {
+        if (lRows.dates.empty() || lRows.dates.back() != aDate)
+        {
+            lRows.dates.push_back(aDate);
+            lRows.closes.resize(lRows.closes.size() + aCodes.size(), std::numeric_limits<float>::quiet_NaN());
+        }
+
+        if (const auto lCode = std::lower_bound(aCodes.cbegin(), aCodes.cend(), aCode); lCode != aCodes.cend() && *lCode == aCode)
+            lRows.closes[lRows.closes.size() - aCodes.size() + (lCode - aCodes.cbegin())] = aClose;
+    });
+
+    return lRows;
+}
+
+
+// Correlations of every pair i < j, row by row like CorrelationMatrix::UpperTriangle, from the same float returns but with the means
+// taken first and every sum in double.
+std::vector<double> ReferenceCorrelations(const CloseRows& aRows, const size_t aCount, const uint32_t aDays)
+{
+    // The window is a ring of aDays returns that starts at 0, the first date only provides closes. The order of the days does not
+    // change a correlation.
+    std::vector<double> lReturns(aCount * aDays, 0.0);
+    std::vector<float> lLastCloses(aCount, std::numeric_limits<float>::quiet_NaN());
+
+    for (size_t d = 0; d < aRows.dates.size(); ++d)
+    {
+        for (size_t i = 0; i < aCount; ++i)
+        {
+            const auto lClose = aRows.closes[d * aCount + i];
+
+            lReturns[i * aDays + d % aDays] = std::isnan(lClose) || std::isnan(lLastCloses[i]) ? 0.f : lClose / lLastCloses[i] - 1.f;
+
+            if (!std::isnan(lClose))
+                lLastCloses[i] = lClose;
+        }
+    }
+
+    std::vector<double> lMeans(aCount);
+
+    for (size_t i = 0; i < aCount; ++i)
+    {
+        const auto lBegin = lReturns.cbegin() + i * aDays;
+
+        lMeans[i] = std::accumulate(lBegin, lBegin + aDays, 0.0) / aDays;
+    }
+
+    std::vector<double> lCorrelations;
+    lCorrelations.reserve(aCount * (aCount - std::min<size_t>(aCount, 1)) / 2);
+
+    for (size_t i = 0; i < aCount; ++i)
+    {
+        for (auto j = i + 1; j < aCount; ++j)
+        {
+            double lCovariance = 0.0;
+            double lFirst      = 0.0;
+            double lSecond     = 0.0;
+
+            for (size_t k = 0; k < aDays; ++k)
+            {
+                const auto lX = lReturns[i * aDays + k] - lMeans[i];
+                const auto lY = lReturns[j * aDays + k] - lMeans[j];
+
+                lCovariance += lX * lY;
+                lFirst += lX * lX;
+                lSecond += lY * lY;
+            }
+
+            lCorrelations.push_back(lFirst > 0.0 && lSecond > 0.0 ? lCovariance / std::sqrt(lFirst * lSecond) : std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    return lCorrelations;
+}
+
+
+// Largest difference between two upper triangles, infinite when only one of them has a correlation for a pair.
+template <typename T, typename U>
+double MaxError(const std::vector<T>& aFirst, const std::vector<U>& aSecond)
+{
+    double lError = 0.0;
+
+    for (size_t i = 0; i < aFirst.size(); ++i)
+    {
+        if (std::isnan(aFirst[i]) != std::isnan(aSecond[i]))
+            return std::numeric_limits<double>::infinity();
+
+        if (!std::isnan(aFirst[i]))
+            lError = std::max(lError, std::abs(static_cast<double>(aFirst[i]) - static_cast<double>(aSecond[i])));
+    }
+
+    return lError;
+}
+
+
+// Candles ordered by date descending, like a page.
+struct CandlePage
+{
+    std::vector<float> opens;
+    std::vector<float> closes;
+    std::vector<float> lows;
+    std::vector<float> highs;
+
+    [[nodiscard]] size_t size() const
+    {
+        return opens.size();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto begin() const
+    {
+        if constexpr (std::is_same_v<Tag, open_tag>)
+            return opens.cbegin();
+        else if constexpr (std::is_same_v<Tag, close_tag>)
+            return closes.cbegin();
+        else if constexpr (std::is_same_v<Tag, low_tag>)
+            return lows.cbegin();
+        else
+            return highs.cbegin();
+    }
+};
+
+
+// Candles around 100 with small bodies now and then and shadows of varying length, so that every pattern matches some rows.
+CandlePage RandomCandles(std::mt19937& aEngine, const uint32_t aCount)
+{
+    std::uniform_real_distribution<float> lPrices{90.f, 110.f};
+    std::uniform_real_distribution<float> lShadows{0.f, 4.f};
+    std::bernoulli_distribution lDoji{0.2};
+
+    CandlePage lPage;
+
+    for (uint32_t i = 0; i < aCount; ++i)
+    {
+        const auto lOpen  = lPrices(aEngine);
+        const auto lClose = lDoji(aEngine) ? lOpen + 0.01f : lPrices(aEngine);
+
+        lPage.opens.push_back(lOpen);
+        lPage.closes.push_back(lClose);
+        lPage.lows.push_back(std::min(lOpen, lClose) - lShadows(aEngine));
+        lPage.highs.push_back(std::max(lOpen, lClose) + lShadows(aEngine));
+    }
+
+    return lPage;
+}
+
+
+// SCREEN_TEXT code by code with the same float operations as Screen::Run, every code evaluated, ranked with a full sort.
+std::vector<ScreenResult> RecomputeScreen(const ScreenUniverse& aUniverse)
+{
+    const auto Average = [&aUniverse](const float* aBars, const uint32_t aPeriod) {
+        return static_cast<float>(std::accumulate(aBars + aUniverse.Days() - aPeriod, aBars + aUniverse.Days(), 0.0) / aPeriod);
+    };
+
+    const auto lLatest = aUniverse.Days() - 1;
+    std::vector<ScreenResult> lResults;
+
+    for (size_t i = 0; i < aUniverse.Count(); ++i)
+    {
+        const auto lCloses  = aUniverse.Bars(ScreenField::eClose, i);
+        const auto lVolumes = aUniverse.Bars(ScreenField::eVolume, i);
+        const auto lVolume  = Average(lVolumes, 20);
+
+        if (lCloses[lLatest] > Average(lCloses, 200) && lVolumes[lLatest] > 1.5f * lVolume)
+            lResults.push_back({aUniverse.Codes()[i], lVolumes[lLatest] / lVolume});
+    }
+
+    std::stable_sort(lResults.begin(), lResults.end(), [](const ScreenResult& aFirst, const ScreenResult& aSecond) { return aFirst.score > aSecond.score; });
+    lResults.resize(std::min<size_t>(lResults.size(), 50));
+
+    return lResults;
+}
+
+
+uint32_t CheckError(const std::string_view aName, const double aError, const double aTolerance)
+{
+    if (aError <= aTolerance)
+        return 0;
+
+    fmt::print(stderr, "{}: error {:.2e} exceeds {:.0e}\n", aName, aError, aTolerance);
+
+    return 1;
+}
+
+
+// Full load, sliding the window date by date and saving, the matrices of both paths against each other and against the reference.
+uint32_t BenchCorrelations(DataLoader& aDataLoader)
+{
+    auto lLoadMs = std::numeric_limits<double>::infinity();
+    auto lFull   = CorrelationMatrix::Load(aDataLoader, CORRELATION_DAYS);
+
+    for (uint32_t i = 0; i < MODEL_REPEATS; ++i)
+        lLoadMs = std::min(lLoadMs, Stopwatch::Measure([&aDataLoader, &lFull] { lFull = CorrelationMatrix::Load(aDataLoader, CORRELATION_DAYS); }));
+
+    const auto lCount = lFull.Count();
+    const auto lRows  = LoadCloseRows(aDataLoader, lFull.Codes(), CORRELATION_DAYS);
+
+    // The same dates through Append, one rank-2 update of the cross products per date instead of the blocked kernel.
+    CorrelationMatrix lIncremental{lFull.Codes(), CORRELATION_DAYS};
+    std::vector<float> lCloses(lCount);
+    Stopwatch lStopwatch;
+
+    for (size_t d = 0; d < lRows.dates.size(); ++d)
+    {
+        std::copy_n(lRows.closes.cbegin() + d * lCount, lCount, lCloses.begin());
+
+        lIncremental.Append(lRows.dates[d], lCloses);
+    }
+
+    const auto lAppendMs = lStopwatch.Lap() / std::max<size_t>(lRows.dates.size(), 1);
+
+    const auto lPath   = std::filesystem::temp_directory_path() / "abollo-correlation.bin";
+    const auto lSaved  = lFull.Save(lPath);
+    const auto lSaveMs = lStopwatch.Lap();
+
+    std::error_code lErrorCode;
+    std::filesystem::remove(lPath, lErrorCode);
+
+    const auto lValues           = lFull.UpperTriangle();
+    const auto lReferenceError   = MaxError(lValues, ReferenceCorrelations(lRows, lCount, CORRELATION_DAYS));
+    const auto lIncrementalError = MaxError(lIncremental.UpperTriangle(), lValues);
+
+    fmt::print("correlation load: {} codes x {} days in {:.2f} ms\n", lCount, lFull.Days(), lLoadMs);
+    fmt::print("correlation append: {:.3f} ms per date over {} dates\n", lAppendMs, lRows.dates.size());
+    fmt::print("correlation save: {} pairs in {:.2f} ms\n", lValues.size(), lSaveMs);
+    fmt::print("correlation error: {:.2e} against double sums, {:.2e} between append and load\n", lReferenceError, lIncrementalError);
+
+    auto lFailures = CheckError("correlation against double sums", lReferenceError, CORRELATION_TOLERANCE);
+    lFailures += CheckError("correlation between append and load", lIncrementalError, CORRELATION_TOLERANCE);
+
+    if (!lSaved)
+    {
+        fmt::print(stderr, "correlation: failed to save to {}\n", lPath.string());
+        ++lFailures;
+    }
+
+    return lFailures;
+}
+
+
+// Screen of the latest date over every code, from the query to the list of matches, then pages of candles added to and dropped from
+// a ring-sized table against a scan of the whole table.
+uint32_t BenchPatterns(DataLoader& aDataLoader)
+{
+    auto& lPool = WorkStealingPool::Instance();
+
+    auto lScreenMs = std::numeric_limits<double>::infinity();
+    auto lLoadMs   = 0.0;
+    auto lScanMs   = 0.0;
+    PatternScanner lScanner;
+    std::vector<PatternMatch> lMatches;
+
+    for (uint32_t i = 0; i < MODEL_REPEATS; ++i)
+    {
+        Stopwatch lStopwatch;
+
+        auto lLoaded     = PatternScanner::Load(aDataLoader);
+        const auto lLoad = lStopwatch.Lap();
+
+        lLoaded.Scan(lPool);
+        const auto lScan = lStopwatch.Lap();
+
+        auto lLatest = lLoaded.LatestMatches();
+
+        if (const auto lTotal = lLoad + lScan + lStopwatch.Lap(); lTotal < lScreenMs)
+        {
+            lScreenMs = lTotal;
+            lLoadMs   = lLoad;
+            lScanMs   = lScan;
+            lScanner  = std::move(lLoaded);
+            lMatches  = std::move(lLatest);
+        }
+    }
+
+    fmt::print("patterns screen: {} codes x {} dates, {} matches on the latest date in {:.2f} ms (load {:.2f} ms, scan {:.2f} ms)\n", lScanner.Codes().size(),
+               lScanner.Dates().size(), lMatches.size(), lScreenMs, lLoadMs, lScanMs);
+
+    // Older pages are added and the oldest rows dropped as the ring does once full, newer pages the same way from the other end.
+    std::mt19937 lEngine{PATTERN_SEED};
+    std::vector<CandlePage> lPages;
+
+    for (uint32_t i = 0; i < PATTERN_STEPS; ++i)
+        lPages.push_back(RandomCandles(lEngine, PATTERN_PAGE));
+
+    CandlePatterns lPatterns;
+    lPatterns.push_back(RandomCandles(lEngine, PATTERN_ROWS));
+
+    Stopwatch lStopwatch;
+
+    for (const auto& lPage : lPages)
+    {
+        lPatterns.push_back(lPage);
+        lPatterns.pop_back(PATTERN_PAGE);
+    }
+
+    const auto lOlderUs = lStopwatch.Lap() * 1000.0 / PATTERN_STEPS;
+
+    for (const auto& lPage : lPages)
+    {
+        lPatterns.push_front(lPage);
+        lPatterns.pop_back(PATTERN_PAGE);
+    }
+
+    const auto lNewerUs = lStopwatch.Lap() * 1000.0 / PATTERN_STEPS;
+
+    // The table left by the pages, the newest PATTERN_ROWS / PATTERN_PAGE of them, every row set and scanned at once.
+    CandlePatterns lScanned;
+    lScanned.Resize(PATTERN_ROWS);
+
+    for (uint32_t i = 0; i < PATTERN_ROWS; ++i)
+    {
+        const auto& lPage = lPages[PATTERN_STEPS - 1 - i / PATTERN_PAGE];
+        const auto lRow   = i % PATTERN_PAGE;
+
+        lScanned.Set(PATTERN_ROWS - 1 - i, lPage.opens[lRow], lPage.closes[lRow], lPage.lows[lRow], lPage.highs[lRow]);
+    }
+
+    lStopwatch.Lap();
+
+    for (uint32_t i = 0; i < PATTERN_STEPS; ++i)
+        lScanned.Scan();
+
+    const auto lScanUs = lStopwatch.Lap() * 1000.0 / PATTERN_STEPS;
+
+    fmt::print("patterns pages: {} rows, {} older rows in {:.2f} us, {} newer rows in {:.2f} us, full scan in {:.2f} us\n", PATTERN_ROWS, PATTERN_PAGE, lOlderUs,
+               PATTERN_PAGE, lNewerUs, lScanUs);
+
+    uint32_t lFailures = 0;
+
+    for (size_t p = 0; p < PATTERN_COUNT; ++p)
+    {
+        if (lPatterns.Bits(static_cast<CandlePattern>(p)) != lScanned.Bits(static_cast<CandlePattern>(p)))
+        {
+            fmt::print(stderr, "patterns: pattern {} of the pages differs from a full scan\n", p);
+            ++lFailures;
+        }
+    }
+
+    return lFailures;
+}
+
+
+
+// Screen from the text to the ranked codes as the chart runs it, then run on a deeper universe and checked against a recomputation.
+uint32_t BenchScreen(DataLoader& aDataLoader)
+{
+    auto& lPool = WorkStealingPool::Instance();
+
+    auto lScreenMs  = std::numeric_limits<double>::infinity();
+    auto lCompileMs = 0.0;
+    auto lLoadMs    = 0.0;
+    auto lRunMs     = 0.0;
+    size_t lCount   = 0;
+    std::vector<ScreenResult> lResults;
+
+    for (uint32_t i = 0; i < MODEL_REPEATS; ++i)
+    {
+        Stopwatch lStopwatch;
+
+        const auto lScreen  = Screen::Compile(SCREEN_TEXT);
+        const auto lCompile = lStopwatch.Lap();
+
+        const auto lUniverse = lScreen.Load(aDataLoader);
+        const auto lLoad     = lStopwatch.Lap();
+
+        auto lRun = lScreen.Run(lUniverse, lPool);
+
+        if (const auto lTotal = lCompile + lLoad + lStopwatch.Lap(); lTotal < lScreenMs)
+        {
+            lScreenMs  = lTotal;
+            lCompileMs = lCompile;
+            lLoadMs    = lLoad;
+            lRunMs     = lTotal - lCompile - lLoad;
+            lCount     = lUniverse.Count();
+            lResults   = std::move(lRun);
+        }
+    }
+
+    fmt::print("screen: {} codes, {} results in {:.2f} ms (compile {:.3f} ms, load {:.2f} ms, run {:.2f} ms)\n", lCount, lResults.size(), lScreenMs, lCompileMs,
+               lLoadMs, lRunMs);
+
+    const auto lScreen   = Screen::Compile(SCREEN_TEXT);
+    const auto lUniverse = ScreenUniverse::Load(aDataLoader, SCREEN_DAYS);
+
+    auto lDeepMs = std::numeric_limits<double>::infinity();
+
+    for (uint32_t i = 0; i < MODEL_REPEATS; ++i)
+        lDeepMs = std::min(lDeepMs, Stopwatch::Measure([&] { lResults = lScreen.Run(lUniverse, lPool); }));
+
+    fmt::print("screen run: {} codes x {} days in {:.2f} ms\n", lUniverse.Count(), lUniverse.Days(), lDeepMs);
+
+    const auto lReference = RecomputeScreen(lUniverse);
+
+    const auto lSame = std::equal(lResults.cbegin(), lResults.cend(), lReference.cbegin(), lReference.cend(),
+                                  [](const ScreenResult& aFirst, const ScreenResult& aSecond) { return aFirst.code == aSecond.code && aFirst.score == aSecond.score; });
+
+    if (lSame)
+        return 0;
+
+    fmt::print(stderr, "screen: {} results differ from the {} of a recomputation\n", lResults.size(), lReference.size());
+
+    return 1;
+}
+
+
+
+}    // namespace
+
+
+
+uint32_t RunModelBenchmark()
+{
+    DataLoader lDataLoader;
+
+    auto lFailures = BenchCorrelations(lDataLoader);
+    lFailures += BenchPatterns(lDataLoader);
+    lFailures += BenchScreen(lDataLoader);
+
+    return lFailures;
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef __ABOLLO_BENCH_MODEL_BENCHMARK_H__
+#define __ABOLLO_BENCH_MODEL_BENCHMARK_H__
+
+
+
+#include <cstdint>
+
+
+
+namespace abollo
+{
+
+
+
+// Time the analytics that run over every code of the database and check their results against plain recomputations, one line per
+// measure. Returns the number of failed checks.
+uint32_t RunModelBenchmark();
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_BENCH_MODEL_BENCHMARK_H__
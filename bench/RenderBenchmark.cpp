@@ -0,0 +1,465 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <skia/include/core/SkBitmap.h>
+#include <skia/include/core/SkCanvas.h>
+#include <skia/include/core/SkData.h>
+#include <skia/include/core/SkImage.h>
+#include <skia/include/core/SkStream.h>
+#include <skia/include/core/SkSurface.h>
+#include <skia/include/encode/SkPngEncoder.h>
+
+#include "ModelBenchmark.h"
+
+#include "Graphics/VulkanContext.h"
+#include "Market/MarketCanvas.h"
+#include "Utility/Stopwatch.h"
+#include "Window/Application.h"
+#include "Window/Window.h"
+
+
+
+using abollo::Application;
+using abollo::MarketCanvas;
+using abollo::RunModelBenchmark;
+using abollo::Stopwatch;
+using abollo::SubSystem;
+using abollo::VulkanContext;
+using abollo::Window;
+
+
+
+namespace
+{
+
+
+
+enum class Backend
+{
+    eRaster,
+    eVulkan
+};
+
+
+struct Scenario
+{
+    uint32_t width;
+    uint32_t height;
+    int32_t zoom;    // Number of wheel steps applied around the right edge, negative values zoom out.
+};
+
+
+struct Timing
+{
+    double candle{0.};
+    double axis{0.};
+    double markup{0.};
+    double frame{0.};
+};
+
+
+struct Options
+{
+    bool raster{true};
+    bool vulkan{true};
+    bool model{true};    // Analytics over every code, see RunModelBenchmark.
+    uint32_t frames{50};
+    uint32_t tolerance{0};
+    std::string output{"bench_output.csv"};
+    std::optional<std::string> baseline;
+    std::optional<std::string> reference;
+    std::optional<std::string> dump;
+};
+
+
+constexpr std::string_view CSV_HEADER = "backend,width,height,zoom,candles,candle_ms,axis_ms,markup_ms,frame_ms,hash";
+
+constexpr uint32_t SCENARIO_SIZES[][2]{{1024, 768}, {1920, 1080}, {3840, 2160}};
+constexpr int32_t SCENARIO_ZOOMS[]{5, 0, -10, -20, -37};
+
+
+std::vector<Scenario> MakeScenarios()
+{
+    std::vector<Scenario> lScenarios;
+
+    for (const auto& lSize : SCENARIO_SIZES)
+        for (const auto lZoom : SCENARIO_ZOOMS)
+            lScenarios.push_back({lSize[0], lSize[1], lZoom});
+
+    return lScenarios;
+}
+
+
+constexpr std::string_view ToString(const Backend aBackend)
+{
+    return aBackend == Backend::eRaster ? "raster" : "vulkan";
+}
+
+
+std::string ScenarioKey(const Backend aBackend, const Scenario& aScenario)
+{
+    return fmt::format("{}-{}x{}-z{}", ToString(aBackend), aScenario.width, aScenario.height, aScenario.zoom);
+}
+
+
+// FNV-1a over the visible pixels, row by row so that row padding never leaks into the hash.
+uint64_t HashPixels(const SkPixmap& aPixmap)
+{
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+    constexpr uint64_t FNV_PRIME        = 0x100000001b3ull;
+
+    auto lHash = FNV_OFFSET_BASIS;
+
+    const auto lRowSize = static_cast<size_t>(aPixmap.width()) * aPixmap.info().bytesPerPixel();
+
+    for (int lRow = 0; lRow < aPixmap.height(); ++lRow)
+    {
+        const auto lBegin = static_cast<const uint8_t*>(aPixmap.addr(0, lRow));
+
+        for (size_t lIndex = 0; lIndex < lRowSize; ++lIndex)
+        {
+            lHash ^= lBegin[lIndex];
+            lHash *= FNV_PRIME;
+        }
+    }
+
+    return lHash;
+}
+
+
+// Number of pixels with at least one channel differing by more than the tolerance, or nullopt if the reference is missing.
+std::optional<uint64_t> CompareReference(const SkPixmap& aPixmap, const std::string& aPath, const uint32_t aTolerance)
+{
+    const auto lData = SkData::MakeFromFileName(aPath.c_str());
+
+    if (!lData)
+        return std::nullopt;
+
+    const auto lImage = SkImage::MakeFromEncoded(lData);
+
+    if (!lImage || lImage->width() != aPixmap.width() || lImage->height() != aPixmap.height())
+        return std::nullopt;
+
+    SkBitmap lReference;
+    lReference.allocPixels(aPixmap.info());
+
+    if (!lImage->readPixels(lReference.pixmap(), 0, 0))
+        return std::nullopt;
+
+    uint64_t lMismatches{0};
+
+    for (int lRow = 0; lRow < aPixmap.height(); ++lRow)
+    {
+        const auto lActual   = aPixmap.addr32(0, lRow);
+        const auto lExpected = lReference.pixmap().addr32(0, lRow);
+
+        for (int lCol = 0; lCol < aPixmap.width(); ++lCol)
+        {
+            uint32_t lDelta{0};
+
+            for (uint32_t lShift = 0; lShift < 32; lShift += 8)
+            {
+                const auto lLhs = static_cast<int32_t>((lActual[lCol] >> lShift) & 0xFF);
+                const auto lRhs = static_cast<int32_t>((lExpected[lCol] >> lShift) & 0xFF);
+
+                lDelta = std::max(lDelta, static_cast<uint32_t>(std::abs(lLhs - lRhs)));
+            }
+
+            if (lDelta > aTolerance)
+                ++lMismatches;
+        }
+    }
+
+    return lMismatches;
+}
+
+
+std::map<std::string, uint64_t> LoadBaseline(const std::string& aPath)
+{
+    std::map<std::string, uint64_t> lBaseline;
+    std::ifstream lInput{aPath};
+
+    std::string lLine;
+    std::getline(lInput, lLine);    // Skip header
+
+    while (std::getline(lInput, lLine))
+    {
+        std::vector<std::string> lFields;
+        std::stringstream lStream{lLine};
+
+        for (std::string lField; std::getline(lStream, lField, ',');)
+            lFields.push_back(lField);
+
+        if (lFields.size() != 10)
+            continue;
+
+        const auto lKey = fmt::format("{}-{}x{}-z{}", lFields[0], lFields[1], lFields[2], lFields[3]);
+        lBaseline.emplace(lKey, std::stoull(lFields[9], nullptr, 16));
+    }
+
+    return lBaseline;
+}
+
+
+void Flush(SkSurface& aSurface, const Backend aBackend)
+{
+    if (aBackend == Backend::eVulkan)
+    {
+        GrFlushInfo lFlushInfo;
+        lFlushInfo.fFlags = kSyncCpu_GrFlushFlag;
+
+        aSurface.flush(SkSurface::BackendSurfaceAccess::kNoAccess, lFlushInfo);
+    }
+}
+
+
+Timing RenderFrame(const MarketCanvas& aMarketCanvas, SkSurface& aSurface, const Backend aBackend)
+{
+    auto& lCanvas = *aSurface.getCanvas();
+
+    Timing lTiming;
+    Stopwatch lFrame;
+    Stopwatch lPass;
+
+    lCanvas.clear(SK_ColorDKGRAY);
+    Flush(aSurface, aBackend);
+    lPass.Reset();
+
+    aMarketCanvas.PaintCandles(lCanvas);
+    Flush(aSurface, aBackend);
+    lTiming.candle = lPass.Lap();
+
+    aMarketCanvas.PaintAxes(lCanvas);
+    Flush(aSurface, aBackend);
+    lTiming.axis = lPass.Lap();
+
+    aMarketCanvas.PaintMarkups(lCanvas);
+    Flush(aSurface, aBackend);
+    lTiming.markup = lPass.Lap();
+
+    lTiming.frame = lFrame.Elapsed();
+
+    return lTiming;
+}
+
+
+Options ParseOptions(const int aArgc, char* aArgv[])
+{
+    Options lOptions;
+
+    for (int lIndex = 1; lIndex < aArgc; ++lIndex)
+    {
+        const std::string_view lArg{aArgv[lIndex]};
+        const auto lHasValue = lIndex + 1 < aArgc;
+
+        if (lArg == "--backend" && lHasValue)
+        {
+            const std::string_view lBackend{aArgv[++lIndex]};
+
+            lOptions.raster = lBackend == "raster" || lBackend == "all";
+            lOptions.vulkan = lBackend == "vulkan" || lBackend == "all";
+        }
+        else if (lArg == "--suite" && lHasValue)
+        {
+            const std::string_view lSuite{aArgv[++lIndex]};
+
+            lOptions.model = lSuite == "model" || lSuite == "all";
+
+            if (lSuite == "model")
+                lOptions.raster = lOptions.vulkan = false;
+        }
+        else if (lArg == "--frames" && lHasValue)
+            lOptions.frames = std::max(1u, static_cast<uint32_t>(std::strtoul(aArgv[++lIndex], nullptr, 10)));
+        else if (lArg == "--tolerance" && lHasValue)
+            lOptions.tolerance = static_cast<uint32_t>(std::strtoul(aArgv[++lIndex], nullptr, 10));
+        else if (lArg == "--output" && lHasValue)
+            lOptions.output = aArgv[++lIndex];
+        else if (lArg == "--baseline" && lHasValue)
+            lOptions.baseline = aArgv[++lIndex];
+        else if (lArg == "--reference" && lHasValue)
+            lOptions.reference = aArgv[++lIndex];
+        else if (lArg == "--dump" && lHasValue)
+            lOptions.dump = aArgv[++lIndex];
+        else
+            fmt::print(stderr, "Unknown option: {}\n", lArg);
+    }
+
+    return lOptions;
+}
+
+
+class RenderBenchmark final
+{
+private:
+    const Options& mOptions;
+    std::map<std::string, uint64_t> mBaseline;
+    std::ofstream mOutput;
+
+    uint32_t mFailures{0};
+
+    void Verify(const Backend aBackend, const Scenario& aScenario, const SkPixmap& aPixmap, const uint64_t aHash)
+    {
+        const auto lKey = ScenarioKey(aBackend, aScenario);
+
+        if (mOptions.dump)
+        {
+            SkFILEWStream lStream{fmt::format("{}/{}.png", *mOptions.dump, lKey).c_str()};
+            SkPngEncoder::Encode(&lStream, aPixmap, {});
+        }
+
+        const auto lExpected = mBaseline.find(lKey);
+
+        if (lExpected == mBaseline.cend() || lExpected->second == aHash)
+            return;
+
+        // The hash changed: accept the frame if a reference image exists and every pixel is within the tolerance.
+        if (mOptions.reference)
+        {
+            const auto lMismatches = CompareReference(aPixmap, fmt::format("{}/{}.png", *mOptions.reference, lKey), mOptions.tolerance);
+
+            if (lMismatches && *lMismatches == 0)
+                return;
+
+            if (lMismatches)
+                fmt::print(stderr, "{}: {} pixels exceed tolerance {}\n", lKey, *lMismatches, mOptions.tolerance);
+        }
+
+        fmt::print(stderr, "{}: hash {:016x} differs from baseline {:016x}\n", lKey, aHash, lExpected->second);
+
+        ++mFailures;
+    }
+
+public:
+    explicit RenderBenchmark(const Options& aOptions) : mOptions{aOptions}, mOutput{aOptions.output}
+    {
+        if (mOptions.baseline)
+            mBaseline = LoadBaseline(*mOptions.baseline);
+
+        mOutput << CSV_HEADER << '\n';
+        fmt::print("{}\n", CSV_HEADER);
+    }
+
+    template <typename SurfaceFactory>
+    void Run(const Backend aBackend, SurfaceFactory&& aSurfaceFactory)
+    {
+        for (const auto& lScenario : MakeScenarios())
+        {
+            auto lWidth  = lScenario.width;
+            auto lHeight = lScenario.height;
+
+            const auto lSurface = aSurfaceFactory(lWidth, lHeight);
+
+            if (!lSurface)
+            {
+                fmt::print(stderr, "{}: failed to create surface\n", ScenarioKey(aBackend, lScenario));
+                continue;
+            }
+
+            MarketCanvas lMarketCanvas{lWidth, lHeight};
+
+            // Zoom around the right edge so the latest candles stay in view, and keep the cursor there for the highlight pass.
+            const auto lPivotX = static_cast<SkScalar>(lWidth - 1);
+            const auto lPivotY = static_cast<SkScalar>(lHeight / 2);
+
+            lMarketCanvas.Pick(lPivotX, lPivotY);
+
+            for (auto lStep = 0; lStep < std::abs(lScenario.zoom); ++lStep)
+                lMarketCanvas.Zoom(0.f, lScenario.zoom > 0 ? 1.f : -1.f);
+
+            RenderFrame(lMarketCanvas, *lSurface, aBackend);    // Warm up caches and pipelines.
+
+            Timing lTotal;
+
+            for (uint32_t lFrame = 0; lFrame < mOptions.frames; ++lFrame)
+            {
+                const auto lTiming = RenderFrame(lMarketCanvas, *lSurface, aBackend);
+
+                lTotal.candle += lTiming.candle;
+                lTotal.axis += lTiming.axis;
+                lTotal.markup += lTiming.markup;
+                lTotal.frame += lTiming.frame;
+            }
+
+            SkBitmap lBitmap;
+            lBitmap.allocN32Pixels(static_cast<int>(lWidth), static_cast<int>(lHeight));
+            lSurface->readPixels(lBitmap, 0, 0);
+
+            const auto lHash = HashPixels(lBitmap.pixmap());
+
+            const auto lFrames = static_cast<double>(mOptions.frames);
+            const auto lRecord = fmt::format("{},{},{},{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:016x}", ToString(aBackend), lWidth, lHeight, lScenario.zoom,
+                                             lMarketCanvas.CandleCount(), lTotal.candle / lFrames, lTotal.axis / lFrames, lTotal.markup / lFrames,
+                                             lTotal.frame / lFrames, lHash);
+
+            mOutput << lRecord << '\n';
+            fmt::print("{}\n", lRecord);
+
+            Verify(aBackend, lScenario, lBitmap.pixmap(), lHash);
+        }
+    }
+
+    [[nodiscard]] uint32_t Failures() const
+    {
+        return mFailures;
+    }
+};
+
+
+
+}    // namespace
+
+
+
+int main(int argc, char* argv[])
+{
+    const auto lOptions = ParseOptions(argc, argv);
+
+    RenderBenchmark lBenchmark{lOptions};
+
+    if (lOptions.raster)
+        lBenchmark.Run(Backend::eRaster, [](const uint32_t aWidth, const uint32_t aHeight) {
+            return SkSurface::MakeRasterN32Premul(static_cast<int>(aWidth), static_cast<int>(aHeight));
+        });
+
+    if (lOptions.vulkan)
+    {
+        try
+        {
+            Application::Instance(SubSystem::eVideo);
+
+            // The swapchain of the hidden window is never presented, all scenarios render into offscreen render targets.
+            const Window lWindow{"Render Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 64, 64, SDL_WINDOW_HIDDEN | SDL_WINDOW_VULKAN};
+            VulkanContext lVulkanContext{lWindow, "Render Benchmark", 1, "", 0};
+
+            lBenchmark.Run(Backend::eVulkan, [&lVulkanContext](const uint32_t aWidth, const uint32_t aHeight) {
+                const auto lImageInfo = SkImageInfo::MakeN32Premul(static_cast<int>(aWidth), static_cast<int>(aHeight));
+
+                return SkSurface::MakeRenderTarget(lVulkanContext.GetGrContext(), SkBudgeted::kNo, lImageInfo);
+            });
+
+            lVulkanContext.StorePipelineCache();
+
+            // A second run against the same cache directory should report hits only.
+            const auto lCacheStatistics = lVulkanContext.GetPersistentCache().GetStatistics();
+            fmt::print(stderr, "Shader cache: {} hits, {} misses, {} stores, {} writes\n", lCacheStatistics.hits, lCacheStatistics.misses, lCacheStatistics.stores,
+                       lCacheStatistics.writes);
+        }
+        catch (const std::exception& aException)
+        {
+            fmt::print(stderr, "Vulkan backend unavailable: {}\n", aException.what());
+        }
+    }
+
+    const auto lModelFailures = lOptions.model ? RunModelBenchmark() : 0;
+
+    return lBenchmark.Failures() + lModelFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#ifndef __ABOLLO_GRAPHICS_PERSISTENT_CACHE_H__
+#define __ABOLLO_GRAPHICS_PERSISTENT_CACHE_H__
+
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <skia/include/core/SkData.h>
+#include <skia/include/core/SkRefCnt.h>
+#include <skia/include/gpu/GrContextOptions.h>
+
+#include "Utility/NonCopyable.h"
+
+
+
+namespace abollo
+{
+
+
+
+// On-disk cache for the shader modules and the VkPipelineCache blob Skia hands out through GrContextOptions::PersistentCache.
+// Entries live in <root>/v<CACHE_VERSION>/<device key>/, one file per key. All of them are read when the cache is constructed,
+// stores are written back by a background thread so that a draw call never waits for the disk.
+class PersistentCache final : public GrContextOptions::PersistentCache, private internal::NonCopyable
+{
+public:
+    struct Statistics
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t stores;
+        uint64_t writes;
+    };
+
+private:
+    constexpr static uint32_t CACHE_MAGIC   = 0x43504241;    // "ABPC"
+    constexpr static uint32_t CACHE_VERSION = 1;             // Bump whenever the entry layout changes.
+
+    struct EntryHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t keySize;
+        uint32_t dataSize;
+    };
+
+    std::filesystem::path mDirectory;
+
+    std::mutex mMutex;
+    std::condition_variable mPendingCondition;
+    std::condition_variable mIdleCondition;
+
+    std::unordered_map<std::string, sk_sp<SkData>> mEntries;
+    std::deque<std::pair<std::string, sk_sp<SkData>>> mPendingWrites;
+    bool mWriting{false};
+    bool mStopping{false};
+
+    std::atomic<uint64_t> mHits{0};
+    std::atomic<uint64_t> mMisses{0};
+    std::atomic<uint64_t> mStores{0};
+    std::atomic<uint64_t> mWrites{0};
+
+    std::thread mWriter;
+
+    [[nodiscard]] std::filesystem::path EntryPath(const std::string& aKey) const;
+
+    void ReadEntries();
+    void WriteEntry(const std::string& aKey, const SkData& aData) const;
+    void WriteBack();
+
+public:
+    PersistentCache(const std::filesystem::path& aRoot, const std::string_view aDeviceKey);
+    ~PersistentCache() override;
+
+    sk_sp<SkData> load(const SkData& aKey) override;
+    void store(const SkData& aKey, const SkData& aData) override;
+
+    // Block until every store issued so far has reached the disk.
+    void Flush();
+
+    [[nodiscard]] Statistics GetStatistics() const
+    {
+        return {mHits.load(), mMisses.load(), mStores.load(), mWrites.load()};
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_GRAPHICS_PERSISTENT_CACHE_H__
@@ -2,6 +2,8 @@
 #define __ABOLLO_GRAPHICS_VULKAN_CONTEXT_H__
 
 
+#include <memory>
+#include <string>
 #include <string_view>
 
 #include <skia/include/core/SkRefCnt.h>
@@ -9,8 +11,10 @@
 #include <skia/include/core/SkSurfaceProps.h>
 #include <skia/include/core/SkTypes.h>
 #include <skia/include/gpu/GrContext.h>
+#include <skia/include/gpu/GrContextThreadSafeProxy.h>
 #include <skia/include/gpu/vk/GrVkTypes.h>
 
+#include "Graphics/PersistentCache.h"
 #include "Utility/NonCopyable.h"
 #include "vk/Instance.h"
 
@@ -28,6 +32,8 @@ class Window;
 class VulkanContext final : private internal::NonCopyable
 {
 private:
+    constexpr static const char* DEFAULT_CACHE_DIRECTORY = "cache";
+
     struct DeviceQueue
     {
         vk::Queue handle{VK_NULL_HANDLE};
@@ -61,6 +67,7 @@ private:
     std::vector<sk_sp<SkSurface>> mSkSurfaces;
     std::vector<BackbufferInfo> mBackBuffers;
 
+    std::shared_ptr<PersistentCache> mpPersistentCache;    // Shared by every context created on the same device.
     sk_sp<GrContext> mContext;
 
     GrContextOptions mContextOptions;
@@ -70,6 +77,9 @@ private:
     uint32_t mCurrentBackbufferIndex{UINT32_MAX};
     int mSampleCount{1};
 
+    // Return the cache of the device, creating it if no other context holds it any more.
+    static std::shared_ptr<PersistentCache> AcquirePersistentCache(const std::string& aDeviceKey);
+
     void CreateBuffers(const VkFormat aFormat, const SkColorType aColorType, const int aWidth, const int aHeight);
     void DestroyBuffers();
 
@@ -95,6 +105,25 @@ public:
     {
         return mExtent;
     }
+
+    [[nodiscard]] GrContext* GetGrContext() const
+    {
+        return mContext.get();
+    }
+
+    // Unlike the GrContext itself the proxy may be used from any thread, e.g. to record SkDeferredDisplayLists for this context.
+    [[nodiscard]] sk_sp<GrContextThreadSafeProxy> GetThreadSafeProxy() const
+    {
+        return mContext->threadSafeProxy();
+    }
+
+    [[nodiscard]] const PersistentCache& GetPersistentCache() const
+    {
+        return *mpPersistentCache;
+    }
+
+    // Hand the current VkPipelineCache data over to the persistent cache and wait until it is on disk.
+    void StorePipelineCache();
 };
 
 
@@ -3,8 +3,13 @@
 
 
 
+#include <array>
 #include <cmath>
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <skia/include/core/SkPath.h>
@@ -12,6 +17,9 @@
 
 #include "Market/Markup/MarkupPainter.h"
 #include "Market/Model/DataAnalyzer.h"
+#include "Market/Model/MinuteBarFeed.h"
+#include "Market/Model/ReplayEngine.h"
+#include "Market/Model/TickReplay.h"
 #include "Market/Painter.h"
 #include "Market/Painter/AxisPainter.h"
 #include "Utility/Median.h"
@@ -30,6 +38,7 @@ private:
     constexpr static SkScalar MIN_CANDLE_COUNT{10.f};
 
     constexpr static SkScalar DEFAULT_CANDLE_DELTA{20.f};
+    constexpr static uint32_t PROFILE_BINS{64};
 
     /*
      * 1. Transform x coordinate from data range (0, delta) to window range (0, width):
@@ -74,6 +83,7 @@ private:
     SkScalar mZoomTransX{0.f};
 
     DatePricePair mTransPrices;
+    VolumeProfile mVolumeProfile;    // Of the visible candles, binned like mPriceAxis.
 
     SkScalar mMousePosX{0.f};
     SkScalar mMousePosY{0.f};
@@ -88,10 +98,26 @@ private:
     std::unique_ptr<AxisPainter> mpAxisPainter;
     std::unique_ptr<MarkupPainter> mpMarkupPainter;
 
-    DataAnalyzer mDataAnalyzer;
+    std::unique_ptr<DataAnalyzer> mpDataAnalyzer;
+    std::unique_ptr<ReplayEngine> mpReplayEngine;    // Null unless replaying, plays into mpDataAnalyzer.
+
+    MinuteBarFeed mBarFeed;    // Intraday bars posted by a feed thread, drained into mBarTables every frame.
+    BarTables mBarTables;
+    std::unique_ptr<TickReplay> mpTickReplay;    // Null unless replaying ticks, posts to mBarFeed.
+    bool mStreaming{false};                      // Bars of mpTickReplay may still be queued.
+    std::optional<BarInterval> mShownBars;       // Charted in place of the daily candles when set.
 
     std::vector<MarkupType> mMarkups;
 
+    // Patterns marked on the chart and the visible candles that complete them, refreshed with mTransPrices.
+    std::vector<CandlePattern> mShownPatterns{CandlePattern::eHammer, CandlePattern::eBullishEngulfing, CandlePattern::eBearishEngulfing,
+                                              CandlePattern::eMorningStar};
+    std::vector<std::vector<uint32_t>> mPatternMarkers;
+
+    // Window Y coordinates of the SMA, the EMA, the Bollinger bands and the rolling high and low of the visible candles, in the order of
+    // mTransPrices, drawn over the candles. NaN where an indicator is not available yet. Refreshed with mTransPrices.
+    std::array<std::vector<SkScalar>, 6> mOverlays;
+
     [[nodiscard]] SkPoint ConvertToData(const SkScalar aPosX, const SkScalar aPosY) const
     {
         // return {(aPosX - mXAxis.trans) / mXAxis.scale, std::expf((aPosY - mPriceAxis.trans) / mPriceAxis.scale)};
@@ -114,13 +140,29 @@ private:
         return ConvertToPixel(aPos.x(), aPos.y());
     }
 
+    [[nodiscard]] uint32_t ConvertToSeq(const SkScalar aPosX) const
+    {
+        const auto lSeq = static_cast<uint32_t>(std::max(std::lround(ConvertToData(aPosX, 0.f).x()), 0l));
+
+        return Median(mStartSeq, mEndSeq, lSeq);
+    }
+
     void ZoomX();
     void PanX();
 
     void Reload();
 
+    // Take the range of the rows after new bars and keep the newest one at the right edge.
+    void Follow();
+
 public:
+    // Neither the market data nor the painters depend on the GPU, so both can be prepared on other threads while the window is set up.
+    [[nodiscard]] static std::unique_ptr<DataAnalyzer> LoadData();
+    [[nodiscard]] static std::pair<std::unique_ptr<Painter>, std::unique_ptr<AxisPainter>> LoadPainters();
+
     MarketCanvas(const uint32_t& aWidth, const uint32_t& aHeight);
+    MarketCanvas(const uint32_t& aWidth, const uint32_t& aHeight, std::unique_ptr<DataAnalyzer> apDataAnalyzer, std::unique_ptr<Painter> apMarketPainter,
+                 std::unique_ptr<AxisPainter> apAxisPainter);
 
     template <typename T = None, typename... Args>
     void ResetMode(Args&&... aArgs)
@@ -262,8 +304,109 @@ public:
         // mTransMatrix.postConcat(SkMatrix::MakeAll(u / mTransMatrix.getScaleX(), 0.f, lDeltaX, 0.f, lScaleY, lDeltaY, 0.f, 0.f, 1.f));
     }
 
+    [[nodiscard]] const IndicatorParameters& GetIndicatorParameters() const
+    {
+        return mpDataAnalyzer->GetIndicatorParameters();
+    }
+
+    // Recompute the indicators of the rows loaded with other periods, the overlays follow.
+    void SetIndicatorParameters(const IndicatorParameters& aParameters)
+    {
+        mpDataAnalyzer->SetIndicatorParameters(aParameters);
+
+        Reload();
+    }
+
+    void ShowPatterns(std::vector<CandlePattern> aPatterns)
+    {
+        mShownPatterns = std::move(aPatterns);
+
+        Reload();
+    }
+
+    // Chart the aLimit latest bars of aCode in place of the rows loaded, leaving a replay.
+    void ShowIndex(const std::string& aCode, const uint32_t aLimit);
+
+    // Chart the aLimit latest bars of aCode against aBaseCode as their spread, ratio or rebased series, in place of the rows loaded,
+    // leaving a replay.
+    void ShowRelative(const std::string& aBaseCode, const std::string& aCode, const JoinSeries aSeries, const uint32_t aLimit);
+
+    // Chart the equity curve of the best moving average crossover on the aLimit latest bars of aCode, among every pair of periods in
+    // [aMinPeriod, aMaxPeriod], in place of the rows loaded, leaving a replay. Returns the pair charted.
+    BacktestResult ShowBacktest(const std::string& aCode, const uint32_t aMinPeriod, const uint32_t aMaxPeriod, const uint32_t aLimit);
+
+    // Replay the aLimit latest bars of aCode on the chart, the oldest aWarmUp of them at once, then aSpeed bars per second.
+    void StartReplay(const std::string& aCode, const uint32_t aLimit, const uint32_t aWarmUp, const double aSpeed = ReplayEngine::DEFAULT_SPEED);
+
+    // Add the bars left at once and leave the replay.
+    void StopReplay();
+
+    // Add the next aCount bars of the replay now, paused or not.
+    void StepReplay(const uint32_t aCount = 1);
+
+    // Aggregate the ticks of aPath into the intraday bars at aSpeed times the pace they were recorded at, in place of the bars shown.
+    // Throws std::runtime_error if the ticks cannot be read.
+    void StartTickReplay(const std::filesystem::path& aPath, const double aSpeed);
+
+    // Stop the tick replay, the bars drained so far stay.
+    void StopTickReplay();
+
+    // Bars of the tick replay are still coming, frames must keep being asked for until the last of them is drained.
+    [[nodiscard]] bool Streaming() const
+    {
+        return mStreaming;
+    }
+
+    [[nodiscard]] bool TickReplaying() const
+    {
+        return mpTickReplay != nullptr;
+    }
+
+    // Called once per frame, applies the intraday bars posted since the previous frame, the daily one revising the statistics of the
+    // newest candle, and while replaying adds the bars due. Returns true if the chart changed.
+    bool Advance();
+
+    // Pause, resume and speed of the replay, null unless replaying.
+    [[nodiscard]] ReplayEngine* Replay() const
+    {
+        return mpReplayEngine.get();
+    }
+
+    // Post the intraday bars here from the feed thread, the only producer. They show in Bars() from the next frame on.
+    [[nodiscard]] MinuteBarFeed& BarFeed()
+    {
+        return mBarFeed;
+    }
+
+    [[nodiscard]] const MinuteBarTable& Bars(const BarInterval aInterval) const
+    {
+        return mBarTables[static_cast<size_t>(aInterval)];
+    }
+
+    // Chart the bars of aInterval in place of the daily candles, following them as they are drained, or the daily candles again
+    // without an interval.
+    void ShowBars(const std::optional<BarInterval> aInterval)
+    {
+        mShownBars = aInterval;
+    }
+
+    [[nodiscard]] std::optional<BarInterval> ShownBars() const
+    {
+        return mShownBars;
+    }
+
+    [[nodiscard]] uint32_t CandleCount() const
+    {
+        return mXAxis.max - mXAxis.min;
+    }
+
     void Capture(SkSurface* apSurface) const;
     void Paint(SkSurface* apSurface) const;
+
+    // Individual render passes, called in this order by Paint().
+    void PaintCandles(SkCanvas& aCanvas) const;
+    void PaintAxes(SkCanvas& aCanvas) const;
+    void PaintMarkups(SkCanvas& aCanvas) const;
 };
 
 
@@ -0,0 +1,149 @@
+#ifndef __ABOLLO_MARKET_MODEL_BACKTESTER_H__
+#define __ABOLLO_MARKET_MODEL_BACKTESTER_H__
+
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Market/Model/Table.h"
+
+
+
+namespace abollo
+{
+
+
+
+class WorkStealingPool;
+
+
+
+struct BacktestResult
+{
+    uint32_t fastPeriod{0};
+    uint32_t slowPeriod{0};
+
+    double totalReturn{0.0};
+    double maxDrawdown{0.0};    // Largest fall from a peak of the equity, as a fraction of the peak.
+    double sharpe{0.0};         // Annualized, risk free rate 0.
+    double turnover{0.0};       // Annualized sum of the position changes.
+};
+
+
+
+// Long or flat backtests on the closes of one code, every step is a pass over whole columns:
+// positions are a ColumnExpression over moving average columns, the profit and loss is a transform of the positions and returns, and
+// the equity, its running peak and the drawdown are scans. The moving average of every period is computed once from the prefix sums of
+// the closes and shared by every pair of a sweep, which only allocates the scratch buffers of each worker once.
+class Backtester final
+{
+public:
+    constexpr static double TRADING_DAYS = 252.0;
+
+    // Per-thread buffers, sized on first use and reused by every following run.
+    struct Scratch
+    {
+        std::vector<float> averages;    // Fast then slow moving average of a single run.
+        std::vector<float> positions;
+        std::vector<double> equity;
+        std::vector<double> peaks;
+    };
+
+private:
+    constexpr static size_t SWEEP_GRAIN = 8;
+
+    // The closes are the only column copied out of the page: pages are chunked and an expression binds a column in one run of memory.
+    std::vector<float> mCloses;     // Oldest first, like every column below.
+    std::vector<float> mReturns;    // mReturns[t] is the return from t - 1 to t, 0 for the first row.
+    std::vector<double> mSums;      // Exclusive prefix sums of the closes.
+
+    double mCost;    // Paid on every unit of position change, as a fraction of the equity.
+
+    void Prepare();
+
+    // Moving average of aPeriod closes ending at every row into aAverages, NaN before aPeriod rows.
+    void Averages(const uint32_t aPeriod, float* aAverages) const;
+
+    // Position 1 while the fast moving average is above the slow one, 0 before the slow one is defined.
+    void CrossoverPositions(const float* aFastAverages, const float* aSlowAverages, std::vector<float>& aPositions) const;
+
+    [[nodiscard]] BacktestResult RunCrossover(const uint32_t aFastPeriod, const uint32_t aSlowPeriod, const float* aFastAverages, const float* aSlowAverages,
+                                              Scratch& aScratch) const;
+
+public:
+    // aPage is ordered by date descending, as pages come out of DataLoader.
+    template <typename U>
+    explicit Backtester(const U& aPage, const double aCost = 0.0005) : mCost{aCost}
+    {
+        const auto lBegin = aPage.template begin<close_tag>();
+
+        mCloses.assign(std::make_reverse_iterator(lBegin + aPage.size()), std::make_reverse_iterator(lBegin));
+
+        Prepare();
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return mCloses.size();
+    }
+
+    [[nodiscard]] const auto& Closes() const
+    {
+        return mCloses;
+    }
+
+    // Statistics of the positions in aScratch.positions, one per row, oldest first. The position of a row is held over the next one.
+    [[nodiscard]] BacktestResult Evaluate(Scratch& aScratch) const;
+
+    [[nodiscard]] BacktestResult RunCrossover(const uint32_t aFastPeriod, const uint32_t aSlowPeriod, Scratch& aScratch) const;
+
+    // Every pair aMinPeriod <= fast < slow <= aMaxPeriod, run on aPool. Results are ordered by fast then slow period.
+    [[nodiscard]] std::vector<BacktestResult> SweepCrossovers(WorkStealingPool& aPool, const uint32_t aMinPeriod, const uint32_t aMaxPeriod) const;
+
+    // Equity of the crossover after every row, oldest first.
+    [[nodiscard]] std::vector<double> CrossoverEquity(const uint32_t aFastPeriod, const uint32_t aSlowPeriod) const;
+
+    // Push the equity curve of the crossover into aCurve, a table over the market data columns such as a page, newest first like aPage,
+    // the page the backtester was built from. Candles go from the equity of the previous row to the equity of the row, date, sequence,
+    // volume and amount are those of aPage.
+    template <typename T, typename U>
+    void CrossoverCurve(const T& aPage, const uint32_t aFastPeriod, const uint32_t aSlowPeriod, U& aCurve) const
+    {
+        assert(aPage.size() == size());
+
+        const auto lEquity = CrossoverEquity(aFastPeriod, aSlowPeriod);
+
+        Row<typename U::Schema> lRow{};
+
+        for (size_t i = 0; i < size(); ++i)
+        {
+            const auto t      = size() - 1 - i;
+            const auto lOpen  = static_cast<float>(t == 0 ? 1.0 : lEquity[t - 1]);
+            const auto lClose = static_cast<float>(lEquity[t]);
+
+            lRow.template Set<date_tag>(aPage.template begin<date_tag>()[i]);
+            lRow.template Set<seq_tag>(aPage.template begin<seq_tag>()[i]);
+            lRow.template Set<open_tag>(lOpen);
+            lRow.template Set<close_tag>(lClose);
+            lRow.template Set<low_tag>(std::min(lOpen, lClose));
+            lRow.template Set<high_tag>(std::max(lOpen, lClose));
+            lRow.template Set<volume_tag>(aPage.template begin<volume_tag>()[i]);
+            lRow.template Set<amount_tag>(aPage.template begin<amount_tag>()[i]);
+
+            aCurve.push_back(lRow);
+        }
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_BACKTESTER_H__
@@ -0,0 +1,226 @@
+#ifndef __ABOLLO_MARKET_MODEL_BAR_AGGREGATOR_H__
+#define __ABOLLO_MARKET_MODEL_BAR_AGGREGATOR_H__
+
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <date/date.h>
+
+#include "Market/Model/MinuteBarTable.h"
+
+
+
+namespace abollo
+{
+
+
+
+struct Tick
+{
+    date::sys_time<std::chrono::milliseconds> time;
+    float price;
+    float volume;
+};
+
+
+
+enum class BarInterval : uint8_t
+{
+    e1Minute,
+    e5Minutes,
+    e15Minutes,
+    e60Minutes,
+    eDaily,
+    eCount
+};
+
+
+constexpr auto BAR_INTERVAL_COUNT = static_cast<size_t>(BarInterval::eCount);
+
+// Every interval is a multiple of the one before, so a bar closes together with a bar of every shorter interval. Days are UTC days,
+// which hold a whole session of the exchanges east of London.
+constexpr std::array<int64_t, BAR_INTERVAL_COUNT> BAR_INTERVAL_MINUTES{1, 5, 15, 60, 1440};
+
+// A table of bars per interval, in the order of BarInterval.
+using BarTables = std::array<MinuteBarTable, BAR_INTERVAL_COUNT>;
+
+
+
+// Builds the bars of every interval from trades in a single pass, without allocating. A trade only updates the forming minute bar;
+// once the minute is over the bar is emitted and folded into the forming 5 minute bar, which once over is emitted and folded into the
+// 15 minute bar, and so on. Trades come in time order, in batches of up to TICK_BATCH_SIZE; a late trade counts towards the forming
+// minute.
+// Finished bars go to a sink, aSink(BarInterval, const MinuteBar&), in time order per interval, shorter intervals first.
+class BarAggregator final
+{
+public:
+    constexpr static size_t TICK_BATCH_SIZE = 4096;
+
+private:
+    constexpr static int64_t MILLIS_PER_MINUTE = 60'000;
+
+    struct Partial
+    {
+        int64_t start{0};    // Milliseconds since the epoch.
+        int64_t end{0};      // 0 while no trade fell in the interval.
+        float open{0.f};
+        float high{0.f};
+        float low{0.f};
+        float close{0.f};
+        float volume{0.f};
+        float amount{0.f};
+    };
+
+    std::array<Partial, BAR_INTERVAL_COUNT> mBars;
+
+    [[nodiscard]] static int64_t Floor(const int64_t aMillis, const int64_t aLength)
+    {
+        const auto lRemainder = aMillis % aLength;
+
+        return aMillis - (lRemainder < 0 ? lRemainder + aLength : lRemainder);
+    }
+
+    [[nodiscard]] static MinuteBar ToBar(const Partial& aPartial)
+    {
+        MinuteBar lBar;
+
+        lBar.Set<time_tag>(MinuteTime{std::chrono::minutes{aPartial.start / MILLIS_PER_MINUTE}})
+            .Set<open_tag>(aPartial.open)
+            .Set<close_tag>(aPartial.close)
+            .Set<low_tag>(aPartial.low)
+            .Set<high_tag>(aPartial.high)
+            .Set<volume_tag>(aPartial.volume)
+            .Set<amount_tag>(aPartial.amount);
+
+        return lBar;
+    }
+
+    // aPartial followed by aNext, a bar within the same interval.
+    static void Merge(Partial& aPartial, const Partial& aNext)
+    {
+        aPartial.high  = std::max(aPartial.high, aNext.high);
+        aPartial.low   = std::min(aPartial.low, aNext.low);
+        aPartial.close = aNext.close;
+        aPartial.volume += aNext.volume;
+        aPartial.amount += aNext.amount;
+    }
+
+    // The minute is over at aMillis: emit it and fold it into the forming bar of the next interval, which is emitted and folded into
+    // the next one in turn if it is over too.
+    template <typename Sink>
+    void Roll(const int64_t aMillis, Sink& aSink)
+    {
+        const auto* lFinished = &mBars.front();
+
+        if (lFinished->end == 0)
+            return;
+
+        aSink(BarInterval::e1Minute, ToBar(*lFinished));
+
+        for (size_t i = 1; i < BAR_INTERVAL_COUNT; ++i)
+        {
+            auto& lBar = mBars[i];
+
+            if (lBar.end == 0)
+            {
+                const auto lLength = BAR_INTERVAL_MINUTES[i] * MILLIS_PER_MINUTE;
+
+                lBar       = *lFinished;
+                lBar.start = Floor(lFinished->start, lLength);
+                lBar.end   = lBar.start + lLength;
+            }
+            else
+                Merge(lBar, *lFinished);
+
+            if (aMillis < lBar.end)
+                break;
+
+            aSink(static_cast<BarInterval>(i), ToBar(lBar));
+
+            lBar.end  = 0;
+            lFinished = &lBar;
+        }
+    }
+
+public:
+    // Aggregate aCount trades from aTicks.
+    template <typename Sink>
+    void Push(const Tick* aTicks, const size_t aCount, Sink&& aSink)
+    {
+        auto& lMinute = mBars.front();
+
+        for (size_t i = 0; i < aCount; ++i)
+        {
+            const auto lMillis = aTicks[i].time.time_since_epoch().count();
+            const auto lPrice  = aTicks[i].price;
+            const auto lVolume = aTicks[i].volume;
+
+            if (lMillis >= lMinute.end)
+            {
+                Roll(lMillis, aSink);
+
+                lMinute.start = Floor(lMillis, MILLIS_PER_MINUTE);
+                lMinute.end   = lMinute.start + MILLIS_PER_MINUTE;
+                lMinute.open = lMinute.high = lMinute.low = lPrice;
+                lMinute.volume = lMinute.amount = 0.f;
+            }
+
+            lMinute.high  = std::max(lMinute.high, lPrice);
+            lMinute.low   = std::min(lMinute.low, lPrice);
+            lMinute.close = lPrice;
+            lMinute.volume += lVolume;
+            lMinute.amount += lPrice * lVolume;
+        }
+    }
+
+    // Call aSink on the bar still forming of every interval that has one, as it stands after the trades so far. A live view shows
+    // them and revises them in place until they are emitted.
+    template <typename Sink>
+    void ForEachForming(Sink&& aSink) const
+    {
+        auto lForming = mBars.front();
+
+        if (lForming.end == 0)
+            return;
+
+        aSink(BarInterval::e1Minute, ToBar(lForming));
+
+        for (size_t i = 1; i < BAR_INTERVAL_COUNT; ++i)
+        {
+            auto lBar = mBars[i];
+
+            if (lBar.end == 0)
+            {
+                lBar       = lForming;
+                lBar.start = Floor(lForming.start, BAR_INTERVAL_MINUTES[i] * MILLIS_PER_MINUTE);
+            }
+            else
+                Merge(lBar, lForming);
+
+            aSink(static_cast<BarInterval>(i), ToBar(lBar));
+            lForming = lBar;
+        }
+    }
+
+    // Emit the bars still forming, at the end of the trades, and start over.
+    template <typename Sink>
+    void Finish(Sink&& aSink)
+    {
+        ForEachForming(aSink);
+
+        mBars = {};
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_BAR_AGGREGATOR_H__
@@ -0,0 +1,202 @@
+#ifndef __ABOLLO_MARKET_MODEL_CANDLE_PATTERNS_H__
+#define __ABOLLO_MARKET_MODEL_CANDLE_PATTERNS_H__
+
+
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Utility/AlignedAllocator.h"
+#include "Utility/DoubleEndedVector.h"
+
+
+
+namespace abollo
+{
+
+
+
+enum class CandlePattern : uint8_t
+{
+    eDoji,
+    eHammer,
+    eBullishEngulfing,
+    eBearishEngulfing,
+    eMorningStar,
+    eInsideBar,
+    eGapUp,
+    eGapDown,
+    eCount
+};
+
+
+constexpr auto PATTERN_COUNT = static_cast<size_t>(CandlePattern::eCount);
+
+
+
+// Candlestick patterns of one code, one bitset per pattern with bit t set when row t completes the pattern.
+// The open, close, low and high columns are kept oldest first and padded with NaN: HISTORY rows before the first one, so that every
+// row has the previous candles the patterns look at, and up to a multiple of LANES after the last one, so that Scan only runs full
+// SIMD vectors. Every comparison with a NaN is false, a padding row neither matches nor lets the rows next to it match.
+// push_back adds older rows and push_front newer ones, as with CircularMarketingTable. The columns grow and shrink at both ends in
+// O(page) and the patterns of a row only look at the HISTORY rows before it, so only the rows whose candles or look-back changed are
+// scanned again: older rows shift the bitsets by their count and scan themselves and the HISTORY rows after them, newer rows scan from
+// the first of them. Dropping the oldest rows once the ring is full shifts the bitsets back and scans the HISTORY new oldest rows,
+// dropping the newest ones only clears their bits.
+class CandlePatterns final
+{
+public:
+    constexpr static uint32_t LANES   = 8;
+    constexpr static uint32_t HISTORY = 2;    // Candles before the last one of the longest pattern, the morning star.
+
+private:
+    constexpr static uint32_t WORD_BITS = 64;
+
+    using Column = DoubleEndedVector<float, AlignedAllocator<float>>;
+
+    uint32_t mSize{0};
+
+    Column mOpens;
+    Column mCloses;
+    Column mLows;
+    Column mHighs;
+
+    std::array<std::vector<uint64_t>, PATTERN_COUNT> mBits;
+
+    [[nodiscard]] static size_t Stride(const uint32_t aSize)
+    {
+        return HISTORY + (aSize + LANES - 1) / LANES * LANES;
+    }
+
+    // Rows of aPage, which is ordered by date descending, before the rows of aColumn, behind a new history.
+    template <typename Tag, typename U>
+    static void Prepend(Column& aColumn, const U& aPage)
+    {
+        const auto lBegin = aPage.template begin<Tag>();
+
+        aColumn.drop_front(HISTORY);
+        aColumn.prepend(std::make_reverse_iterator(lBegin + aPage.size()), std::make_reverse_iterator(lBegin));
+        aColumn.prepend_n(HISTORY, std::numeric_limits<float>::quiet_NaN());
+    }
+
+    // Rows of aPage, which is ordered by date descending, after the aSize rows of aColumn, over its padding.
+    template <typename Tag, typename U>
+    static void Append(Column& aColumn, const uint32_t aSize, const U& aPage)
+    {
+        const auto lBegin = aPage.template begin<Tag>();
+
+        aColumn.drop_back(aColumn.size() - HISTORY - aSize);
+        aColumn.append(std::make_reverse_iterator(lBegin + aPage.size()), std::make_reverse_iterator(lBegin));
+    }
+
+    // Pad the columns with NaN from the row after the last one to the end of its step.
+    void Pad();
+
+    // Move the bit of every row aCount rows up once aCount older rows are added, or down once the aCount oldest rows are dropped, and
+    // size the bitsets to the rows. Bits past the last row are cleared.
+    void ShiftUp(const uint32_t aCount);
+    void ShiftDown(const uint32_t aCount);
+
+public:
+    CandlePatterns()
+    {
+        Resize(0);
+    }
+
+    // Keep aSize rows, every one a padding row until Set.
+    void Resize(const uint32_t aSize);
+
+    // aRow is counted from the oldest row.
+    void Set(const uint32_t aRow, const float aOpen, const float aClose, const float aLow, const float aHigh)
+    {
+        assert(aRow < mSize);
+
+        mOpens[HISTORY + aRow]  = aOpen;
+        mCloses[HISTORY + aRow] = aClose;
+        mLows[HISTORY + aRow]   = aLow;
+        mHighs[HISTORY + aRow]  = aHigh;
+    }
+
+    // Evaluate every pattern on the rows [aFrom, aTo), counted from the oldest row, 8 rows per step with branch-free predicates. The
+    // steps holding the first and the last row are evaluated whole.
+    void Scan(const uint32_t aFrom = 0, const uint32_t aTo = std::numeric_limits<uint32_t>::max());
+
+    template <typename U>
+    void push_back(const U& aPage)
+    {
+        const auto lCount = static_cast<uint32_t>(aPage.size());
+
+        Prepend<open_tag>(mOpens, aPage);
+        Prepend<close_tag>(mCloses, aPage);
+        Prepend<low_tag>(mLows, aPage);
+        Prepend<high_tag>(mHighs, aPage);
+
+        mSize += lCount;
+
+        Pad();
+        ShiftUp(lCount);
+
+        // The rows that had the padding of the history as previous candles now have the newest rows of the page.
+        Scan(0, lCount + HISTORY);
+    }
+
+    template <typename U>
+    void push_front(const U& aPage)
+    {
+        const auto lFrom = mSize;
+
+        Append<open_tag>(mOpens, mSize, aPage);
+        Append<close_tag>(mCloses, mSize, aPage);
+        Append<low_tag>(mLows, mSize, aPage);
+        Append<high_tag>(mHighs, mSize, aPage);
+
+        mSize += static_cast<uint32_t>(aPage.size());
+
+        Pad();
+        ShiftUp(0);
+        Scan(lFrom);
+    }
+
+    // Drop the aCount oldest rows, as the ring does once full.
+    void pop_back(const uint32_t aCount);
+
+    // Drop the aCount newest rows.
+    void pop_front(const uint32_t aCount);
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return mSize;
+    }
+
+    // Bit t of the result is row t from the oldest one.
+    [[nodiscard]] const std::vector<uint64_t>& Bits(const CandlePattern aPattern) const
+    {
+        return mBits[static_cast<size_t>(aPattern)];
+    }
+
+    // aRow is counted from the oldest row.
+    [[nodiscard]] bool Test(const CandlePattern aPattern, const uint32_t aRow) const
+    {
+        assert(aRow < mSize);
+
+        return (Bits(aPattern)[aRow / WORD_BITS] >> (aRow % WORD_BITS) & 1u) != 0;
+    }
+
+    // Rows of [aFirst, aLast) that match aPattern, indices follow DataAnalyzer, 0 is the newest row. The result holds the distance of
+    // every match from aFirst, only the words of the bitset that cover the range are read.
+    [[nodiscard]] std::vector<uint32_t> Matches(const CandlePattern aPattern, const uint32_t aFirst, const uint32_t aLast) const;
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_CANDLE_PATTERNS_H__
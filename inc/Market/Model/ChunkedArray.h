@@ -3,8 +3,23 @@
 
 
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <cstdlib>
+#endif
+
+#include <thrust/device_vector.h>
 
 
 
@@ -13,10 +28,524 @@ namespace abollo
 
 
 
+template <typename C, const uint32_t Size, typename Tag>
+class ChunkedArray;
+
+
+
+// Counters of a pool: requests served from the free list and from the heap, and the most items ever out at the same time. Once
+// paging reaches a steady state the misses stop growing.
+struct PoolStatistics
+{
+    uint64_t hits{0};
+    uint64_t misses{0};
+    size_t outstanding{0};
+    size_t highWater{0};
+};
+
+
+
+namespace internal
+{
+
+
+
+constexpr uint32_t Log2(const uint32_t aValue)
+{
+    return aValue <= 1 ? 0 : 1 + Log2(aValue / 2);
+}
+
+
+
+// Blocks of Size values shared by every ChunkedArray of the same value type and block size. Released blocks are kept for the next
+// table instead of going back to the heap, so loading page after page settles on a fixed set of blocks.
+template <typename T, const uint32_t Size>
+class ChunkPool final
+{
+public:
+    // A block of floats is a 4 KiB page, smaller blocks are at least aligned on a cache line.
+    constexpr static size_t BLOCK_BYTES = sizeof(T) * Size;
+    constexpr static size_t ALIGNMENT   = BLOCK_BYTES >= 4096 ? 4096 : 64;
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<T*> mFree;
+    PoolStatistics mStatistics;
+
+    ChunkPool() = default;
+
+    // Blocks come from the C runtime: _aligned_malloc on Windows, which has no std::aligned_alloc.
+    [[nodiscard]] static T* NewBlock()
+    {
+#ifdef _WIN32
+        auto* lBlock = _aligned_malloc(BLOCK_BYTES, ALIGNMENT);
+#else
+        auto* lBlock = std::aligned_alloc(ALIGNMENT, BLOCK_BYTES);
+#endif
+
+        if (lBlock == nullptr)
+            throw std::bad_alloc();
+
+        return static_cast<T*>(lBlock);
+    }
+
+    static void DeleteBlock(T* aBlock)
+    {
+#ifdef _WIN32
+        _aligned_free(aBlock);
+#else
+        std::free(aBlock);
+#endif
+    }
+
+public:
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    ~ChunkPool()
+    {
+        for (auto* lBlock : mFree)
+            DeleteBlock(lBlock);
+    }
+
+    [[nodiscard]] static ChunkPool& Instance()
+    {
+        static ChunkPool sPool;
+
+        return sPool;
+    }
+
+    [[nodiscard]] T* Allocate()
+    {
+        {
+            const std::lock_guard<std::mutex> lLock{mMutex};
+
+            mStatistics.highWater = std::max(mStatistics.highWater, ++mStatistics.outstanding);
+
+            if (!mFree.empty())
+            {
+                auto* lBlock = mFree.back();
+                mFree.pop_back();
+
+                ++mStatistics.hits;
+                return lBlock;
+            }
+
+            ++mStatistics.misses;
+        }
+
+        return NewBlock();
+    }
+
+    void Release(T* aBlock)
+    {
+        const std::lock_guard<std::mutex> lLock{mMutex};
+
+        --mStatistics.outstanding;
+        mFree.push_back(aBlock);
+    }
+
+    [[nodiscard]] PoolStatistics Statistics() const
+    {
+        const std::lock_guard<std::mutex> lLock{mMutex};
+
+        return mStatistics;
+    }
+};
+
+
+
+// Position of a value in a ChunkedArray. Positions are counted from the first block ever allocated and go below 0 as blocks are
+// prepended, so an iterator keeps designating the same value however the array grows at either end.
+template <typename T, const uint32_t Size, typename V>
+class ChunkedIterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::remove_const_t<V>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = V*;
+    using reference         = V&;
+
+private:
+    constexpr static uint32_t SHIFT = Log2(Size);
+    constexpr static int64_t MASK   = Size - 1;
+
+    template <typename, const uint32_t, typename>
+    friend class ChunkedIterator;
+
+    template <typename, const uint32_t, typename>
+    friend class abollo::ChunkedArray;
+
+    const std::deque<T*>* mpBlocks{nullptr};
+    const int64_t* mpFirstBlock{nullptr};
+    int64_t mPosition{0};
+
+    ChunkedIterator(const std::deque<T*>* aBlocks, const int64_t* aFirstBlock, const int64_t aPosition)
+        : mpBlocks{aBlocks}, mpFirstBlock{aFirstBlock}, mPosition{aPosition}
+    {
+    }
+
+public:
+    ChunkedIterator() = default;
+
+    // An iterator converts to a const_iterator.
+    template <typename W, typename = std::enable_if_t<std::is_const<V>::value && !std::is_const<W>::value>>
+    ChunkedIterator(const ChunkedIterator<T, Size, W>& aOther) : mpBlocks{aOther.mpBlocks}, mpFirstBlock{aOther.mpFirstBlock}, mPosition{aOther.mPosition}
+    {
+    }
+
+    [[nodiscard]] reference operator*() const
+    {
+        return (*mpBlocks)[static_cast<size_t>((mPosition >> SHIFT) - *mpFirstBlock)][mPosition & MASK];
+    }
+
+    [[nodiscard]] pointer operator->() const
+    {
+        return &**this;
+    }
+
+    [[nodiscard]] reference operator[](const difference_type aOffset) const
+    {
+        return *(*this + aOffset);
+    }
+
+    // Values from this one to the end of its block are contiguous.
+    [[nodiscard]] difference_type BlockLeft() const
+    {
+        return Size - (mPosition & MASK);
+    }
+
+    ChunkedIterator& operator++()
+    {
+        ++mPosition;
+        return *this;
+    }
+
+    ChunkedIterator operator++(int)
+    {
+        auto lCopy = *this;
+        ++mPosition;
+        return lCopy;
+    }
+
+    ChunkedIterator& operator--()
+    {
+        --mPosition;
+        return *this;
+    }
+
+    ChunkedIterator operator--(int)
+    {
+        auto lCopy = *this;
+        --mPosition;
+        return lCopy;
+    }
+
+    ChunkedIterator& operator+=(const difference_type aOffset)
+    {
+        mPosition += aOffset;
+        return *this;
+    }
+
+    ChunkedIterator& operator-=(const difference_type aOffset)
+    {
+        mPosition -= aOffset;
+        return *this;
+    }
+
+    [[nodiscard]] friend ChunkedIterator operator+(ChunkedIterator aIterator, const difference_type aOffset)
+    {
+        return aIterator += aOffset;
+    }
+
+    [[nodiscard]] friend ChunkedIterator operator+(const difference_type aOffset, ChunkedIterator aIterator)
+    {
+        return aIterator += aOffset;
+    }
+
+    [[nodiscard]] friend ChunkedIterator operator-(ChunkedIterator aIterator, const difference_type aOffset)
+    {
+        return aIterator -= aOffset;
+    }
+
+    [[nodiscard]] friend difference_type operator-(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition - aSecond.mPosition;
+    }
+
+    [[nodiscard]] friend bool operator==(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition == aSecond.mPosition;
+    }
+
+    [[nodiscard]] friend bool operator!=(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition != aSecond.mPosition;
+    }
+
+    [[nodiscard]] friend bool operator<(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition < aSecond.mPosition;
+    }
+
+    [[nodiscard]] friend bool operator>(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition > aSecond.mPosition;
+    }
+
+    [[nodiscard]] friend bool operator<=(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition <= aSecond.mPosition;
+    }
+
+    [[nodiscard]] friend bool operator>=(const ChunkedIterator& aFirst, const ChunkedIterator& aSecond)
+    {
+        return aFirst.mPosition >= aSecond.mPosition;
+    }
+};
+
+
+
+}    // namespace internal
+
+
+
+// A column of host values kept in fixed-size blocks from a shared pool. The directory of blocks grows at either end, values never
+// move once written, so growing does not copy the history already loaded nor invalidate iterators, and there is no reallocation spike
+// however many years a table holds. Size is the number of values per block and must be a power of two.
+// Iterators are random access, ForEachSegment walks a range block by block for algorithms that want contiguous runs.
 template <typename C, const uint32_t Size, typename Tag>
 class ChunkedArray
 {
 public:
+    using value_type      = typename C::value_type;
+    using iterator        = internal::ChunkedIterator<value_type, Size, value_type>;
+    using const_iterator  = internal::ChunkedIterator<value_type, Size, const value_type>;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+
+private:
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "blocks must hold a power of two values");
+    static_assert(std::is_trivially_copyable<value_type>::value && std::is_trivially_destructible<value_type>::value, "blocks are raw pool memory");
+
+    using PoolType = internal::ChunkPool<value_type, Size>;
+
+    std::deque<value_type*> mBlocks;
+    int64_t mFirstBlock{0};    // Number of mBlocks.front().
+    int64_t mBegin{0};
+    int64_t mEnd{0};
+
+    [[nodiscard]] int64_t Capacity() const
+    {
+        return (mFirstBlock + static_cast<int64_t>(mBlocks.size())) * Size;
+    }
+
+    void Release()
+    {
+        for (auto* lBlock : mBlocks)
+            PoolType::Instance().Release(lBlock);
+
+        mBlocks.clear();
+    }
+
+public:
+    ChunkedArray() = default;
+
+    ChunkedArray(const ChunkedArray& aOther)
+    {
+        append(aOther.cbegin(), aOther.cend());
+    }
+
+    ChunkedArray(ChunkedArray&& aOther) noexcept
+        : mBlocks{std::move(aOther.mBlocks)}, mFirstBlock{aOther.mFirstBlock}, mBegin{aOther.mBegin}, mEnd{aOther.mEnd}
+    {
+        aOther.mBlocks.clear();
+        aOther.mFirstBlock = aOther.mBegin = aOther.mEnd = 0;
+    }
+
+    ChunkedArray& operator=(const ChunkedArray& aOther)
+    {
+        if (this != &aOther)
+        {
+            clear();
+            append(aOther.cbegin(), aOther.cend());
+        }
+
+        return *this;
+    }
+
+    ChunkedArray& operator=(ChunkedArray&& aOther) noexcept
+    {
+        if (this != &aOther)
+        {
+            Release();
+
+            mBlocks     = std::move(aOther.mBlocks);
+            mFirstBlock = aOther.mFirstBlock;
+            mBegin      = aOther.mBegin;
+            mEnd        = aOther.mEnd;
+
+            aOther.mBlocks.clear();
+            aOther.mFirstBlock = aOther.mBegin = aOther.mEnd = 0;
+        }
+
+        return *this;
+    }
+
+    ~ChunkedArray()
+    {
+        Release();
+    }
+
+    [[nodiscard]] auto begin() noexcept
+    {
+        return iterator{&mBlocks, &mFirstBlock, mBegin};
+    }
+
+    [[nodiscard]] auto begin() const noexcept
+    {
+        return const_iterator{&mBlocks, &mFirstBlock, mBegin};
+    }
+
+    [[nodiscard]] auto cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    [[nodiscard]] auto end() noexcept
+    {
+        return iterator{&mBlocks, &mFirstBlock, mEnd};
+    }
+
+    [[nodiscard]] auto end() const noexcept
+    {
+        return const_iterator{&mBlocks, &mFirstBlock, mEnd};
+    }
+
+    [[nodiscard]] auto cend() const noexcept
+    {
+        return end();
+    }
+
+    [[nodiscard]] decltype(auto) operator[](const uint32_t aIndex)
+    {
+        return begin()[aIndex];
+    }
+
+    [[nodiscard]] auto operator[](const uint32_t aIndex) const
+    {
+        return begin()[aIndex];
+    }
+
+    [[nodiscard]] auto front() const
+    {
+        return *begin();
+    }
+
+    [[nodiscard]] auto back() const
+    {
+        return *(end() - 1);
+    }
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return static_cast<size_t>(mEnd - mBegin);
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return mEnd == mBegin;
+    }
+
+    void push_back(const value_type& aValue)
+    {
+        if (mEnd == Capacity())
+            mBlocks.push_back(PoolType::Instance().Allocate());
+
+        *end() = aValue;
+        ++mEnd;
+    }
+
+    void push_front(const value_type& aValue)
+    {
+        if (mBegin == mFirstBlock * Size)
+        {
+            mBlocks.push_front(PoolType::Instance().Allocate());
+            --mFirstBlock;
+        }
+
+        --mBegin;
+        *begin() = aValue;
+    }
+
+    // Append [aFirst, aLast) a block at a time.
+    template <typename Iterator>
+    void append(Iterator aFirst, const Iterator aLast)
+    {
+        while (aFirst != aLast)
+        {
+            if (mEnd == Capacity())
+                mBlocks.push_back(PoolType::Instance().Allocate());
+
+            const auto lRun = std::min<int64_t>(end().BlockLeft(), std::distance(aFirst, aLast));
+
+            std::copy_n(aFirst, lRun, &*end());
+            std::advance(aFirst, lRun);
+            mEnd += lRun;
+        }
+    }
+
+    // Grow or shrink at the back, new values are left as the pool hands them out.
+    void resize(const size_t aSize)
+    {
+        mEnd = mBegin + static_cast<int64_t>(aSize);
+
+        while (mEnd > Capacity())
+            mBlocks.push_back(PoolType::Instance().Allocate());
+
+        while (!mBlocks.empty() && Capacity() - Size >= mEnd)
+        {
+            PoolType::Instance().Release(mBlocks.back());
+            mBlocks.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        Release();
+
+        mFirstBlock = mBegin = mEnd = 0;
+    }
+
+    // Empty the array but keep its blocks, refilling it up to the same size allocates nothing.
+    void reset()
+    {
+        mBegin = mEnd = mFirstBlock * Size;
+    }
+
+    // Call aOp(first, last) on every contiguous run of the values [aFirst, aLast), in order.
+    template <typename Op>
+    void ForEachSegment(const size_t aFirst, const size_t aLast, Op&& aOp) const
+    {
+        for (auto lIterator = begin() + static_cast<int64_t>(aFirst), lEnd = begin() + static_cast<int64_t>(aLast); lIterator < lEnd;)
+        {
+            const auto lRun = std::min(lIterator.BlockLeft(), lEnd - lIterator);
+
+            aOp(&*lIterator, &*lIterator + lRun);
+            lIterator += lRun;
+        }
+    }
+};
+
+
+
+// Device columns stay a single preallocated buffer: kernels bind them by raw pointer and CircularMarketingTable wraps around it.
+template <typename T, const uint32_t Size, typename Tag>
+class ChunkedArray<thrust::device_vector<T>, Size, Tag>
+{
+public:
+    using C               = thrust::device_vector<T>;
     using iterator        = typename C::iterator;
     using const_iterator  = typename C::const_iterator;
     using reference       = typename C::reference;
@@ -7,6 +7,7 @@
 #include <thrust/host_vector.h>
 
 #include "Market/Model/ColumnTraits.h"
+#include "Market/Model/RingRange.h"
 #include "Market/Model/Table.h"
 
 
@@ -26,15 +27,21 @@ class CircularMarketingTable;
 
 
 
+// Ring of the 1 << P rows charted, the newest first. The value columns are device vectors preallocated to the ring, so that every
+// kernel of DataAnalyzer runs over at most two contiguous segments of them, see Segments.
+//
+// Open work: unlike the host columns, which grow over ChunkedArray blocks, the ring is still capped at 1 << P rows, and DataAnalyzer
+// trims every table to it. Holding more rows on the device needs a directory of device blocks and kernels that run block by block,
+// as the host algorithms do over ChunkedArray segments.
 template <typename T, const uint8_t P, typename... Tags>
-class CircularMarketingTable<T, P, TableSchema<Tags...>> : private Column<thrust::host_vector<date::year_month_day>, 1 << P, date_tag>,
+class CircularMarketingTable<T, P, TableSchema<Tags...>> : private Column<thrust::host_vector<date::sys_days>, 1 << P, date_tag>,
                                                            public Table<thrust::device_vector<T>, 1 << P, remove_t<date_tag, Tags...>>
 {
 public:
     using Schema = TableSchema<Tags...>;
 
 private:
-    using DateColumn = Column<thrust::host_vector<date::year_month_day>, 1 << P, date_tag>;
+    using DateColumn = Column<thrust::host_vector<date::sys_days>, 1 << P, date_tag>;
     using BaseTable  = Table<thrust::device_vector<T>, 1 << P, remove_t<date_tag, Tags...>>;
 
     constexpr static uint32_t CAPACITY      = 1 << P;
@@ -132,6 +139,12 @@ public:
     using BaseTable::begin;
     using BaseTable::end;
 
+    // The date column is a host ChunkedArray, sized once to the ring like the device columns.
+    CircularMarketingTable()
+    {
+        DateColumn::resize(CAPACITY);
+    }
+
     template <typename Tag>
     [[nodiscard]] auto begin() const
     {
@@ -177,26 +190,37 @@ public:
         return mSize;
     }
 
+    // Logical rows [aFirst, aLast), counted from the first row of the ring, as physical rows of the columns.
+    [[nodiscard]] RingRange Segments(const uint32_t aFirst, const uint32_t aLast) const
+    {
+        assert(aFirst <= aLast && aLast <= mSize);
+
+        const auto lStart = (mFirst + aFirst) & CAPACITY_MASK;
+        const auto lCount = aLast - aFirst;
+        const auto lHead  = std::min(lCount, CAPACITY - lStart);
+
+        return {{lStart, lStart + lHead}, {0, lCount - lHead}, CAPACITY_MASK};
+    }
+
+    // Logical row aIndex, counted from the first row of the ring like Segments.
     template <typename Tag>
     [[nodiscard]] auto at(const uint32_t aIndex) const
     {
         using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, DeviceColumn<T, CAPACITY, Tag>>;
 
-        return BaseType::operator[](aIndex);
+        return BaseType::operator[]((mFirst + aIndex) & CAPACITY_MASK);
     }
 
     template <typename Tag>
     [[nodiscard]] auto front() const
     {
-        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, DeviceColumn<T, CAPACITY, Tag>>;
-
-        return BaseType::front();
+        return at<Tag>(0);
     }
 
     template <typename Tag>
     [[nodiscard]] auto back() const
     {
-        return *(begin<Tag>() + size() - 1);
+        return at<Tag>(size() - 1);
     }
 };
 
@@ -0,0 +1,580 @@
+#ifndef __ABOLLO_MARKET_MODEL_COLUMN_EXPRESSION_H__
+#define __ABOLLO_MARKET_MODEL_COLUMN_EXPRESSION_H__
+
+
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <thrust/detail/normal_iterator.h>
+#include <thrust/device_ptr.h>
+#include <thrust/extrema.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/memory.h>
+#include <thrust/pair.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Market/Model/RingRange.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Lazy arithmetic over the float columns of a table: col<close_tag>() / col<pre_close_tag>() - 1.f builds an expression tree, no column
+// is read until the tree is bound to a table and evaluated. Evaluate, Sum and MinMax then run one fused transform or transform_reduce
+// over the rows, each row reads its columns once and nothing is materialized in between. Bound columns are raw pointers, so the same
+// expression runs on the host for host vectors and on the device for the CircularMarketingTable, the backend follows the table. A
+// column must hold its rows in one run of memory, the blocks of a ChunkedArray, and so pages, cannot be bound. Over a RingRange the
+// rows of a column are logical: an offset that runs past the end of the buffer continues at its start, as the older rows of the ring do.
+
+
+
+// Column Tag, aOffset rows further. Rows are newest first, so col<close_tag>(1) is the previous close.
+template <typename Tag>
+struct ColumnExpression
+{
+    using tag = Tag;
+
+    uint32_t offset;
+};
+
+
+struct ConstantExpression
+{
+    float value;
+
+    __host__ __device__ float operator()(const uint32_t) const
+    {
+        return value;
+    }
+};
+
+
+template <typename Op, typename E>
+struct UnaryExpression
+{
+    E operand;
+
+    __host__ __device__ float operator()(const uint32_t aRow) const
+    {
+        return Op{}(operand(aRow));
+    }
+};
+
+
+template <typename Op, typename L, typename R>
+struct BinaryExpression
+{
+    L left;
+    R right;
+
+    __host__ __device__ float operator()(const uint32_t aRow) const
+    {
+        return Op{}(left(aRow), right(aRow));
+    }
+};
+
+
+template <typename Tag>
+[[nodiscard]] constexpr ColumnExpression<Tag> col(const uint32_t aOffset = 0)
+{
+    return {aOffset};
+}
+
+
+
+namespace internal
+{
+
+
+
+struct BoundColumn
+{
+    const float* data;
+    uint32_t offset;
+    uint32_t mask;    // Capacity - 1 of a ring, every bit set for a column that does not wrap.
+
+    __host__ __device__ float operator()(const uint32_t aRow) const
+    {
+        return data[(aRow + offset) & mask];
+    }
+};
+
+
+struct negate_op
+{
+    __host__ __device__ float operator()(const float aValue) const
+    {
+        return -aValue;
+    }
+};
+
+
+struct abs_op
+{
+    __host__ __device__ float operator()(const float aValue) const
+    {
+        return aValue < 0.f ? -aValue : aValue;
+    }
+};
+
+
+struct plus_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return aFirst + aSecond;
+    }
+};
+
+
+struct minus_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return aFirst - aSecond;
+    }
+};
+
+
+struct multiplies_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return aFirst * aSecond;
+    }
+};
+
+
+struct divides_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return aFirst / aSecond;
+    }
+};
+
+
+struct min_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return thrust::min(aFirst, aSecond);
+    }
+};
+
+
+struct max_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return thrust::max(aFirst, aSecond);
+    }
+};
+
+
+// 1 where the first value is above the second one, 0 elsewhere, NaN included, so that the result is a long or flat position.
+struct greater_op
+{
+    __host__ __device__ float operator()(const float aFirst, const float aSecond) const
+    {
+        return aFirst > aSecond ? 1.f : 0.f;
+    }
+};
+
+
+struct minmax_op
+{
+    __host__ __device__ thrust::pair<float, float> operator()(const thrust::pair<float, float>& aFirst, const thrust::pair<float, float>& aSecond) const
+    {
+        return thrust::make_pair(thrust::min(aFirst.first, aSecond.first), thrust::max(aFirst.second, aSecond.second));
+    }
+};
+
+
+// Evaluates two expressions on the same row, so that the minimum of one and the maximum of the other share a single pass.
+template <typename L, typename H>
+struct PairExpression
+{
+    L low;
+    H high;
+
+    __host__ __device__ thrust::pair<float, float> operator()(const uint32_t aRow) const
+    {
+        return thrust::make_pair(low(aRow), high(aRow));
+    }
+};
+
+
+// Columns whose rows are consecutive in memory: raw pointers and the iterators of thrust vectors.
+template <typename I>
+struct is_contiguous_column : std::is_pointer<I>
+{
+};
+
+template <typename P>
+struct is_contiguous_column<thrust::detail::normal_iterator<P>> : std::true_type
+{
+};
+
+template <typename T>
+struct is_contiguous_column<thrust::device_ptr<T>> : std::true_type
+{
+};
+
+
+template <typename T>
+struct is_expression : std::false_type
+{
+};
+
+template <typename Tag>
+struct is_expression<ColumnExpression<Tag>> : std::true_type
+{
+};
+
+template <>
+struct is_expression<ConstantExpression> : std::true_type
+{
+};
+
+template <typename Op, typename E>
+struct is_expression<UnaryExpression<Op, E>> : std::true_type
+{
+};
+
+template <typename Op, typename L, typename R>
+struct is_expression<BinaryExpression<Op, L, R>> : std::true_type
+{
+};
+
+
+template <typename L, typename R>
+using enable_if_expression_t = std::enable_if_t<is_expression<std::decay_t<L>>::value || is_expression<std::decay_t<R>>::value>;
+
+
+template <typename E>
+constexpr std::enable_if_t<is_expression<E>::value, E> Wrap(const E& aExpression)
+{
+    return aExpression;
+}
+
+constexpr ConstantExpression Wrap(const float aValue)
+{
+    return {aValue};
+}
+
+
+template <typename Op, typename L, typename R>
+constexpr auto MakeBinary(const L& aLeft, const R& aRight)
+{
+    using LeftType  = decltype(Wrap(aLeft));
+    using RightType = decltype(Wrap(aRight));
+
+    return BinaryExpression<Op, LeftType, RightType>{Wrap(aLeft), Wrap(aRight)};
+}
+
+
+// Backend of the table behind the first column of the expression, void for an expression without columns.
+template <typename T, typename E>
+struct expression_system
+{
+    using type = void;
+};
+
+template <typename T, typename Tag>
+struct expression_system<T, ColumnExpression<Tag>>
+{
+    using type = typename thrust::iterator_system<decltype(std::declval<const T&>().template begin<Tag>())>::type;
+};
+
+template <typename T, typename Op, typename E>
+struct expression_system<T, UnaryExpression<Op, E>> : expression_system<T, E>
+{
+};
+
+template <typename T, typename Op, typename L, typename R>
+struct expression_system<T, BinaryExpression<Op, L, R>>
+{
+    using type = std::conditional_t<std::is_void<typename expression_system<T, L>::type>::value, typename expression_system<T, R>::type,
+                                    typename expression_system<T, L>::type>;
+};
+
+
+template <typename T, typename E>
+using expression_system_t = typename expression_system<T, E>::type;
+
+
+template <typename T, typename E>
+auto Rows(const uint32_t aRow)
+{
+    static_assert(!std::is_void<expression_system_t<T, E>>::value, "The expression reads no column.");
+
+    return thrust::counting_iterator<uint32_t, expression_system_t<T, E>>{aRow};
+}
+
+
+
+}    // namespace internal
+
+
+
+template <typename E, typename = std::enable_if_t<internal::is_expression<E>::value>>
+constexpr auto operator-(const E& aOperand)
+{
+    return UnaryExpression<internal::negate_op, E>{aOperand};
+}
+
+template <typename E, typename = std::enable_if_t<internal::is_expression<E>::value>>
+constexpr auto Abs(const E& aOperand)
+{
+    return UnaryExpression<internal::abs_op, E>{aOperand};
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto operator+(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::plus_op>(aLeft, aRight);
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto operator-(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::minus_op>(aLeft, aRight);
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto operator*(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::multiplies_op>(aLeft, aRight);
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto operator/(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::divides_op>(aLeft, aRight);
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto Min(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::min_op>(aLeft, aRight);
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto Max(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::max_op>(aLeft, aRight);
+}
+
+template <typename L, typename R, typename = internal::enable_if_expression_t<L, R>>
+constexpr auto Greater(const L& aLeft, const R& aRight)
+{
+    return internal::MakeBinary<internal::greater_op>(aLeft, aRight);
+}
+
+
+
+// Replace the columns of the expression by pointers into aTable. aTable must outlive the result. Rows wrap at aMask + 1 when aTable
+// is a ring, see RingRange::mask.
+template <typename T, typename Tag>
+[[nodiscard]] internal::BoundColumn Bind(const T& aTable, const ColumnExpression<Tag>& aExpression, const uint32_t aMask = RingRange::NO_WRAP)
+{
+    static_assert(internal::is_contiguous_column<std::decay_t<decltype(aTable.template begin<Tag>())>>::value, "Rows are read past the first block of the column.");
+
+    return {thrust::raw_pointer_cast(&*aTable.template begin<Tag>()), aExpression.offset, aMask};
+}
+
+template <typename T>
+[[nodiscard]] ConstantExpression Bind(const T&, const ConstantExpression& aExpression, const uint32_t = RingRange::NO_WRAP)
+{
+    return aExpression;
+}
+
+template <typename T, typename Op, typename E>
+[[nodiscard]] auto Bind(const T& aTable, const UnaryExpression<Op, E>& aExpression, const uint32_t aMask = RingRange::NO_WRAP)
+{
+    using OperandType = decltype(Bind(aTable, aExpression.operand, aMask));
+
+    return UnaryExpression<Op, OperandType>{Bind(aTable, aExpression.operand, aMask)};
+}
+
+template <typename T, typename Op, typename L, typename R>
+[[nodiscard]] auto Bind(const T& aTable, const BinaryExpression<Op, L, R>& aExpression, const uint32_t aMask = RingRange::NO_WRAP)
+{
+    using LeftType  = decltype(Bind(aTable, aExpression.left, aMask));
+    using RightType = decltype(Bind(aTable, aExpression.right, aMask));
+
+    return BinaryExpression<Op, LeftType, RightType>{Bind(aTable, aExpression.left, aMask), Bind(aTable, aExpression.right, aMask)};
+}
+
+
+
+namespace internal
+{
+
+
+
+template <typename T, typename E, typename OutputIterator>
+OutputIterator EvaluateRows(const T& aTable, const E& aExpression, const uint32_t aFirst, const uint32_t aLast, const uint32_t aMask, OutputIterator aOutput)
+{
+    return thrust::transform(Rows<T, E>(aFirst), Rows<T, E>(aLast), aOutput, Bind(aTable, aExpression, aMask));
+}
+
+
+template <typename U, typename T, typename E>
+U SumRows(const T& aTable, const E& aExpression, const uint32_t aFirst, const uint32_t aLast, const uint32_t aMask)
+{
+    return thrust::transform_reduce(Rows<T, E>(aFirst), Rows<T, E>(aLast), Bind(aTable, aExpression, aMask), U{0}, thrust::plus<U>{});
+}
+
+
+template <typename T, typename L, typename H>
+std::pair<float, float> MinMaxRows(const T& aTable, const L& aLowExpression, const H& aHighExpression, const uint32_t aFirst, const uint32_t aLast, const uint32_t aMask)
+{
+    if (aFirst >= aLast)
+        return {0.f, 0.f};
+
+    using PairType = PairExpression<decltype(Bind(aTable, aLowExpression, aMask)), decltype(Bind(aTable, aHighExpression, aMask))>;
+    using BothType = BinaryExpression<plus_op, L, H>;
+
+    const PairType lPair{Bind(aTable, aLowExpression, aMask), Bind(aTable, aHighExpression, aMask)};
+    const auto lInit = thrust::make_pair(std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity());
+
+    const auto lResult = thrust::transform_reduce(Rows<T, BothType>(aFirst), Rows<T, BothType>(aLast), lPair, lInit, minmax_op{});
+
+    return {lResult.first, lResult.second};
+}
+
+
+
+}    // namespace internal
+
+
+
+// Write the expression for the rows [aFirst, aLast) to aOutput, which must live on the same backend as aTable.
+template <typename T, typename E, typename OutputIterator>
+OutputIterator Evaluate(const T& aTable, const E& aExpression, const uint32_t aFirst, const uint32_t aLast, OutputIterator aOutput)
+{
+    return internal::EvaluateRows(aTable, aExpression, aFirst, aLast, RingRange::NO_WRAP, aOutput);
+}
+
+
+template <typename U = float, typename T, typename E>
+[[nodiscard]] U Sum(const T& aTable, const E& aExpression, const uint32_t aFirst, const uint32_t aLast)
+{
+    return internal::SumRows<U>(aTable, aExpression, aFirst, aLast, RingRange::NO_WRAP);
+}
+
+
+// Minimum of aLowExpression and maximum of aHighExpression over the rows [aFirst, aLast), in one pass. (0, 0) if the range is empty.
+template <typename T, typename L, typename H>
+[[nodiscard]] std::pair<float, float> MinMax(const T& aTable, const L& aLowExpression, const H& aHighExpression, const uint32_t aFirst, const uint32_t aLast)
+{
+    return internal::MinMaxRows(aTable, aLowExpression, aHighExpression, aFirst, aLast, RingRange::NO_WRAP);
+}
+
+template <typename T, typename E>
+[[nodiscard]] std::pair<float, float> MinMax(const T& aTable, const E& aExpression, const uint32_t aFirst, const uint32_t aLast)
+{
+    return MinMax(aTable, aExpression, aExpression, aFirst, aLast);
+}
+
+
+
+// The same over the rows of a ring, one pass per segment. Evaluate writes the segments one after the other, Sum and MinMax merge them.
+// Offsets are logical rows, col<close_tag>(1) of the last physical row of the buffer reads its first one.
+template <typename T, typename E, typename OutputIterator>
+OutputIterator Evaluate(const T& aTable, const E& aExpression, const RingRange& aRange, OutputIterator aOutput)
+{
+    aRange.ForEach([&](const RingSegment& aSegment) { aOutput = internal::EvaluateRows(aTable, aExpression, aSegment.first, aSegment.last, aRange.mask, aOutput); });
+
+    return aOutput;
+}
+
+
+template <typename U = float, typename T, typename E>
+[[nodiscard]] U Sum(const T& aTable, const E& aExpression, const RingRange& aRange)
+{
+    U lSum{0};
+
+    aRange.ForEach([&](const RingSegment& aSegment) { lSum += internal::SumRows<U>(aTable, aExpression, aSegment.first, aSegment.last, aRange.mask); });
+
+    return lSum;
+}
+
+
+template <typename T, typename L, typename H>
+[[nodiscard]] std::pair<float, float> MinMax(const T& aTable, const L& aLowExpression, const H& aHighExpression, const RingRange& aRange)
+{
+    std::pair<float, float> lMinMax{0.f, 0.f};
+    auto lEmpty = true;
+
+    // Segments are never empty, only the range may be.
+    aRange.ForEach([&](const RingSegment& aSegment) {
+        const auto lSegment = internal::MinMaxRows(aTable, aLowExpression, aHighExpression, aSegment.first, aSegment.last, aRange.mask);
+
+        lMinMax = lEmpty ? lSegment : std::make_pair(thrust::min(lMinMax.first, lSegment.first), thrust::max(lMinMax.second, lSegment.second));
+        lEmpty  = false;
+    });
+
+    return lMinMax;
+}
+
+template <typename T, typename E>
+[[nodiscard]] std::pair<float, float> MinMax(const T& aTable, const E& aExpression, const RingRange& aRange)
+{
+    return MinMax(aTable, aExpression, aExpression, aRange);
+}
+
+
+
+// Derived series of the market data columns.
+namespace series
+{
+
+
+
+[[nodiscard]] constexpr auto Range()
+{
+    return col<high_tag>() - col<low_tag>();
+}
+
+
+[[nodiscard]] constexpr auto Body()
+{
+    return Abs(col<close_tag>() - col<open_tag>());
+}
+
+
+[[nodiscard]] constexpr auto TypicalPrice()
+{
+    return (col<high_tag>() + col<low_tag>() + col<close_tag>()) / 3.f;
+}
+
+
+// The oldest row has no previous close, evaluate up to size() - 1.
+[[nodiscard]] constexpr auto Returns()
+{
+    return col<close_tag>() / col<close_tag>(1) - 1.f;
+}
+
+
+
+}    // namespace series
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_COLUMN_EXPRESSION_H__
@@ -14,6 +14,7 @@ namespace abollo
 
 
 struct date_tag;
+struct time_tag;
 struct seq_tag;
 struct open_tag;
 struct close_tag;
@@ -28,6 +29,28 @@ struct amount_tag;
 struct price_tag;
 struct log_price_tag;
 struct log_volume_tag;
+struct close_volume_tag;
+
+struct sma_tag;
+struct ema_tag;
+struct bollinger_upper_tag;
+struct bollinger_lower_tag;
+struct rsi_tag;
+struct macd_tag;
+struct macd_signal_tag;
+struct macd_histogram_tag;
+struct atr_tag;
+struct obv_tag;
+
+struct volatility_tag;
+struct zscore_tag;
+struct rolling_high_tag;
+struct rolling_low_tag;
+struct drawdown_tag;
+
+struct spread_tag;
+struct ratio_tag;
+struct rebased_tag;
 
 
 template <typename Tag>
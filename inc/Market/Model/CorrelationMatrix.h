@@ -0,0 +1,141 @@
+#ifndef __ABOLLO_MARKET_MODEL_CORRELATION_MATRIX_H__
+#define __ABOLLO_MARKET_MODEL_CORRELATION_MATRIX_H__
+
+
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <date/date.h>
+
+
+
+namespace abollo
+{
+
+
+
+class DataLoader;
+
+
+
+// Correlation of the daily close-to-close returns of every pair of codes over the last aDays trading dates.
+// Returns are aligned on the union of the trading dates of all codes, a code without a close on a date keeps its last close, so its
+// return that day is 0. Every code holds a ring of aDays returns, the matrix is kept as the sums and cross products of the rings:
+// - Load computes the cross products with a blocked kernel, tiles of codes and days run in parallel with SIMD dot products;
+// - Append slides the window by one trading date with a rank-2 update of the cross products, O(codes^2) instead of O(codes^2 * days).
+class CorrelationMatrix final
+{
+private:
+    constexpr static uint32_t LANES      = 8;      // Floats per SIMD dot product step.
+    constexpr static uint32_t TILE_CODES = 32;     // Codes per side of a tile.
+    constexpr static uint32_t TILE_DAYS  = 128;    // Days per pass over a tile, the 2 * TILE_CODES row segments stay in L1.
+
+    constexpr static uint32_t FILE_MAGIC   = 0x524f4341;    // "ACOR"
+    constexpr static uint32_t FILE_VERSION = 1;
+    constexpr static uint32_t CODE_SIZE    = 16;            // Codes and dates are stored zero padded.
+
+    constexpr static std::string_view DATE_FORMAT_STR = "{:04}-{:02}-{:02}";
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        uint32_t days;
+        char date[CODE_SIZE];
+    };
+
+    uint32_t mDays;
+    uint32_t mStride;     // mDays rounded up to LANES, the padding stays 0.
+    uint32_t mHead{0};    // Slot of the oldest return, the next one overwrites it.
+
+    date::sys_days mDate{};             // Last trading date of the window.
+    std::vector<std::string> mCodes;    // Sorted.
+    std::vector<float> mLastCloses;     // NaN until the first close of the code.
+
+    std::vector<float> mReturns;      // mCodes.size() rings of mStride returns.
+    std::vector<double> mSums;        // Sum of the returns of every code.
+    std::vector<double> mProducts;    // Cross products, only the upper triangle j >= i of mProducts[i * count + j] is used.
+
+    [[nodiscard]] float* Returns(const size_t aCode)
+    {
+        return mReturns.data() + aCode * mStride;
+    }
+
+    [[nodiscard]] const float* Returns(const size_t aCode) const
+    {
+        return mReturns.data() + aCode * mStride;
+    }
+
+    [[nodiscard]] double Product(const size_t aFirst, const size_t aSecond) const
+    {
+        return aFirst <= aSecond ? mProducts[aFirst * Count() + aSecond] : mProducts[aSecond * Count() + aFirst];
+    }
+
+    // Write the returns of aDate in slot mHead, aCloses holds one close per code, NaN when the code did not trade.
+    void Shift(const date::sys_days aDate, const float* aCloses, std::vector<float>& aReturns);
+
+    // Add aCode, not in Codes(), with returns of 0 over the whole window.
+    void Insert(const std::string& aCode);
+
+    void ComputeProducts();
+    void MultiplyTile(const size_t aFirstTile, const size_t aSecondTile);
+
+public:
+    CorrelationMatrix(std::vector<std::string> aCodes, const uint32_t aDays);
+
+    // Every code traded on the aDays + 1 latest trading dates, the oldest date only provides the first closes.
+    [[nodiscard]] static CorrelationMatrix Load(DataLoader& aDataLoader, const uint32_t aDays);
+
+    // Append the trading dates stored after Date(), returns how many. Codes first seen there join the matrix with returns of 0 before
+    // their first close. If more than Days() dates were stored the window is loaded again.
+    uint32_t Update(DataLoader& aDataLoader);
+
+    // Slide the window to aDate. aCloses holds one close per code in the order of Codes(), NaN when the code did not trade.
+    void Append(const date::sys_days aDate, const std::vector<float>& aCloses);
+
+    [[nodiscard]] size_t Count() const
+    {
+        return mCodes.size();
+    }
+
+    [[nodiscard]] uint32_t Days() const
+    {
+        return mDays;
+    }
+
+    [[nodiscard]] date::sys_days Date() const
+    {
+        return mDate;
+    }
+
+    [[nodiscard]] const auto& Codes() const
+    {
+        return mCodes;
+    }
+
+    // NaN if either code has constant returns over the window.
+    [[nodiscard]] float operator()(const size_t aFirst, const size_t aSecond) const;
+
+    // Correlations of every pair i < j, row by row.
+    [[nodiscard]] std::vector<float> UpperTriangle() const;
+
+    // Header with the date as YYYY-MM-DD, zero padded codes, then the upper triangle as float. Returns false if the file could not be written, aPath is then left
+    // as it was.
+    bool Save(const std::filesystem::path& aPath) const;
+
+    // Into the index_correlation table, keyed by date and window length.
+    void Store(DataLoader& aDataLoader) const;
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_CORRELATION_MATRIX_H__
@@ -6,13 +6,23 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <date/date.h>
 
+#include "Market/Model/Backtester.h"
+#include "Market/Model/CandlePatterns.h"
 #include "Market/Model/ColumnTraits.h"
 #include "Market/Model/DataLoader.h"
+#include "Market/Model/DateJoin.h"
+#include "Market/Model/IndicatorTable.h"
 #include "Market/Model/MarketDataFields.h"
+#include "Market/Model/PagePool.h"
 #include "Market/Model/PagedMarketingTable.h"
+#include "Market/Model/PrefixSumTable.h"
+#include "Market/Model/PriceColumns.h"
+#include "Market/Model/RollingStatistics.h"
+#include "Market/Model/VolumeProfile.h"
 
 
 
@@ -42,7 +52,14 @@ private:
     uint32_t mStartSeq{0};
     uint32_t mEndSeq{0};
 
+    PagePool<PagedTableType> mPagePool;    // Staging pages of the loads, emptied into the ring and returned.
+
     std::unique_ptr<ImplType> mImpl;
+    PriceColumns mPrices;    // The rows of the ring on the host, read by the tables below.
+    IndicatorTable mIndicators{mPrices};
+    PrefixSumTable mPrefixSums;
+    CandlePatterns mPatterns;
+    RollingStatistics mStatistics;
 
     [[nodiscard]] std::pair<uint32_t, uint32_t> Normalize(uint32_t aStartIndex, uint32_t aEndIndex) const
     {
@@ -52,26 +69,139 @@ private:
         if (mEndSeq < aEndIndex)
             aEndIndex = mEndSeq;
 
-        assert(aEndIndex > aStartIndex);
+        assert(aEndIndex >= aStartIndex);
 
         return {mEndSeq - aEndIndex, mEndSeq - aStartIndex + 1u};
     }
 
+    // Drop from the other tables the rows the ring dropped once full, its newest rows after Append and its oldest after Prepend, so
+    // that every table holds the rows of the ring, and take the sequence numbers of these rows.
+    void Trim(const bool aAppended);
+
 public:
     DataAnalyzer();
     ~DataAnalyzer();
 
     std::pair<std::uint32_t, std::uint32_t> LoadIndex(const std::string& aCode, const uint32_t& aOffset, const uint32_t& aLimit);
 
+    // Load aCode against aBaseCode on their common dates, the candles are the spread, ratio or rebased series of the two codes. The
+    // rows loaded are dropped, the two series are not charted together, unless the codes have no date in common, then nothing changes.
+    std::pair<std::uint32_t, std::uint32_t> LoadRelative(const std::string& aBaseCode, const std::string& aCode, const JoinSeries aSeries, const uint32_t& aOffset,
+                                                         const uint32_t& aLimit);
+
+    // Load the equity curve of the moving average crossover on aCode with the best Sharpe ratio among every pair of periods in
+    // [aMinPeriod, aMaxPeriod], swept on aPool, charted like the code itself. The rows loaded are dropped. Returns the pair charted,
+    // periods 0 if there was none.
+    BacktestResult LoadBacktest(const std::string& aCode, const uint32_t aMinPeriod, const uint32_t aMaxPeriod, WorkStealingPool& aPool, const uint32_t& aOffset,
+                                const uint32_t& aLimit);
+
+    // Add the rows of aPage, all newer than the rows loaded, as they come during a session or a replay. Every table only computes the
+    // new rows, nothing is reloaded. aPage holds no more rows than the ring.
+    std::pair<std::uint32_t, std::uint32_t> LoadNewer(const PagedTableType& aPage);
+
+    // Revise the newest row by the close, high and low it has reached so far on aDate, as an intraday feed forms it. Only the rolling
+    // statistics of that row are recomputed, the candle keeps the bar loaded until the next load. Returns false, changing nothing,
+    // unless the newest row is for aDate.
+    bool Revise(const date::sys_days aDate, const float aClose, const float aHigh, const float aLow);
+
+    // Drop the rows loaded.
+    void Clear();
+
+    // Fill aPage with the rows of aCode from the database.
+    void Fetch(const std::string& aCode, const uint32_t aOffset, const uint32_t aLimit, PagedTableType& aPage);
+
     [[nodiscard]] MarketDataFields operator[](const uint32_t aIndex) const;
     [[nodiscard]] uint32_t Size() const;
 
+    [[nodiscard]] std::pair<std::uint32_t, std::uint32_t> SeqRange() const
+    {
+        return {mStartSeq, mEndSeq};
+    }
+
     template <typename T>
     [[nodiscard]] std::pair<float, float> Range() const;
 
     template <typename T>
     [[nodiscard]] std::pair<float, float> MinMax(const uint32_t aStartIndex, const uint32_t aEndIndex) const;
 
+    // Volume of the candles between the two sequence numbers spread over aBins bins between aLow and aHigh. T is price_tag or
+    // log_price_tag, as for MinMax, and aLow and aHigh are in the same space.
+    template <typename T>
+    [[nodiscard]] VolumeProfile Profile(const uint32_t aStartIndex, const uint32_t aEndIndex, const float aLow, const float aHigh, const uint32_t aBins) const;
+
+    // Iterators over the indicator column T for the rows between the two sequence numbers, newest first like the market data.
+    template <typename T>
+    [[nodiscard]] auto Indicator(const uint32_t aStartIndex, const uint32_t aEndIndex) const
+    {
+        const auto lRange = Normalize(aStartIndex, aEndIndex);
+
+        return std::make_pair(mIndicators.begin<T>() + lRange.first, mIndicators.begin<T>() + lRange.second);
+    }
+
+    // Iterators over the rolling statistic column T for the rows between the two sequence numbers, newest first like Indicator.
+    template <typename T>
+    [[nodiscard]] auto Statistic(const uint32_t aStartIndex, const uint32_t aEndIndex) const
+    {
+        const auto lRange = Normalize(aStartIndex, aEndIndex);
+
+        return std::make_pair(mStatistics.begin<T>() + lRange.first, mStatistics.begin<T>() + lRange.second);
+    }
+
+    // Total of the volume, amount or close * volume column between the two sequence numbers, both included, in constant time.
+    template <typename T>
+    [[nodiscard]] double Sum(const uint32_t aStartIndex, const uint32_t aEndIndex) const
+    {
+        const auto lRange = Normalize(aStartIndex, aEndIndex);
+
+        return mPrefixSums.Sum<T>(lRange.first, lRange.second);
+    }
+
+    [[nodiscard]] double Vwap(const uint32_t aStartIndex, const uint32_t aEndIndex) const
+    {
+        const auto lVolume = Sum<volume_tag>(aStartIndex, aEndIndex);
+
+        return lVolume > 0.0 ? Sum<close_volume_tag>(aStartIndex, aEndIndex) / lVolume : 0.0;
+    }
+
+    // Candles between the two sequence numbers that complete aPattern, as distances from the newest of them, the first candle of Saxpy.
+    [[nodiscard]] std::vector<uint32_t> Patterns(const CandlePattern aPattern, const uint32_t aStartIndex, const uint32_t aEndIndex) const
+    {
+        const auto lRange = Normalize(aStartIndex, aEndIndex);
+
+        return mPatterns.Matches(aPattern, lRange.first, lRange.second);
+    }
+
+    // Reuse of the staging pages and of the blocks of their float columns.
+    [[nodiscard]] PoolStatistics PageStatistics() const
+    {
+        return mPagePool.Statistics();
+    }
+
+    [[nodiscard]] static PoolStatistics BlockStatistics()
+    {
+        return internal::ChunkPool<float, DEFAULT_BUFFER_COL_SIZE>::Instance().Statistics();
+    }
+
+    [[nodiscard]] const auto& GetIndicatorParameters() const
+    {
+        return mIndicators.GetParameters();
+    }
+
+    void SetIndicatorParameters(const IndicatorParameters& aParameters)
+    {
+        mIndicators.Reset(aParameters);
+    }
+
+    [[nodiscard]] const auto& GetRollingParameters() const
+    {
+        return mStatistics.GetParameters();
+    }
+
+    void SetRollingParameters(const RollingParameters& aParameters)
+    {
+        mStatistics.Reset(aParameters);
+    }
+
     template <typename T>
     [[nodiscard]] DatePricePair Saxpy(const uint32_t aStartIndex, const uint32_t aEndIndex, const float aScaleX, const float aTransX, const float aScaleY, const float aTransY,
                                       const float aScaleZ, const float aTransZ) const;
@@ -3,6 +3,7 @@
 
 
 
+#include <thrust/copy.h>
 #include <thrust/device_vector.h>
 #include <thrust/host_vector.h>
 #include <thrust/transform.h>
@@ -27,24 +28,36 @@ private:
 
     mutable thrust::device_vector<T> mDeviceTempBuffer{DEFAULT_BUFFER_COL_SIZE};
     mutable thrust::host_vector<T> mHostTempBuffer{DEFAULT_BUFFER_COL_SIZE};
+    mutable thrust::host_vector<date::sys_days> mHostDateBuffer{DEFAULT_BUFFER_COL_SIZE};
 
 public:
-    template <typename Iterator, typename Op>
-    [[nodiscard]] const auto& Transform(Iterator aBeginIter, Iterator aEndIter, Op&& aSaxpyOp) const
+    // Apply aSaxpyOp to the rows of aRange, one transform per segment into consecutive rows of the buffer, and copy the results
+    // and the dates of their rows to the host, in the order of the rows.
+    template <typename Op>
+    [[nodiscard]] const auto& Transform(const RingRange& aRange, Op&& aSaxpyOp) const
     {
-        const auto lSize = thrust::distance(aBeginIter, aEndIter);
+        assert(aRange.size() <= mDeviceTempBuffer.size());
 
-        assert(static_cast<uint32_t>(lSize) <= mDeviceTempBuffer.capacity());
+        const auto lIter = mMarketingTable.begin();
+        auto lOutput     = mDeviceTempBuffer.begin();
+        auto lDates      = mHostDateBuffer.begin();
 
-        mDeviceTempBuffer.clear();
+        aRange.ForEach([&](const RingSegment& aSegment) {
+            lOutput = thrust::transform(lIter + aSegment.first, lIter + aSegment.last, lOutput, aSaxpyOp);
+            lDates  = thrust::copy(mMarketingTable.template begin<date_tag>() + aSegment.first, mMarketingTable.template begin<date_tag>() + aSegment.last, lDates);
+        });
 
-        thrust::transform(aBeginIter, aEndIter, mDeviceTempBuffer.begin(), aSaxpyOp);
-
-        mHostTempBuffer.assign(mDeviceTempBuffer.begin(), mDeviceTempBuffer.begin() + lSize);
+        mHostTempBuffer.assign(mDeviceTempBuffer.begin(), lOutput);
 
         return mHostTempBuffer;
     }
 
+    // Dates of the rows of the last Transform.
+    [[nodiscard]] const auto& Dates() const
+    {
+        return mHostDateBuffer;
+    }
+
     [[nodiscard]] auto& Data() const
     {
         return mMarketingTable;
@@ -3,10 +3,19 @@
 
 
 
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <date/date.h>
+#include <fmt/format.h>
 #include <soci/session.h>
 #include <soci/soci.h>
 #include <soci/sqlite3/soci-sqlite3.h>
 
+#include "Market/Model/QueryProfiler.h"
+#include "Utility/Stopwatch.h"
+
 
 
 namespace abollo
@@ -17,19 +26,72 @@ namespace abollo
 class DataLoader
 {
 private:
-    constexpr static const char* INDEX_DAILY_SQL = "SELECT date, seq, open, close, low, high, volume, amount "
+    // SQLite turns the date it stores into days since the epoch straight from the column text, a DATE column would be fetched as a
+    // string per row and parsed into a std::tm. date() drops any time, julianday() of a midnight is a whole day plus a half.
+    constexpr static const char* INDEX_DAILY_SQL = "SELECT CAST(julianday(date(date)) - 2440587.5 AS INTEGER) AS epoch_day, seq, open, close, low, high, volume, amount "
                                                    "FROM index_daily_market "
                                                    "WHERE code = :code "
                                                    "ORDER BY date DESC "
                                                    "LIMIT :limit OFFSET :offset";
 
+    // :after is in days since the epoch like epoch_day, the dates after it start at the next midnight whether or not they hold a time.
+    constexpr static const char* INDEX_CLOSES_SQL = "SELECT code, CAST(julianday(date(date)) - 2440587.5 AS INTEGER) AS epoch_day, close "
+                                                    "FROM index_daily_market "
+                                                    "WHERE date IN (SELECT DISTINCT date FROM index_daily_market WHERE date >= date((:after + 1) * 86400, 'unixepoch') "
+                                                    "ORDER BY date DESC LIMIT :limit) "
+                                                    "ORDER BY date, code";
+
+    constexpr static const char* INDEX_DATE_COUNT_SQL = "SELECT COUNT(DISTINCT date(date)) "
+                                                        "FROM index_daily_market "
+                                                        "WHERE date >= date((:after + 1) * 86400, 'unixepoch')";
+
+    constexpr static const char* INDEX_CANDLES_SQL = "SELECT code, date, open, close, low, high "
+                                                     "FROM index_daily_market "
+                                                     "WHERE date IN (SELECT DISTINCT date FROM index_daily_market WHERE date > :after ORDER BY date DESC LIMIT :limit) "
+                                                     "ORDER BY date, code";
+
+    constexpr static const char* INDEX_BARS_SQL = "SELECT code, date, open, close, low, high, volume, amount "
+                                                  "FROM index_daily_market "
+                                                  "WHERE date IN (SELECT DISTINCT date FROM index_daily_market ORDER BY date DESC LIMIT :limit)";
+
+    // Condition on the bars of the latest date, the codes that fail it are left out of INDEX_BARS_SQL.
+    constexpr static const char* INDEX_BARS_FILTER_SQL = " AND code IN (SELECT code FROM index_daily_market "
+                                                         "WHERE date = (SELECT MAX(date) FROM index_daily_market) AND ({}))";
+
+    constexpr static const char* INDEX_BARS_ORDER_SQL = " ORDER BY date, code";
+
+    // The queries over every code select the rows of the latest dates, the primary key starts with the code and only serves them by a
+    // scan of the whole table.
+    constexpr static const char* INDEX_DATE_DDL = "CREATE INDEX IF NOT EXISTS index_daily_market_date ON index_daily_market (date)";
+
+    constexpr static const char* INDEX_CORRELATION_DDL = "CREATE TABLE IF NOT EXISTS index_correlation "
+                                                         "("
+                                                         "    date   DATE        NOT NULL,"
+                                                         "    days   INTEGER     NOT NULL,"
+                                                         "    code_a VARCHAR(10) NOT NULL,"
+                                                         "    code_b VARCHAR(10) NOT NULL,"
+                                                         "    value  FLOAT       NOT NULL,"
+                                                         "    PRIMARY KEY (date, days, code_a, code_b)"
+                                                         ") WITHOUT ROWID";
+
+    constexpr static const char* INDEX_CORRELATION_SQL = "INSERT OR REPLACE INTO index_correlation (date, days, code_a, code_b, value) "
+                                                         "VALUES (date(:date * 86400, 'unixepoch'), :days, :code_a, :code_b, :value)";
+
     soci::session mSession{soci::sqlite3, R"(data/ashare.db)"};
 
     soci::statement mIndexDailyStmt;
+    soci::statement mIndexClosesStmt;
+    soci::statement mIndexCandlesStmt;
+
+    bool mCorrelationTable{false};    // INDEX_CORRELATION_DDL has run on mSession.
 
 public:
-    DataLoader() : mIndexDailyStmt(mSession.prepare << INDEX_DAILY_SQL)
+    DataLoader()
+        : mIndexDailyStmt(QueryProfiler::Prepare(QueryProfiler::Attach(mSession), INDEX_DAILY_SQL)), mIndexClosesStmt(QueryProfiler::Prepare(mSession, INDEX_CLOSES_SQL)),
+          mIndexCandlesStmt(QueryProfiler::Prepare(mSession, INDEX_CANDLES_SQL))
     {
+        // SQLite prepares the statements above again on their next execution once the schema changes.
+        mSession << INDEX_DATE_DDL;
     }
 
     template <typename T, typename LoadOp>
@@ -45,13 +107,244 @@ public:
         mIndexDailyStmt.exchange(use(aOffset, "offset"));
         mIndexDailyStmt.exchange(into(lRow));
 
+        Stopwatch lStopwatch;
+
         mIndexDailyStmt.define_and_bind();
         mIndexDailyStmt.execute();
 
-        while (mIndexDailyStmt.fetch())
+        const auto lExecuteMs = lStopwatch.Lap();
+
+        // Only the time spent inside fetch() is accounted for, not the time spent in aLoadOp.
+        uint64_t lRows  = 0;
+        double lFetchMs = 0.0;
+
+        for (; mIndexDailyStmt.fetch(); lStopwatch.Reset())
+        {
+            lFetchMs += lStopwatch.Elapsed();
+
             aLoadOp(lRow);
+            ++lRows;
+        }
+
+        lFetchMs += lStopwatch.Elapsed();
 
         mIndexDailyStmt.bind_clean_up();
+
+        QueryProfiler::Instance().RecordExecution(mSession, INDEX_DAILY_SQL, "code=" + aCode + ", limit=" + std::to_string(aLimit) + ", offset=" + std::to_string(aOffset),
+                                                  lExecuteMs, lFetchMs, lRows);
+    }
+
+    // Close of every code on the aLimit latest trading dates after aAfter, ordered by date then code. aLoadOp(code, date, close).
+    template <typename LoadOp>
+    void LoadCloses(const date::sys_days aAfter, const uint32_t& aLimit, LoadOp aLoadOp)
+    {
+        using soci::into;
+        using soci::use;
+
+        const auto lAfter = aAfter.time_since_epoch().count();
+
+        std::string lCode;
+        int lEpochDay{0};
+        double lClose{0.0};
+
+        mIndexClosesStmt.exchange(use(lAfter, "after"));
+        mIndexClosesStmt.exchange(use(aLimit, "limit"));
+        mIndexClosesStmt.exchange(into(lCode));
+        mIndexClosesStmt.exchange(into(lEpochDay));
+        mIndexClosesStmt.exchange(into(lClose));
+
+        Stopwatch lStopwatch;
+
+        mIndexClosesStmt.define_and_bind();
+        mIndexClosesStmt.execute();
+
+        const auto lExecuteMs = lStopwatch.Lap();
+
+        uint64_t lRows  = 0;
+        double lFetchMs = 0.0;
+
+        for (; mIndexClosesStmt.fetch(); lStopwatch.Reset())
+        {
+            lFetchMs += lStopwatch.Elapsed();
+
+            aLoadOp(lCode, date::sys_days{date::days{lEpochDay}}, static_cast<float>(lClose));
+            ++lRows;
+        }
+
+        lFetchMs += lStopwatch.Elapsed();
+
+        mIndexClosesStmt.bind_clean_up();
+
+        QueryProfiler::Instance().RecordExecution(mSession, INDEX_CLOSES_SQL, "after=" + std::to_string(lAfter) + ", limit=" + std::to_string(aLimit), lExecuteMs,
+                                                  lFetchMs, lRows);
+    }
+
+    // Number of trading dates after aAfter.
+    [[nodiscard]] uint32_t CountDates(const date::sys_days aAfter)
+    {
+        using soci::into;
+        using soci::use;
+
+        const auto lAfter = aAfter.time_since_epoch().count();
+        int lCount{0};
+
+        mSession << INDEX_DATE_COUNT_SQL, use(lAfter, "after"), into(lCount);
+
+        return static_cast<uint32_t>(lCount);
+    }
+
+    // Candles of every code on the last aLimit trading dates after aAfter, ordered by date then code.
+    template <typename LoadOp>
+    void LoadCandles(const std::string& aAfter, const uint32_t& aLimit, LoadOp aLoadOp)
+    {
+        using soci::into;
+        using soci::use;
+
+        std::string lCode;
+        std::string lDate;
+        double lOpen{0.0};
+        double lClose{0.0};
+        double lLow{0.0};
+        double lHigh{0.0};
+
+        mIndexCandlesStmt.exchange(use(aAfter, "after"));
+        mIndexCandlesStmt.exchange(use(aLimit, "limit"));
+        mIndexCandlesStmt.exchange(into(lCode));
+        mIndexCandlesStmt.exchange(into(lDate));
+        mIndexCandlesStmt.exchange(into(lOpen));
+        mIndexCandlesStmt.exchange(into(lClose));
+        mIndexCandlesStmt.exchange(into(lLow));
+        mIndexCandlesStmt.exchange(into(lHigh));
+
+        Stopwatch lStopwatch;
+
+        mIndexCandlesStmt.define_and_bind();
+        mIndexCandlesStmt.execute();
+
+        const auto lExecuteMs = lStopwatch.Lap();
+
+        uint64_t lRows  = 0;
+        double lFetchMs = 0.0;
+
+        for (; mIndexCandlesStmt.fetch(); lStopwatch.Reset())
+        {
+            lFetchMs += lStopwatch.Elapsed();
+
+            aLoadOp(lCode, lDate, static_cast<float>(lOpen), static_cast<float>(lClose), static_cast<float>(lLow), static_cast<float>(lHigh));
+            ++lRows;
+        }
+
+        lFetchMs += lStopwatch.Elapsed();
+
+        mIndexCandlesStmt.bind_clean_up();
+
+        QueryProfiler::Instance().RecordExecution(mSession, INDEX_CANDLES_SQL, "after=" + aAfter + ", limit=" + std::to_string(aLimit), lExecuteMs, lFetchMs, lRows);
+    }
+
+    // Bars of every code on the last aLimit trading dates, ordered by date then code. aFilter is an SQL condition on the columns of
+    // index_daily_market, a code is only loaded when its bar of the latest date meets it. The statement depends on aFilter and is
+    // prepared on every call.
+    template <typename LoadOp>
+    void LoadBars(const std::string& aFilter, const uint32_t& aLimit, LoadOp aLoadOp)
+    {
+        using soci::into;
+        using soci::use;
+
+        std::string lQuery{INDEX_BARS_SQL};
+
+        if (!aFilter.empty())
+            lQuery += fmt::format(INDEX_BARS_FILTER_SQL, aFilter);
+
+        lQuery += INDEX_BARS_ORDER_SQL;
+
+        std::string lCode;
+        std::string lDate;
+        double lOpen{0.0};
+        double lClose{0.0};
+        double lLow{0.0};
+        double lHigh{0.0};
+        double lVolume{0.0};
+        double lAmount{0.0};
+
+        auto lStatement = QueryProfiler::Prepare(mSession, lQuery);
+
+        lStatement.exchange(use(aLimit, "limit"));
+        lStatement.exchange(into(lCode));
+        lStatement.exchange(into(lDate));
+        lStatement.exchange(into(lOpen));
+        lStatement.exchange(into(lClose));
+        lStatement.exchange(into(lLow));
+        lStatement.exchange(into(lHigh));
+        lStatement.exchange(into(lVolume));
+        lStatement.exchange(into(lAmount));
+
+        // The statement is prepared on every call, only the execution is accounted for like the other loads.
+        Stopwatch lStopwatch;
+
+        lStatement.define_and_bind();
+        lStatement.execute();
+
+        const auto lExecuteMs = lStopwatch.Lap();
+
+        uint64_t lRows  = 0;
+        double lFetchMs = 0.0;
+
+        for (; lStatement.fetch(); lStopwatch.Reset())
+        {
+            lFetchMs += lStopwatch.Elapsed();
+
+            aLoadOp(lCode, lDate, static_cast<float>(lOpen), static_cast<float>(lClose), static_cast<float>(lLow), static_cast<float>(lHigh),
+                    static_cast<float>(lVolume), static_cast<float>(lAmount));
+            ++lRows;
+        }
+
+        lFetchMs += lStopwatch.Elapsed();
+
+        QueryProfiler::Instance().RecordExecution(mSession, lQuery, "limit=" + std::to_string(aLimit), lExecuteMs, lFetchMs, lRows);
+    }
+
+    // Store the correlations of aDate over aDays, aValues is the upper triangle of the matrix of aCodes row by row. NaN are skipped.
+    void StoreCorrelations(const date::sys_days aDate, const uint32_t aDays, const std::vector<std::string>& aCodes, const std::vector<float>& aValues)
+    {
+        using soci::use;
+
+        if (!mCorrelationTable)
+        {
+            mSession << INDEX_CORRELATION_DDL;
+            mCorrelationTable = true;
+        }
+
+        soci::transaction lTransaction{mSession};
+
+        // The SQLite backend only runs the first row of a statement bound to vectors, every pair is a run of the one prepared statement
+        // instead, all in the same transaction.
+        const auto lDate = aDate.time_since_epoch().count();
+        const auto lDays = static_cast<int>(aDays);
+        std::string lFirstCode;
+        std::string lSecondCode;
+        double lValue{0.0};
+
+        soci::statement lStatement = (mSession.prepare << INDEX_CORRELATION_SQL, use(lDate, "date"), use(lDays, "days"), use(lFirstCode, "code_a"),
+                                      use(lSecondCode, "code_b"), use(lValue, "value"));
+
+        auto lCorrelation = aValues.cbegin();
+
+        for (size_t i = 0; i < aCodes.size(); ++i)
+        {
+            for (auto j = i + 1; j < aCodes.size(); ++j, ++lCorrelation)
+            {
+                if (std::isnan(*lCorrelation))
+                    continue;
+
+                lFirstCode  = aCodes[i];
+                lSecondCode = aCodes[j];
+                lValue      = *lCorrelation;
+
+                lStatement.execute(true);
+            }
+        }
+
+        lTransaction.commit();
     }
 };
 
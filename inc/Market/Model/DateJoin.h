@@ -0,0 +1,415 @@
+#ifndef __ABOLLO_MARKET_MODEL_DATE_JOIN_H__
+#define __ABOLLO_MARKET_MODEL_DATE_JOIN_H__
+
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <date/date.h>
+#include <thrust/iterator/permutation_iterator.h>
+
+#include "Market/Model/ColumnTraits.h"
+
+
+
+namespace abollo
+{
+
+
+
+enum class JoinSeries : uint8_t
+{
+    eSpread,     // x - base
+    eRatio,      // x / base
+    eRebased     // 100 * x / x at the oldest common date
+};
+
+
+
+template <typename T>
+class JoinedTable;
+
+
+
+namespace internal
+{
+
+
+
+// Column Tag of a JoinedTable, every value computed from the inputs when it is read.
+template <typename T, typename Tag>
+class JoinIterator final
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = decltype(std::declval<const JoinedTable<T>&>().Value(std::declval<uint32_t>(), column_v<Tag>));
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = value_type;
+
+private:
+    const JoinedTable<T>* mpTable{nullptr};
+    difference_type mRow{0};
+
+public:
+    JoinIterator() = default;
+
+    JoinIterator(const JoinedTable<T>* apTable, const difference_type aRow) : mpTable{apTable}, mRow{aRow}
+    {
+    }
+
+    reference operator*() const
+    {
+        return mpTable->Value(static_cast<uint32_t>(mRow), column_v<Tag>);
+    }
+
+    reference operator[](const difference_type aOffset) const
+    {
+        return *(*this + aOffset);
+    }
+
+    JoinIterator& operator++()
+    {
+        ++mRow;
+        return *this;
+    }
+
+    JoinIterator& operator--()
+    {
+        --mRow;
+        return *this;
+    }
+
+    JoinIterator operator++(int)
+    {
+        return {mpTable, mRow++};
+    }
+
+    JoinIterator operator--(int)
+    {
+        return {mpTable, mRow--};
+    }
+
+    JoinIterator& operator+=(const difference_type aOffset)
+    {
+        mRow += aOffset;
+        return *this;
+    }
+
+    JoinIterator& operator-=(const difference_type aOffset)
+    {
+        mRow -= aOffset;
+        return *this;
+    }
+
+    friend JoinIterator operator+(const JoinIterator& aIterator, const difference_type aOffset)
+    {
+        return {aIterator.mpTable, aIterator.mRow + aOffset};
+    }
+
+    friend JoinIterator operator+(const difference_type aOffset, const JoinIterator& aIterator)
+    {
+        return aIterator + aOffset;
+    }
+
+    friend JoinIterator operator-(const JoinIterator& aIterator, const difference_type aOffset)
+    {
+        return {aIterator.mpTable, aIterator.mRow - aOffset};
+    }
+
+    friend difference_type operator-(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow - aRight.mRow;
+    }
+
+    friend bool operator==(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow == aRight.mRow;
+    }
+
+    friend bool operator!=(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow != aRight.mRow;
+    }
+
+    friend bool operator<(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow < aRight.mRow;
+    }
+
+    friend bool operator>(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow > aRight.mRow;
+    }
+
+    friend bool operator<=(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow <= aRight.mRow;
+    }
+
+    friend bool operator>=(const JoinIterator& aLeft, const JoinIterator& aRight)
+    {
+        return aLeft.mRow >= aRight.mRow;
+    }
+};
+
+
+
+}    // namespace internal
+
+
+
+// Result of a sort-merge join of several per-symbol tables on their date column, newest first like the tables themselves.
+// Nothing is copied: Rows(i) holds the row of input i behind every joined date, View() gathers any column of an input through it, and
+// the spread, ratio and rebased series against input 0 are computed from the aligned rows when read. The market data columns are the
+// charted series, input aChartInput against input 0 component by component, read the same way, so the table can be pushed into a
+// CircularMarketingTable and drawn by MarketCanvas like any index. The inputs must outlive the table.
+template <typename T>
+class JoinedTable final
+{
+private:
+    template <typename, typename>
+    friend class internal::JoinIterator;
+
+    std::vector<const T*> mTables;
+    std::vector<std::vector<uint32_t>> mRows;
+    std::vector<float> mFirstCloses;    // Close of every input at the oldest common date, the base of the rebased series.
+    JoinSeries mSeries{JoinSeries::eRebased};
+    size_t mChartInput{1};
+
+    template <typename Tag>
+    [[nodiscard]] auto Input(const size_t aInput, const uint32_t aRow) const
+    {
+        return *(mTables[aInput]->template begin<Tag>() + mRows[aInput][aRow]);
+    }
+
+    [[nodiscard]] static float Derive(const JoinSeries aSeries, const float aValue, const float aBase, const float aFirst)
+    {
+        switch (aSeries)
+        {
+        case JoinSeries::eSpread:
+            return aValue - aBase;
+
+        case JoinSeries::eRatio:
+            return aValue / aBase;
+
+        case JoinSeries::eRebased:
+        default:
+            return 100.f * aValue / aFirst;
+        }
+    }
+
+    // Component Tag of the charted candle at aRow, before the extremes are taken.
+    template <typename Tag>
+    [[nodiscard]] float Chart(const uint32_t aRow) const
+    {
+        return Derive(mSeries, Input<Tag>(mChartInput, aRow), Input<Tag>(0, aRow), mFirstCloses[mChartInput]);
+    }
+
+    [[nodiscard]] auto Value(const uint32_t aRow, ColumnTraits<date_tag>) const
+    {
+        return Input<date_tag>(0, aRow);
+    }
+
+    // Sequence numbers count from the oldest common date.
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<seq_tag>) const
+    {
+        return static_cast<float>(size() - 1 - aRow);
+    }
+
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<open_tag>) const
+    {
+        return Chart<open_tag>(aRow);
+    }
+
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<close_tag>) const
+    {
+        return Chart<close_tag>(aRow);
+    }
+
+    // Component-wise ratios or spreads of two candles are not ordered, the extremes keep the candle well formed.
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<low_tag>) const
+    {
+        return std::min({Chart<open_tag>(aRow), Chart<close_tag>(aRow), Chart<low_tag>(aRow), Chart<high_tag>(aRow)});
+    }
+
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<high_tag>) const
+    {
+        return std::max({Chart<open_tag>(aRow), Chart<close_tag>(aRow), Chart<low_tag>(aRow), Chart<high_tag>(aRow)});
+    }
+
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<volume_tag>) const
+    {
+        return Input<volume_tag>(mChartInput, aRow);
+    }
+
+    [[nodiscard]] float Value(const uint32_t aRow, ColumnTraits<amount_tag>) const
+    {
+        return Input<amount_tag>(mChartInput, aRow);
+    }
+
+    [[nodiscard]] float Derived(const size_t aInput, const uint32_t aRow, const JoinSeries aSeries) const
+    {
+        return Derive(aSeries, Input<close_tag>(aInput, aRow), Input<close_tag>(0, aRow), mFirstCloses[aInput]);
+    }
+
+    [[nodiscard]] float Derived(const size_t aInput, const uint32_t aRow, ColumnTraits<spread_tag>) const
+    {
+        return Derived(aInput, aRow, JoinSeries::eSpread);
+    }
+
+    [[nodiscard]] float Derived(const size_t aInput, const uint32_t aRow, ColumnTraits<ratio_tag>) const
+    {
+        return Derived(aInput, aRow, JoinSeries::eRatio);
+    }
+
+    [[nodiscard]] float Derived(const size_t aInput, const uint32_t aRow, ColumnTraits<rebased_tag>) const
+    {
+        return Derived(aInput, aRow, JoinSeries::eRebased);
+    }
+
+public:
+    // The tables must be ordered by date descending, as pages come out of DataLoader. O(total rows), whatever the number of inputs.
+    [[nodiscard]] static JoinedTable Join(const std::vector<const T*>& aTables, const JoinSeries aSeries, const size_t aChartInput = 1)
+    {
+        assert(!aTables.empty() && aChartInput < aTables.size());
+
+        const auto lInputs = aTables.size();
+        auto lCapacity     = static_cast<size_t>(aTables.front()->size());
+
+        for (const auto* lpTable : aTables)
+            lCapacity = std::min(lCapacity, static_cast<size_t>(lpTable->size()));
+
+        JoinedTable lJoined;
+        lJoined.mTables     = aTables;
+        lJoined.mSeries     = aSeries;
+        lJoined.mChartInput = aChartInput;
+        lJoined.mRows.assign(lInputs, std::vector<uint32_t>(lCapacity));
+
+        // Merge from the oldest rows up, joined rows are written from the back, newest first.
+        std::vector<size_t> lCursors(lInputs);
+
+        for (size_t i = 0; i < lInputs; ++i)
+            lCursors[i] = aTables[i]->size();
+
+        const auto lDate = [&aTables, &lCursors](const size_t aInput) { return *(aTables[aInput]->template begin<date_tag>() + (lCursors[aInput] - 1)); };
+
+        auto lWrite = lCapacity;
+
+        for (auto lDone = lCapacity == 0; !lDone;)
+        {
+            auto lTarget = lDate(0);
+
+            for (size_t i = 1; i < lInputs; ++i)
+                lTarget = std::max(lTarget, lDate(i));
+
+            auto lAligned = true;
+
+            for (size_t i = 0; i < lInputs && !lDone; ++i)
+            {
+                while (lCursors[i] > 0 && lDate(i) < lTarget)
+                    --lCursors[i];
+
+                if (lCursors[i] == 0)
+                    lDone = true;
+                else if (lDate(i) != lTarget)
+                    lAligned = false;
+            }
+
+            if (lDone || !lAligned)
+                continue;
+
+            --lWrite;
+
+            for (size_t i = 0; i < lInputs; ++i)
+                lJoined.mRows[i][lWrite] = static_cast<uint32_t>(lCursors[i] - 1);
+
+            for (auto& lCursor : lCursors)
+                lDone |= --lCursor == 0;
+        }
+
+        for (auto& lRows : lJoined.mRows)
+            lRows.erase(lRows.begin(), lRows.begin() + lWrite);
+
+        if (lJoined.size() > 0)
+        {
+            lJoined.mFirstCloses.resize(lInputs);
+
+            for (size_t i = 0; i < lInputs; ++i)
+                lJoined.mFirstCloses[i] = lJoined.Input<close_tag>(i, lJoined.size() - 1);
+        }
+
+        return lJoined;
+    }
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return mRows.empty() ? 0 : static_cast<uint32_t>(mRows.front().size());
+    }
+
+    [[nodiscard]] size_t Inputs() const
+    {
+        return mRows.size();
+    }
+
+    // Row of input aInput behind every joined date.
+    [[nodiscard]] const auto& Rows(const size_t aInput) const
+    {
+        return mRows[aInput];
+    }
+
+    // Column Tag of input aInput aligned on the joined dates, gathered on the fly instead of copied.
+    template <typename Tag>
+    [[nodiscard]] auto View(const size_t aInput) const
+    {
+        return std::make_pair(thrust::make_permutation_iterator(mTables[aInput]->template begin<Tag>(), mRows[aInput].cbegin()),
+                              thrust::make_permutation_iterator(mTables[aInput]->template begin<Tag>(), mRows[aInput].cend()));
+    }
+
+    // Spread, ratio or rebased close of input aInput at the joined row aRow.
+    template <typename Tag>
+    [[nodiscard]] float Derived(const size_t aInput, const uint32_t aRow) const
+    {
+        assert(aInput < Inputs() && aRow < size());
+
+        return Derived(aInput, aRow, column_v<Tag>);
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto begin() const
+    {
+        return internal::JoinIterator<T, Tag>{this, 0};
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto end() const
+    {
+        return internal::JoinIterator<T, Tag>{this, static_cast<std::ptrdiff_t>(size())};
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto front() const
+    {
+        return *begin<Tag>();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto back() const
+    {
+        return *(begin<Tag>() + (size() - 1));
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_DATE_JOIN_H__
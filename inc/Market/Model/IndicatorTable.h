@@ -0,0 +1,174 @@
+#ifndef __ABOLLO_MARKET_MODEL_INDICATOR_TABLE_H__
+#define __ABOLLO_MARKET_MODEL_INDICATOR_TABLE_H__
+
+
+
+#include <cassert>
+#include <cstdint>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Market/Model/PriceColumns.h"
+
+
+
+namespace abollo
+{
+
+
+
+struct IndicatorParameters
+{
+    uint32_t smaPeriod{20};
+    uint32_t emaPeriod{20};
+    uint32_t bollingerPeriod{20};
+    float bollingerWidth{2.f};
+    uint32_t rsiPeriod{14};
+    uint32_t macdFastPeriod{12};
+    uint32_t macdSlowPeriod{26};
+    uint32_t macdSignalPeriod{9};
+    uint32_t atrPeriod{14};
+};
+
+
+
+namespace internal
+{
+
+
+
+// State of the recursive indicators that cannot be recovered from their output.
+struct rsi_gain_tag;
+struct rsi_loss_tag;
+struct macd_fast_tag;
+struct macd_slow_tag;
+
+
+
+}    // namespace internal
+
+
+
+// SMA, EMA, Bollinger bands, RSI, MACD, ATR and OBV of one code, kept in step with the pages pushed into the market table. The
+// prices are read from the PriceColumns of DataAnalyzer, which take every page first. push_back adds older rows and push_front newer
+// ones, as with CircularMarketingTable, both in O(page). Only the rows a page affects are recomputed:
+// - windowed indicators (SMA, Bollinger) recompute the new rows plus the period - 1 rows whose window now reaches into them;
+// - recursive indicators (EMA, RSI, MACD, ATR) continue from the state of the previous row when newer rows arrive. Older rows move
+//   their seed, they are recomputed until the effect of the old seed has decayed below float precision;
+// - OBV is anchored at the first row ever loaded and extended in either direction.
+// Indices follow DataAnalyzer, 0 is the newest row.
+class IndicatorTable final
+{
+public:
+    using Schema = TableSchema<sma_tag, ema_tag, bollinger_upper_tag, bollinger_lower_tag, rsi_tag, macd_tag, macd_signal_tag, macd_histogram_tag, atr_tag, obv_tag>;
+
+private:
+    using ColumnsSchema = TableSchema<sma_tag, ema_tag, bollinger_upper_tag, bollinger_lower_tag, rsi_tag, macd_tag, macd_signal_tag, macd_histogram_tag, atr_tag, obv_tag,
+                                      internal::rsi_gain_tag, internal::rsi_loss_tag, internal::macd_fast_tag, internal::macd_slow_tag>;
+    using ColumnsType   = internal::HostColumns<ColumnsSchema>;
+
+    const PriceColumns* mpPrices;
+    IndicatorParameters mParameters;
+    ColumnsType mColumns;
+
+    template <typename Tag>
+    [[nodiscard]] const auto& Prices() const
+    {
+        return mpPrices->Get<Tag>();
+    }
+
+    // Recompute rows [aFrom, aTo) of every indicator, aFrom == 0 reseeds the recursive ones.
+    void ComputeMovingAverage(const size_t aFrom, const size_t aTo);
+    void ComputeBollinger(const size_t aFrom, const size_t aTo);
+    void ComputeExponentialAverage(const size_t aFrom, const size_t aTo);
+    void ComputeRsi(const size_t aFrom, const size_t aTo);
+    void ComputeMacd(const size_t aFrom, const size_t aTo);
+    void ComputeAtr(const size_t aFrom, const size_t aTo);
+    void ComputeObv(const size_t aFrom, const size_t aTo);
+    void ComputeObvBackward(const size_t aCount);    // The aCount oldest rows, from the OBV of the row after them.
+
+    void ExtendNewer(const size_t aFrom);
+    void ExtendOlder(const size_t aCount);
+
+public:
+    explicit IndicatorTable(const PriceColumns& aPrices, const IndicatorParameters& aParameters = {}) : mpPrices{&aPrices}, mParameters{aParameters}
+    {
+    }
+
+    // The aCount rows added to the prices, older than the rows computed.
+    void push_back(const size_t aCount)
+    {
+        mColumns.AddOlder(aCount, ColumnsSchema{});
+
+        assert(size() == mpPrices->size());
+
+        ExtendOlder(aCount);
+    }
+
+    // The aCount rows added to the prices, newer than the rows computed.
+    void push_front(const size_t aCount)
+    {
+        const auto lFrom = size();
+
+        mColumns.AddNewer(aCount, ColumnsSchema{});
+
+        assert(size() == mpPrices->size());
+
+        ExtendNewer(lFrom);
+    }
+
+    // Drop the aCount oldest rows, as the ring does once full. The rows left keep their values, the recursive indicators carry on
+    // from the newest one.
+    void pop_back(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        mColumns.DropOlder(aCount, ColumnsSchema{});
+    }
+
+    // Drop the aCount newest rows.
+    void pop_front(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        mColumns.DropNewer(aCount, ColumnsSchema{});
+    }
+
+    // Change the periods and recompute every row.
+    void Reset(const IndicatorParameters& aParameters);
+
+    [[nodiscard]] const auto& GetParameters() const
+    {
+        return mParameters;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return mColumns.Get<sma_tag>().size();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto begin() const
+    {
+        return mColumns.Get<Tag>().crbegin();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto end() const
+    {
+        return mColumns.Get<Tag>().crend();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] float at(const uint32_t aIndex) const
+    {
+        return *(begin<Tag>() + aIndex);
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_INDICATOR_TABLE_H__
@@ -0,0 +1,28 @@
+#ifndef __ABOLLO_MARKET_MODEL_ISO_DATE_H__
+#define __ABOLLO_MARKET_MODEL_ISO_DATE_H__
+
+
+
+#include <cstddef>
+
+#include <date/date.h>
+
+
+
+namespace abollo
+{
+
+
+
+// Days since the epoch of an ISO-8601 date, YYYY-MM-DD, in the aLength characters at aText. Anything after the day, like a time, is
+// ignored. No std::tm and no locale, only fixed-position digits and the civil-to-days arithmetic of sys_days. Returns false and leaves
+// aDate alone for an invalid date.
+[[nodiscard]] bool ParseIsoDate(const char* aText, const size_t aLength, date::sys_days& aDate);
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_ISO_DATE_H__
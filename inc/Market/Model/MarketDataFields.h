@@ -71,7 +71,7 @@ struct MarketDataFields
 };
 
 
-using DateIterator         = thrust::host_vector<date::year_month_day>::const_iterator;
+using DateIterator         = thrust::host_vector<date::sys_days>::const_iterator;
 using PriceIterator        = thrust::host_vector<MarketDataFields>::const_iterator;
 using DatePriceIterator    = thrust::tuple<DateIterator, PriceIterator>;
 using DatePriceZipIterator = thrust::zip_iterator<DatePriceIterator>;
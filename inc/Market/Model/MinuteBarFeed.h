@@ -0,0 +1,55 @@
+#ifndef __ABOLLO_MARKET_MODEL_MINUTE_BAR_FEED_H__
+#define __ABOLLO_MARKET_MODEL_MINUTE_BAR_FEED_H__
+
+
+
+#include <cstdint>
+#include <deque>
+
+#include "Market/Model/BarAggregator.h"
+#include "Utility/NonCopyable.h"
+#include "Utility/SpscQueue.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Hands the bars of every interval from a feed thread to the UI thread. The feed thread is the only producer and the UI thread the only
+// consumer of the queue: posting a bar never waits for a frame, and draining the bars between two frames never waits for the feed.
+class MinuteBarFeed final : private internal::NonCopyable
+{
+private:
+    constexpr static size_t BAR_QUEUE_CAPACITY = 4096;
+
+    struct IntervalBar
+    {
+        BarInterval interval;
+        MinuteBar bar;
+    };
+
+    SpscQueue<IntervalBar, BAR_QUEUE_CAPACITY> mBars;
+    std::deque<IntervalBar> mOverflow;    // Owned by the producer, holds bars while the queue is full instead of blocking the feed.
+
+public:
+    // Producer side, must only be called from the feed thread. A revision of the forming bar is posted like a new bar.
+    void Post(const BarInterval aInterval, const MinuteBar& aBar);
+
+    // Move the bars held back while the queue was full into the queue. Returns true once nothing is held back.
+    bool Flush();
+
+    // Consumer side, must only be called from the UI thread, once per frame before painting. Applies the bars queued so far to the
+    // table of their interval in aTables, at most a queue of them so that a burst is spread over frames. Returns the number of bars
+    // applied.
+    uint32_t Drain(BarTables& aTables);
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_MINUTE_BAR_FEED_H__
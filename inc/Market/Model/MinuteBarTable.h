@@ -0,0 +1,121 @@
+#ifndef __ABOLLO_MARKET_MODEL_MINUTE_BAR_TABLE_H__
+#define __ABOLLO_MARKET_MODEL_MINUTE_BAR_TABLE_H__
+
+
+
+#include <cassert>
+#include <cstdint>
+
+#include <thrust/host_vector.h>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Market/Model/PagedMarketingTable.h"
+#include "Market/Model/Table.h"
+
+
+
+namespace abollo
+{
+
+
+
+using MinuteBarSchema = TableSchema<time_tag, open_tag, close_tag, low_tag, high_tag, volume_tag, amount_tag>;
+using MinuteBar       = Row<MinuteBarSchema>;
+
+
+
+// Intraday bars in time order, the oldest first. A trading day is about BARS_PER_DAY bars, so a block of every column holds a few
+// weeks and months of them take a handful of blocks; like any ChunkedArray the table grows without moving the bars it holds.
+// The last bar is still forming while its minute lasts: a bar for the same minute revises it instead of adding a row.
+class MinuteBarTable final : private HostColumn<MinuteTime, 1 << 12, time_tag>,
+                             public Table<thrust::host_vector<float>, 1 << 12, open_tag, close_tag, low_tag, high_tag, volume_tag, amount_tag>
+{
+public:
+    using Schema = MinuteBarSchema;
+
+    constexpr static uint32_t BARS_PER_DAY = 240;
+    constexpr static uint32_t BLOCK_SIZE   = 1 << 12;
+
+private:
+    using TimeColumn = HostColumn<MinuteTime, BLOCK_SIZE, time_tag>;
+
+    template <typename Tag>
+    using ColumnType = std::conditional_t<std::is_same_v<time_tag, Tag>, TimeColumn, HostColumn<float, BLOCK_SIZE, Tag>>;
+
+    uint32_t mSize{0};
+
+    template <typename... Ts>
+    void push_back(const MinuteBar& aBar, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (ColumnType<Ts>::push_back(aBar.template Get<Ts>()), 0)...};
+    }
+
+    template <typename... Ts>
+    void revise(const MinuteBar& aBar, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (*(ColumnType<Ts>::end() - 1) = aBar.template Get<Ts>(), 0)...};
+    }
+
+public:
+    // Add aBar after the last bar, or revise the last bar if it is for the same minute. Bars older than the last one are late and
+    // left out, returns false for them.
+    bool Update(const MinuteBar& aBar)
+    {
+        const auto lTime = aBar.Get<time_tag>();
+
+        if (mSize > 0 && lTime < TimeColumn::back())
+            return false;
+
+        if (mSize > 0 && lTime == TimeColumn::back())
+        {
+            revise(aBar, Schema{});
+            return true;
+        }
+
+        push_back(aBar, Schema{});
+        ++mSize;
+
+        return true;
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto begin() const
+    {
+        return ColumnType<Tag>::begin();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto end() const
+    {
+        return ColumnType<Tag>::end();
+    }
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return mSize;
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto at(const uint32_t aIndex) const
+    {
+        assert(aIndex < mSize);
+
+        return begin<Tag>()[aIndex];
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto back() const
+    {
+        return at<Tag>(mSize - 1);
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_MINUTE_BAR_TABLE_H__
@@ -0,0 +1,114 @@
+#ifndef __ABOLLO_MARKET_MODEL_PAGE_POOL_H__
+#define __ABOLLO_MARKET_MODEL_PAGE_POOL_H__
+
+
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Market/Model/ChunkedArray.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Staging pages lent to loaders and prefetchers. A returned page is reset, not cleared: its columns keep their blocks, so the next
+// load into it neither allocates blocks nor grows the directories of its columns, and repeated paging settles at zero allocations.
+// Pages are borrowed and returned from any thread.
+template <typename T>
+class PagePool final
+{
+public:
+    // A borrowed page, returned to its pool when the lease ends.
+    class Lease final
+    {
+    private:
+        friend class PagePool;
+
+        PagePool* mpPool{nullptr};
+        std::unique_ptr<T> mpPage;
+
+        Lease(PagePool* aPool, std::unique_ptr<T> aPage) : mpPool{aPool}, mpPage{std::move(aPage)}
+        {
+        }
+
+    public:
+        Lease(Lease&&) noexcept = default;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease()
+        {
+            if (mpPage)
+                mpPool->Return(std::move(mpPage));
+        }
+
+        [[nodiscard]] T& operator*() const
+        {
+            return *mpPage;
+        }
+
+        [[nodiscard]] T* operator->() const
+        {
+            return mpPage.get();
+        }
+    };
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<std::unique_ptr<T>> mFree;
+    PoolStatistics mStatistics;
+
+    void Return(std::unique_ptr<T> aPage)
+    {
+        aPage->reset();
+
+        const std::lock_guard<std::mutex> lLock{mMutex};
+
+        --mStatistics.outstanding;
+        mFree.push_back(std::move(aPage));
+    }
+
+public:
+    [[nodiscard]] Lease Borrow()
+    {
+        {
+            const std::lock_guard<std::mutex> lLock{mMutex};
+
+            mStatistics.highWater = std::max(mStatistics.highWater, ++mStatistics.outstanding);
+
+            if (!mFree.empty())
+            {
+                auto lPage = std::move(mFree.back());
+                mFree.pop_back();
+
+                ++mStatistics.hits;
+                return {this, std::move(lPage)};
+            }
+
+            ++mStatistics.misses;
+        }
+
+        return {this, std::make_unique<T>()};
+    }
+
+    [[nodiscard]] PoolStatistics Statistics() const
+    {
+        const std::lock_guard<std::mutex> lLock{mMutex};
+
+        return mStatistics;
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_PAGE_POOL_H__
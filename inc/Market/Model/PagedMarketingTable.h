@@ -25,43 +25,66 @@ class PagedMarketingTable;
 
 
 
+// Rows in the order they are pushed, every column a ChunkedArray of 1 << P values per block, so a table grows to any number of rows
+// without moving the ones already loaded.
 template <typename T, const uint8_t P, typename... Tags>
-class PagedMarketingTable<T, P, TableSchema<Tags...>> : private HostColumn<date::year_month_day, 1 << P, date_tag>,
+class PagedMarketingTable<T, P, TableSchema<Tags...>> : private HostColumn<date::sys_days, 1 << P, date_tag>,
                                                         public Table<thrust::host_vector<T>, 1 << P, remove_t<date_tag, Tags...>>
 {
 public:
     using Schema = TableSchema<Tags...>;
 
 private:
-    using DateColumn = HostColumn<date::year_month_day, 1 << P, date_tag>;
+    using DateColumn = HostColumn<date::sys_days, 1 << P, date_tag>;
     using BaseTable  = Table<thrust::host_vector<T>, 1 << P, remove_t<date_tag, Tags...>>;
 
-    constexpr static uint32_t CAPACITY = 1 << P;
+    constexpr static uint32_t BLOCK_SIZE = 1 << P;
 
     uint32_t mSize{0};
 
     template <typename Tag, typename U>
     auto push_back(U&& aValue)
     {
-        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, CAPACITY, Tag>>;
+        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, BLOCK_SIZE, Tag>>;
 
         BaseType& lBaseColumn = *this;
-        lBaseColumn[mSize]    = aValue.template Get<Tag>();
+        lBaseColumn.push_back(aValue.template Get<Tag>());
 
         return mSize;
     }
 
+    template <typename... Ts>
+    void clear(TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (std::conditional_t<std::is_same_v<date_tag, Ts>, DateColumn, HostColumn<T, BLOCK_SIZE, Ts>>::clear(), 0)...};
+    }
+
+    template <typename... Ts>
+    void reset(TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (std::conditional_t<std::is_same_v<date_tag, Ts>, DateColumn, HostColumn<T, BLOCK_SIZE, Ts>>::reset(), 0)...};
+    }
+
     template <typename U, typename... Ts>
     void push_back(U&& aValue, TableSchema<Ts...>)
     {
-        assert(mSize + 1 <= CAPACITY);
-
         // (push_back<Ts>(std::forward<U>(aValue)), ...);
 
         using expander = uint32_t[];
         (void)expander{(push_back<Ts>(std::forward<U>(aValue)))...};
     }
 
+    template <typename U, typename... Ts>
+    void append(const U& aTable, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (std::conditional_t<std::is_same_v<date_tag, Ts>, DateColumn, HostColumn<T, BLOCK_SIZE, Ts>>::append(aTable.template begin<Ts>(),
+                                                                                                                              aTable.template begin<Ts>() + aTable.size()),
+                           0)...};
+    }
+
 public:
     template <typename U>
     void push_back(U&& aValue)
@@ -71,23 +94,32 @@ public:
         ++mSize;
     }
 
+    // Append every row of aTable, any table with begin<Tag>() and size() over the same columns, a column at a time.
+    template <typename U>
+    void append(const U& aTable)
+    {
+        append(aTable, table_schema_v<Tags...>);
+
+        mSize += aTable.size();
+    }
+
     template <typename Tag>
     [[nodiscard]] auto begin() const
     {
-        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, CAPACITY, Tag>>;
+        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, BLOCK_SIZE, Tag>>;
 
         return BaseType::begin();
     }
 
     [[nodiscard]] auto begin() const
     {
-        return thrust::make_zip_iterator(thrust::make_tuple(std::conditional_t<std::is_same_v<date_tag, Tags>, DateColumn, HostColumn<T, CAPACITY, Tags>>::begin()...));
+        return thrust::make_zip_iterator(thrust::make_tuple(std::conditional_t<std::is_same_v<date_tag, Tags>, DateColumn, HostColumn<T, BLOCK_SIZE, Tags>>::begin()...));
     }
 
     template <typename Tag>
     [[nodiscard]] auto end() const
     {
-        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, CAPACITY, Tag>>;
+        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, BLOCK_SIZE, Tag>>;
 
         return BaseType::end();
     }
@@ -95,7 +127,7 @@ public:
     [[nodiscard]] auto end() const
     {
         // return begin() + size();
-        return thrust::make_zip_iterator(thrust::make_tuple(std::conditional_t<std::is_same_v<date_tag, Tags>, DateColumn, HostColumn<T, CAPACITY, Tags>>::end()...));
+        return thrust::make_zip_iterator(thrust::make_tuple(std::conditional_t<std::is_same_v<date_tag, Tags>, DateColumn, HostColumn<T, BLOCK_SIZE, Tags>>::end()...));
     }
 
     [[nodiscard]] auto size() const
@@ -105,13 +137,23 @@ public:
 
     void clear()
     {
+        clear(table_schema_v<Tags...>);
+
+        mSize = 0;
+    }
+
+    // Drop the rows but keep the blocks of the columns, for a page that is about to be refilled.
+    void reset()
+    {
+        reset(table_schema_v<Tags...>);
+
         mSize = 0;
     }
 
     template <typename Tag>
     [[nodiscard]] auto front() const
     {
-        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, CAPACITY, Tag>>;
+        using BaseType = std::conditional_t<std::is_same_v<date_tag, Tag>, DateColumn, HostColumn<T, BLOCK_SIZE, Tag>>;
 
         return BaseType::front();
     }
@@ -0,0 +1,80 @@
+#ifndef __ABOLLO_MARKET_MODEL_PATTERN_SCANNER_H__
+#define __ABOLLO_MARKET_MODEL_PATTERN_SCANNER_H__
+
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Market/Model/CandlePatterns.h"
+
+
+
+namespace abollo
+{
+
+
+
+class DataLoader;
+class WorkStealingPool;
+
+
+
+struct PatternMatch
+{
+    std::string code;
+    std::string date;
+    CandlePattern pattern;
+};
+
+
+
+// Candlestick patterns of every code on the last trading dates. Candles are aligned on the union of the trading dates of all codes,
+// a code without a candle on a date holds padding there, so a suspended code matches nothing until it has traded HISTORY + 1 days again.
+// Every code keeps its own bitsets and codes are scanned in parallel, the screen of the latest day only needs HISTORY + 1 dates.
+class PatternScanner final
+{
+private:
+    constexpr static size_t SCAN_GRAIN = 64;
+
+    std::vector<std::string> mDates;    // Oldest first.
+    std::vector<std::string> mCodes;    // Sorted.
+    std::vector<CandlePatterns> mPatterns;
+
+public:
+    [[nodiscard]] static PatternScanner Load(DataLoader& aDataLoader, const uint32_t aDays = CandlePatterns::HISTORY + 1);
+
+    void Scan(WorkStealingPool& aPool);
+
+    [[nodiscard]] const auto& Dates() const
+    {
+        return mDates;
+    }
+
+    [[nodiscard]] const auto& Codes() const
+    {
+        return mCodes;
+    }
+
+    [[nodiscard]] const CandlePatterns& Patterns(const size_t aCode) const
+    {
+        return mPatterns[aCode];
+    }
+
+    // Patterns completed on mDates[aDate], ordered by code then pattern.
+    [[nodiscard]] std::vector<PatternMatch> Matches(const uint32_t aDate) const;
+
+    [[nodiscard]] std::vector<PatternMatch> LatestMatches() const
+    {
+        return mDates.empty() ? std::vector<PatternMatch>{} : Matches(static_cast<uint32_t>(mDates.size() - 1));
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_PATTERN_SCANNER_H__
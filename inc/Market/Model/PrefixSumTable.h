@@ -0,0 +1,152 @@
+#ifndef __ABOLLO_MARKET_MODEL_PREFIX_SUM_TABLE_H__
+#define __ABOLLO_MARKET_MODEL_PREFIX_SUM_TABLE_H__
+
+
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Utility/DoubleEndedVector.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace internal
+{
+
+
+
+template <typename Tag>
+struct PrefixSumColumn
+{
+    DoubleEndedVector<double> sums{1, 0.0};    // Exclusive, oldest first: sums[i + 1] - sums[i] is row i.
+};
+
+
+
+}    // namespace internal
+
+
+
+// Running totals of volume, amount and close * volume in double precision, so that the sum over any range of rows is two lookups.
+// push_back adds older rows and push_front newer ones, as with CircularMarketingTable. The totals are anchored at the first row ever
+// loaded, older rows extend them downwards, so a page only costs a scan over its own rows, at either end. Indices follow DataAnalyzer,
+// 0 is the newest row.
+class PrefixSumTable final : private internal::PrefixSumColumn<volume_tag>,
+                             private internal::PrefixSumColumn<amount_tag>,
+                             private internal::PrefixSumColumn<close_volume_tag>
+{
+private:
+    template <typename Tag>
+    [[nodiscard]] auto& Sums()
+    {
+        return internal::PrefixSumColumn<Tag>::sums;
+    }
+
+    template <typename Tag>
+    [[nodiscard]] const auto& Sums() const
+    {
+        return internal::PrefixSumColumn<Tag>::sums;
+    }
+
+    // aValues are the new rows, oldest first. Both extend the sums with a parallel scan over the new rows only.
+    static void ExtendNewer(DoubleEndedVector<double>& aSums, const std::vector<double>& aValues);
+    static void ExtendOlder(DoubleEndedVector<double>& aSums, const std::vector<double>& aValues);
+
+    // Drop the aCount newest or oldest rows, the sums of the rows left keep their differences.
+    static void DropNewer(DoubleEndedVector<double>& aSums, const size_t aCount);
+    static void DropOlder(DoubleEndedVector<double>& aSums, const size_t aCount);
+
+    template <typename Tag, typename U>
+    static double Value(const U& aPage, const uint32_t aRow, ColumnTraits<Tag>)
+    {
+        return *(aPage.template begin<Tag>() + aRow);
+    }
+
+    template <typename U>
+    static double Value(const U& aPage, const uint32_t aRow, ColumnTraits<close_volume_tag>)
+    {
+        return static_cast<double>(*(aPage.template begin<close_tag>() + aRow)) * *(aPage.template begin<volume_tag>() + aRow);
+    }
+
+    template <typename Tag, typename U>
+    static auto Values(const U& aPage)
+    {
+        std::vector<double> lValues(aPage.size());
+
+        // Pages are ordered by date descending.
+        for (uint32_t i = 0, lRow = aPage.size(); lRow-- > 0; ++i)
+            lValues[i] = Value(aPage, lRow, column_v<Tag>);
+
+        return lValues;
+    }
+
+public:
+    template <typename U>
+    void push_back(const U& aPage)
+    {
+        ExtendOlder(Sums<volume_tag>(), Values<volume_tag>(aPage));
+        ExtendOlder(Sums<amount_tag>(), Values<amount_tag>(aPage));
+        ExtendOlder(Sums<close_volume_tag>(), Values<close_volume_tag>(aPage));
+    }
+
+    template <typename U>
+    void push_front(const U& aPage)
+    {
+        ExtendNewer(Sums<volume_tag>(), Values<volume_tag>(aPage));
+        ExtendNewer(Sums<amount_tag>(), Values<amount_tag>(aPage));
+        ExtendNewer(Sums<close_volume_tag>(), Values<close_volume_tag>(aPage));
+    }
+
+    // Drop the aCount oldest rows, as the ring does once full.
+    void pop_back(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        DropOlder(Sums<volume_tag>(), aCount);
+        DropOlder(Sums<amount_tag>(), aCount);
+        DropOlder(Sums<close_volume_tag>(), aCount);
+    }
+
+    // Drop the aCount newest rows.
+    void pop_front(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        DropNewer(Sums<volume_tag>(), aCount);
+        DropNewer(Sums<amount_tag>(), aCount);
+        DropNewer(Sums<close_volume_tag>(), aCount);
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return Sums<volume_tag>().size() - 1;
+    }
+
+    // Total of the rows [aFirst, aLast), O(1).
+    template <typename Tag>
+    [[nodiscard]] double Sum(const uint32_t aFirst, const uint32_t aLast) const
+    {
+        assert(aFirst <= aLast && aLast <= size());
+
+        const auto& lSums = Sums<Tag>();
+        const auto lSize  = size();
+
+        return lSums[lSize - aFirst] - lSums[lSize - aLast];
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_PREFIX_SUM_TABLE_H__
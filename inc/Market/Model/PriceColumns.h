@@ -0,0 +1,177 @@
+#ifndef __ABOLLO_MARKET_MODEL_PRICE_COLUMNS_H__
+#define __ABOLLO_MARKET_MODEL_PRICE_COLUMNS_H__
+
+
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Utility/AlignedAllocator.h"
+#include "Utility/DoubleEndedVector.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace internal
+{
+
+
+
+template <typename Tag>
+struct HostColumn
+{
+    DoubleEndedVector<float, AlignedAllocator<float>> values;    // Oldest first, so that every recurrence runs forward in memory.
+};
+
+
+template <typename... Tags>
+class HostColumns;
+
+
+// Float columns of the tables computed on the host. Rows are added and dropped at either end without moving the others.
+template <typename... Tags>
+class HostColumns<TableSchema<Tags...>> : private HostColumn<Tags>...
+{
+public:
+    template <typename Tag>
+    [[nodiscard]] auto& Get()
+    {
+        return HostColumn<Tag>::values;
+    }
+
+    template <typename Tag>
+    [[nodiscard]] const auto& Get() const
+    {
+        return HostColumn<Tag>::values;
+    }
+
+    // Open aCount rows before the oldest or after the newest row of the given columns, NaN until they are computed.
+    template <typename... Ts>
+    void AddOlder(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (HostColumn<Ts>::values.prepend_n(aCount, std::numeric_limits<float>::quiet_NaN()), 0)...};
+    }
+
+    template <typename... Ts>
+    void AddNewer(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (HostColumn<Ts>::values.append_n(aCount, std::numeric_limits<float>::quiet_NaN()), 0)...};
+    }
+
+    // Drop the aCount oldest or newest rows of the given columns.
+    template <typename... Ts>
+    void DropOlder(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (HostColumn<Ts>::values.drop_front(aCount), 0)...};
+    }
+
+    template <typename... Ts>
+    void DropNewer(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (HostColumn<Ts>::values.drop_back(aCount), 0)...};
+    }
+};
+
+
+
+}    // namespace internal
+
+
+
+// Open, close, low, high and volume of the rows of the ring, on the host. The columns of the ring live on the device while the tables
+// derived from them are computed on the host, they all read this single copy, which DataAnalyzer keeps in step with the ring, instead
+// of each keeping its own. push_back adds older rows and push_front newer ones, as with CircularMarketingTable, in O(page).
+// Columns are stored oldest first, index 0 is the oldest row, unlike DataAnalyzer where it is the newest.
+class PriceColumns final
+{
+public:
+    using Schema = TableSchema<open_tag, close_tag, low_tag, high_tag, volume_tag>;
+
+private:
+    internal::HostColumns<Schema> mColumns;
+
+    template <typename Tag, typename U>
+    void Prepend(const U& aPage)
+    {
+        // Pages are ordered by date descending.
+        const auto lBegin = aPage.template begin<Tag>();
+
+        mColumns.Get<Tag>().prepend(std::make_reverse_iterator(lBegin + aPage.size()), std::make_reverse_iterator(lBegin));
+    }
+
+    template <typename Tag, typename U>
+    void Append(const U& aPage)
+    {
+        const auto lBegin = aPage.template begin<Tag>();
+
+        mColumns.Get<Tag>().append(std::make_reverse_iterator(lBegin + aPage.size()), std::make_reverse_iterator(lBegin));
+    }
+
+public:
+    template <typename U>
+    void push_back(const U& aPage)
+    {
+        Prepend<open_tag>(aPage);
+        Prepend<close_tag>(aPage);
+        Prepend<low_tag>(aPage);
+        Prepend<high_tag>(aPage);
+        Prepend<volume_tag>(aPage);
+    }
+
+    template <typename U>
+    void push_front(const U& aPage)
+    {
+        Append<open_tag>(aPage);
+        Append<close_tag>(aPage);
+        Append<low_tag>(aPage);
+        Append<high_tag>(aPage);
+        Append<volume_tag>(aPage);
+    }
+
+    // Drop the aCount oldest rows, as the ring does once full.
+    void pop_back(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        mColumns.DropOlder(aCount, Schema{});
+    }
+
+    // Drop the aCount newest rows.
+    void pop_front(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        mColumns.DropNewer(aCount, Schema{});
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return mColumns.Get<close_tag>().size();
+    }
+
+    // Column Tag, oldest first.
+    template <typename Tag>
+    [[nodiscard]] const auto& Get() const
+    {
+        return mColumns.Get<Tag>();
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_PRICE_COLUMNS_H__
@@ -0,0 +1,164 @@
+#ifndef __ABOLLO_MARKET_MODEL_QUERY_PROFILER_H__
+#define __ABOLLO_MARKET_MODEL_QUERY_PROFILER_H__
+
+
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <soci/logger.h>
+#include <soci/session.h>
+#include <soci/statement.h>
+
+#include "Utility/Singleton.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Log-linear latency histogram in the spirit of HdrHistogram: every power of two is split into SUB_BUCKET_COUNT linear sub-buckets,
+// so a recorded value is kept with a relative error below 1 / SUB_BUCKET_COUNT while the memory footprint stays fixed.
+class LatencyHistogram final
+{
+private:
+    constexpr static uint32_t SUB_BUCKET_BITS  = 5;
+    constexpr static uint32_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+    constexpr static uint32_t SUB_BUCKET_MASK  = SUB_BUCKET_COUNT - 1;
+    constexpr static uint32_t MAX_VALUE_BITS   = 40;    // ~12.7 days in microseconds.
+    constexpr static uint32_t BUCKET_COUNT     = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    std::array<uint64_t, BUCKET_COUNT> mCounts{};
+
+    uint64_t mTotalCount{0};
+    uint64_t mMin{UINT64_MAX};
+    uint64_t mMax{0};
+    double mSum{0.0};
+
+    [[nodiscard]] static uint32_t BucketIndex(const uint64_t aValue);
+    [[nodiscard]] static uint64_t BucketLowest(const uint32_t aIndex);
+
+public:
+    void Record(const uint64_t aMicroseconds);
+
+    // Value in microseconds at the given percentile in [0, 100].
+    [[nodiscard]] uint64_t Percentile(const double aPercentile) const;
+
+    [[nodiscard]] uint64_t Count() const
+    {
+        return mTotalCount;
+    }
+
+    [[nodiscard]] uint64_t Min() const
+    {
+        return mTotalCount == 0 ? 0 : mMin;
+    }
+
+    [[nodiscard]] uint64_t Max() const
+    {
+        return mMax;
+    }
+
+    [[nodiscard]] double Mean() const
+    {
+        return mTotalCount == 0 ? 0.0 : mSum / static_cast<double>(mTotalCount);
+    }
+};
+
+
+
+// Soci logger attached to every profiled session. Soci only reports the query text right before a statement is prepared,
+// so the logger counts prepares, and everything that needs timing goes through QueryProfiler directly.
+class ProfilingLogger final : public soci::logger_impl
+{
+private:
+    std::string mLastQuery;
+
+    logger_impl* do_clone() const override
+    {
+        return new ProfilingLogger;
+    }
+
+public:
+    void start_query(const std::string& aQuery) override;
+
+    [[nodiscard]] std::string get_last_query() const override
+    {
+        return mLastQuery;
+    }
+};
+
+
+
+class QueryProfiler final : private internal::Singleton<QueryProfiler>
+{
+public:
+    enum class Phase : uint8_t
+    {
+        ePrepare,
+        eExecute,
+        eFetch,
+
+        eCount
+    };
+
+private:
+    constexpr static const char* EXPLAIN_PREFIX = "EXPLAIN QUERY PLAN ";
+
+    struct StatementStats
+    {
+        std::array<LatencyHistogram, static_cast<size_t>(Phase::eCount)> latencies;
+
+        uint64_t prepares{0};
+        uint64_t executions{0};
+        uint64_t rows{0};
+
+        std::string lastBindings;
+
+        bool planExplained{false};
+        bool fullScan{false};
+        std::vector<std::string> plan;
+    };
+
+    mutable std::mutex mMutex;
+    std::map<std::string, StatementStats> mStatements;
+
+    [[nodiscard]] bool ShouldExplain(const std::string& aQuery);
+    void Explain(soci::session& aSession, const std::string& aQuery);
+
+public:
+    using Singleton<QueryProfiler>::Instance;
+
+    QueryProfiler() = default;
+    ~QueryProfiler();
+
+    // Attach a ProfilingLogger to the session, must be called before any statement is prepared on it.
+    static soci::session& Attach(soci::session& aSession);
+
+    // Prepare the statement and record its preparation latency.
+    [[nodiscard]] static soci::statement Prepare(soci::session& aSession, const std::string& aQuery);
+
+    void OnQuery(const std::string& aQuery);
+    void Record(const std::string& aQuery, const Phase aPhase, const double aMilliseconds);
+
+    // Record a complete execution. The first execution of every statement also runs EXPLAIN QUERY PLAN on the given session.
+    void RecordExecution(soci::session& aSession, const std::string& aQuery, std::string aBindings, const double aExecuteMs, const double aFetchMs,
+                         const uint64_t aRows);
+
+    void Report(std::ostream& aStream) const;
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_QUERY_PROFILER_H__
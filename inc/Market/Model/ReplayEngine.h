@@ -0,0 +1,116 @@
+#ifndef __ABOLLO_MARKET_MODEL_REPLAY_ENGINE_H__
+#define __ABOLLO_MARKET_MODEL_REPLAY_ENGINE_H__
+
+
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "Market/Model/DataAnalyzer.h"
+#include "Utility/NonCopyable.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Replays the daily bars of a code into a DataAnalyzer one at a time, the way a live session adds them, for training and strategy
+// review. The oldest bars are loaded at once to warm up the indicators, every later one goes through DataAnalyzer::LoadNewer: a bar
+// costs the incremental update of the ring and of every table, never a reload.
+// Bars are played at a number of bars per second, on the thread that owns the DataAnalyzer. Update is called once per frame and adds
+// the bars due since the previous frame as one batch, at 1000 bars per second and 60 frames per second about 17 bars a frame.
+// What a batch updates is what the chart reads back: the candles, the indicator and rolling statistic overlays, and the pattern
+// markers of CandlePatterns, the per-bar screen of the replayed code. Screens across codes are not replayed: a Screen ranks every
+// code on one date of the database, while a replay plays the dates of one code.
+class ReplayEngine final : private internal::NonCopyable
+{
+public:
+    constexpr static double DEFAULT_SPEED = 1.0;    // Bars per second.
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    constexpr static uint32_t MAX_BATCH  = 256;     // Bars per LoadNewer, well below the capacity of the ring.
+    constexpr static double MAX_CATCH_UP = 0.25;    // Seconds of bars a frame plays at most after a stall.
+
+    DataAnalyzer& mDataAnalyzer;
+
+    DataAnalyzer::PagedTableType mBars;     // Every bar of the replay, newest first.
+    DataAnalyzer::PagedTableType mBatch;    // Bars of one LoadNewer, refilled in place.
+    uint32_t mPending{0};                   // Bars not played yet, the newest ones, mBars[0, mPending).
+
+    double mSpeed;
+    double mDue{0.};    // Bars owed by the clock, with the fraction of the next one.
+    bool mPaused{false};
+    Clock::time_point mLastUpdate;
+
+    // Add the next aCount bars, oldest first. Returns the number of bars added.
+    uint32_t Play(const uint32_t aCount);
+
+public:
+    // Replay the aLimit bars of aCode from aOffset, the oldest aWarmUp of them, at least one, added at once. The rows loaded in
+    // aDataAnalyzer are dropped. Throws std::runtime_error if aCode has no bars there.
+    ReplayEngine(DataAnalyzer& aDataAnalyzer, const std::string& aCode, const uint32_t aOffset, const uint32_t aLimit, const uint32_t aWarmUp,
+                 const double aSpeed = DEFAULT_SPEED);
+
+    // Add the bars due since the previous call, none while paused. Returns the number of bars added.
+    uint32_t Update();
+
+    // Add the next aCount bars now, paused or not.
+    uint32_t Step(const uint32_t aCount = 1)
+    {
+        return Play(aCount);
+    }
+
+    void Pause()
+    {
+        mPaused = true;
+    }
+
+    // Bars are due again from now on, the time spent paused does not count.
+    void Resume()
+    {
+        mPaused     = false;
+        mDue        = 0.;
+        mLastUpdate = Clock::now();
+    }
+
+    [[nodiscard]] bool Paused() const
+    {
+        return mPaused;
+    }
+
+    void SetSpeed(const double aSpeed)
+    {
+        assert(aSpeed > 0.);
+
+        mSpeed = aSpeed;
+    }
+
+    [[nodiscard]] double Speed() const
+    {
+        return mSpeed;
+    }
+
+    [[nodiscard]] uint32_t Pending() const
+    {
+        return mPending;
+    }
+
+    [[nodiscard]] bool Finished() const
+    {
+        return mPending == 0;
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_REPLAY_ENGINE_H__
@@ -0,0 +1,62 @@
+#ifndef __ABOLLO_MARKET_MODEL_RING_RANGE_H__
+#define __ABOLLO_MARKET_MODEL_RING_RANGE_H__
+
+
+
+#include <cstdint>
+
+
+
+namespace abollo
+{
+
+
+
+// A run [first, last) of physical rows of a ring buffer.
+struct RingSegment
+{
+    uint32_t first{0};
+    uint32_t last{0};
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return last - first;
+    }
+};
+
+
+
+// Logical rows of a ring buffer as at most two runs of physical rows. The tail is empty unless the rows wrap around the end of the
+// buffer, it then starts at physical row 0. Algorithms run once per segment and merge, so the ring never has to be linearized.
+struct RingRange
+{
+    constexpr static uint32_t NO_WRAP = 0xFFFFFFFF;
+
+    RingSegment head;
+    RingSegment tail;
+    uint32_t mask{NO_WRAP};    // Capacity - 1 of the buffer, physical row r + 1 of a segment is (r + 1) & mask.
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return head.size() + tail.size();
+    }
+
+    // Call aOp on the non-empty segments, head first.
+    template <typename Op>
+    void ForEach(Op&& aOp) const
+    {
+        if (head.size() > 0)
+            aOp(head);
+
+        if (tail.size() > 0)
+            aOp(tail);
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_RING_RANGE_H__
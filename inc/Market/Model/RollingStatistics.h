@@ -0,0 +1,370 @@
+#ifndef __ABOLLO_MARKET_MODEL_ROLLING_STATISTICS_H__
+#define __ABOLLO_MARKET_MODEL_ROLLING_STATISTICS_H__
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "Market/Model/ColumnTraits.h"
+#include "Utility/AlignedAllocator.h"
+#include "Utility/DoubleEndedVector.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace internal
+{
+
+
+
+template <typename Tag>
+struct IndicatorColumn
+{
+    DoubleEndedVector<float, AlignedAllocator<float>> values;    // Oldest first, so that every recurrence runs forward in memory.
+};
+
+
+template <typename... Tags>
+class IndicatorColumns;
+
+
+template <typename... Tags>
+class IndicatorColumns<TableSchema<Tags...>> : private IndicatorColumn<Tags>...
+{
+public:
+    template <typename Tag>
+    [[nodiscard]] auto& Get()
+    {
+        return IndicatorColumn<Tag>::values;
+    }
+
+    template <typename Tag>
+    [[nodiscard]] const auto& Get() const
+    {
+        return IndicatorColumn<Tag>::values;
+    }
+
+    // Open aCount rows before the oldest or after the newest row of the given columns, filled with NaN until they are computed.
+    template <typename... Ts>
+    void Prepend(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (IndicatorColumn<Ts>::values.prepend_n(aCount, std::numeric_limits<float>::quiet_NaN()), 0)...};
+    }
+
+    template <typename... Ts>
+    void Append(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (IndicatorColumn<Ts>::values.append_n(aCount, std::numeric_limits<float>::quiet_NaN()), 0)...};
+    }
+
+    // Drop the aCount oldest or newest rows of the given columns.
+    template <typename... Ts>
+    void DropFront(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (IndicatorColumn<Ts>::values.drop_front(aCount), 0)...};
+    }
+
+    template <typename... Ts>
+    void DropBack(const size_t aCount, TableSchema<Ts...>)
+    {
+        using expander = int[];
+        (void)expander{0, (IndicatorColumn<Ts>::values.drop_back(aCount), 0)...};
+    }
+};
+
+
+
+}    // namespace internal
+
+
+
+struct RollingParameters
+{
+    uint32_t volatilityPeriod{20};
+    uint32_t zscorePeriod{20};
+    uint32_t rangePeriod{20};
+    uint32_t drawdownPeriod{250};
+    float annualization{250.f};    // Bars per year, volatility is the deviation of the returns scaled by its square root.
+};
+
+
+
+// Mean and variance of a sliding window, Welford's update run forward to add a value and backward to remove one. Unlike differences
+// of running sums it does not cancel catastrophically on prices far from zero, but removals still let rounding errors build up over
+// a long stream, which Recompute of the owner clears.
+class WelfordWindow final
+{
+private:
+    uint32_t mCount{0};
+    double mMean{0.0};
+    double mSquares{0.0};    // Sum of the squared deviations from the mean.
+
+public:
+    void Add(const double aValue)
+    {
+        const auto lDelta = aValue - mMean;
+
+        mMean += lDelta / ++mCount;
+        mSquares += lDelta * (aValue - mMean);
+    }
+
+    void Remove(const double aValue)
+    {
+        if (mCount <= 1)
+        {
+            *this = {};
+            return;
+        }
+
+        const auto lDelta = aValue - mMean;
+
+        mMean -= lDelta / --mCount;
+        mSquares = std::max(mSquares - lDelta * (aValue - mMean), 0.0);
+    }
+
+    // The window with aValue added, without changing it.
+    [[nodiscard]] WelfordWindow With(const double aValue) const
+    {
+        auto lWindow = *this;
+        lWindow.Add(aValue);
+
+        return lWindow;
+    }
+
+    [[nodiscard]] uint32_t Count() const
+    {
+        return mCount;
+    }
+
+    [[nodiscard]] double Mean() const
+    {
+        return mMean;
+    }
+
+    // Population variance.
+    [[nodiscard]] double Variance() const
+    {
+        return mCount > 0 ? mSquares / mCount : 0.0;
+    }
+};
+
+
+
+// Extremum of a sliding window. The deque keeps the rows that can still become the extremum, those not beaten by a later row, so
+// their values are monotonic and the extremum is the front. Every row is pushed and popped once, O(1) amortized per row.
+template <typename Compare>
+class MonotonicWindow final
+{
+private:
+    std::deque<std::pair<int64_t, float>> mCandidates;    // Row and value, oldest first.
+
+public:
+    void Push(const int64_t aRow, const float aValue)
+    {
+        while (!mCandidates.empty() && !Compare{}(mCandidates.back().second, aValue))
+            mCandidates.pop_back();
+
+        mCandidates.emplace_back(aRow, aValue);
+    }
+
+    // Drop the rows before aFirst.
+    void Expire(const int64_t aFirst)
+    {
+        while (!mCandidates.empty() && mCandidates.front().first < aFirst)
+            mCandidates.pop_front();
+    }
+
+    // Extremum of the window and aValue.
+    [[nodiscard]] float With(const float aValue) const
+    {
+        return mCandidates.empty() || !Compare{}(mCandidates.front().second, aValue) ? aValue : mCandidates.front().second;
+    }
+};
+
+
+using MaximumWindow = MonotonicWindow<std::greater<float>>;
+using MinimumWindow = MonotonicWindow<std::less<float>>;
+
+
+
+// Volatility, z-score of the close, rolling high and low, and drawdown from the rolling peak of one code, kept up to date by streaming
+// accumulators instead of recomputing windows:
+// - the accumulators hold the settled rows of the windows of the newest row, every row but the newest itself. A newer row settles the
+//   previous newest, adds it to the windows and expires the row that left them, O(1) per row;
+// - the newest row may still change during the day, Update replaces it and recomputes its statistics alone from the settled rows;
+// - older rows only change the statistics of the page and of the rows whose windows reach into it, O(page + period) for push_back, and
+//   the columns grow at both ends in amortized O(1) per row.
+// Rows are numbered from the first row ever loaded, so the accumulators survive older pages shifting the columns. Recompute reruns
+// every row on demand. Volatility and z-score are NaN until their window is full, the high, low and peak use the rows available.
+// Indices follow DataAnalyzer, 0 is the newest row.
+class RollingStatistics final
+{
+public:
+    using Schema = TableSchema<volatility_tag, zscore_tag, rolling_high_tag, rolling_low_tag, drawdown_tag>;
+
+private:
+    using ColumnsSchema = TableSchema<close_tag, high_tag, low_tag, volatility_tag, zscore_tag, rolling_high_tag, rolling_low_tag, drawdown_tag>;
+    using ColumnsType   = internal::IndicatorColumns<ColumnsSchema>;
+
+    // Settled rows of the windows of the row after them.
+    struct Accumulators
+    {
+        WelfordWindow returns;
+        WelfordWindow closes;
+        MaximumWindow highs;
+        MinimumWindow lows;
+        MaximumWindow peaks;
+        int64_t first{0};    // Oldest row settled, the rows before it were never added and are not removed.
+    };
+
+    RollingParameters mParameters;
+    ColumnsType mColumns;
+    Accumulators mAccumulators;
+    int64_t mFirstRow{0};    // Number of the oldest row, it goes below 0 as older pages come in.
+
+    // Pages are ordered by date descending, older pages go before the oldest row and newer ones after the newest, both reversed.
+    template <typename Tag, typename U>
+    void Insert(const bool aOlder, const U& aPage)
+    {
+        const auto lBegin = std::make_reverse_iterator(aPage.template begin<Tag>() + aPage.size());
+        const auto lEnd   = std::make_reverse_iterator(aPage.template begin<Tag>());
+
+        auto& lValues = mColumns.template Get<Tag>();
+
+        if (aOlder)
+            lValues.prepend(lBegin, lEnd);
+        else
+            lValues.append(lBegin, lEnd);
+    }
+
+    template <typename U>
+    void Insert(const bool aOlder, const U& aPage)
+    {
+        if (aOlder)
+            mColumns.Prepend(aPage.size(), Schema{});
+        else
+            mColumns.Append(aPage.size(), Schema{});
+
+        Insert<close_tag>(aOlder, aPage);
+        Insert<high_tag>(aOlder, aPage);
+        Insert<low_tag>(aOlder, aPage);
+    }
+
+    [[nodiscard]] uint32_t Reach() const
+    {
+        return std::max({mParameters.volatilityPeriod + 1, mParameters.zscorePeriod, mParameters.rangePeriod, mParameters.drawdownPeriod});
+    }
+
+    [[nodiscard]] double Return(const size_t aIndex) const;
+
+    // Add the row aIndex to aAccumulators and expire the rows outside the windows of the row after it.
+    void Settle(Accumulators& aAccumulators, const size_t aIndex) const;
+
+    // Statistics of the row aIndex from the settled rows before it.
+    void Evaluate(const Accumulators& aAccumulators, const size_t aIndex);
+
+    // Recompute rows [aFrom, aTo), the accumulators are kept when the range ends at the newest row.
+    void Compute(const size_t aFrom, const size_t aTo);
+
+public:
+    explicit RollingStatistics(const RollingParameters& aParameters = {}) : mParameters{aParameters}
+    {
+    }
+
+    template <typename U>
+    void push_back(const U& aPage)
+    {
+        const auto lCount = aPage.size();
+
+        Insert(true, aPage);
+        mFirstRow -= static_cast<int64_t>(lCount);
+
+        Compute(0, std::min(size(), lCount + Reach() - 1));
+    }
+
+    template <typename U>
+    void push_front(const U& aPage)
+    {
+        const auto lFrom = size();
+
+        Insert(false, aPage);
+
+        if (lFrom == 0)
+        {
+            Compute(0, size());
+            return;
+        }
+
+        for (auto i = lFrom; i < size(); ++i)
+        {
+            Settle(mAccumulators, i - 1);
+            Evaluate(mAccumulators, i);
+        }
+    }
+
+    // Drop the aCount oldest rows, as the ring does once full. The statistics of the rows left are kept, the windows of the newest
+    // row are settled again only if the rows left no longer cover them.
+    void pop_back(const size_t aCount);
+
+    // Drop the aCount newest rows, the accumulators are settled again for the new newest row.
+    void pop_front(const size_t aCount);
+
+    // Replace the newest bar by its latest intraday values, only the statistics of the newest row are recomputed.
+    void Update(const float aClose, const float aHigh, const float aLow);
+
+    // Recompute every row, clearing the rounding errors the accumulators have gathered.
+    void Recompute();
+
+    // Change the periods and recompute every row.
+    void Reset(const RollingParameters& aParameters);
+
+    [[nodiscard]] const auto& GetParameters() const
+    {
+        return mParameters;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return mColumns.Get<close_tag>().size();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto begin() const
+    {
+        return mColumns.Get<Tag>().crbegin();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] auto end() const
+    {
+        return mColumns.Get<Tag>().crend();
+    }
+
+    template <typename Tag>
+    [[nodiscard]] float at(const uint32_t aIndex) const
+    {
+        return *(begin<Tag>() + aIndex);
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_ROLLING_STATISTICS_H__
@@ -0,0 +1,215 @@
+#ifndef __ABOLLO_MARKET_MODEL_SCREENER_H__
+#define __ABOLLO_MARKET_MODEL_SCREENER_H__
+
+
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Utility/AlignedAllocator.h"
+
+
+
+namespace abollo
+{
+
+
+
+class DataLoader;
+class WorkStealingPool;
+
+
+
+enum class ScreenField : uint8_t
+{
+    eOpen,
+    eClose,
+    eLow,
+    eHigh,
+    eVolume,
+    eAmount,
+    eCount
+};
+
+
+constexpr auto SCREEN_FIELD_COUNT = static_cast<size_t>(ScreenField::eCount);
+
+
+
+// Bars of every code on the last trading dates, aligned on dates like PatternScanner: row Days() - 1 is the latest date and a code
+// without a bar on a date holds NaN there. Every field of a code is contiguous, oldest first, so windows over a code are one run of memory.
+class ScreenUniverse final
+{
+private:
+    uint32_t mDays{0};
+    std::vector<std::string> mDates;    // Oldest first.
+    std::vector<std::string> mCodes;    // Sorted.
+
+    std::array<std::vector<float, AlignedAllocator<float, true>>, SCREEN_FIELD_COUNT> mColumns;    // mColumns[field][code * mDays + row]
+
+public:
+    // The bars of the last aDays dates. aFilter is an SQL condition on the columns of the latest date, codes that fail it are not loaded.
+    [[nodiscard]] static ScreenUniverse Load(DataLoader& aDataLoader, const uint32_t aDays, const std::string& aFilter = {});
+
+    [[nodiscard]] uint32_t Days() const
+    {
+        return mDays;
+    }
+
+    [[nodiscard]] size_t Count() const
+    {
+        return mCodes.size();
+    }
+
+    [[nodiscard]] const auto& Dates() const
+    {
+        return mDates;
+    }
+
+    [[nodiscard]] const auto& Codes() const
+    {
+        return mCodes;
+    }
+
+    [[nodiscard]] const float* Bars(const ScreenField aField, const size_t aCode) const
+    {
+        return mColumns[static_cast<size_t>(aField)].data() + aCode * mDays;
+    }
+};
+
+
+
+struct ScreenResult
+{
+    std::string code;
+    float score;    // Value of the rank expression, 0 without one.
+};
+
+
+
+// A screen over the latest bars of every code, written as
+//      close > sma(close, 200) and rsi(14) < 30 and volume > 2 * avg(volume, 20) rank by volume / avg(volume, 20) desc limit 50
+// Columns are open, close, low, high, volume and amount of the latest date, ref(column, n) is the value n dates before. Windows over
+// the latest n dates are sma (or avg), ema, std, max and min of a column, and rsi(n), zscore(n), vol(n) and drawdown(n) of the closes,
+// the last three as RollingStatistics charts them. Comparisons combine with and, or, not and parentheses, a code with a missing bar in
+// any window reads NaN there and fails every comparison.
+//
+// Compile parses the text into a plan of nodes with constant arithmetic folded. Run cuts the codes into blocks evaluated in parallel,
+// each operator runs over a whole block at a time and every predicate takes a selection vector of the codes still alive and returns the
+// ones that pass, so the right side of an and only sees the codes the left side kept, and the right side of an or only those it rejected.
+// The conjuncts of the top level that compare a column of the latest date with a constant are also pushed down into SQLite by Load.
+class Screen final
+{
+public:
+    // Per-thread buffers of Run, one register of values and selected codes per level of the plan.
+    struct Scratch
+    {
+        std::vector<std::vector<float>> values;
+        std::vector<std::vector<uint32_t>> selections;
+    };
+
+private:
+    friend class ScreenParser;
+
+    constexpr static size_t BLOCK_CODES = 1024;
+
+    enum class Op : uint8_t
+    {
+        eConstant,
+        eColumn,
+        eSma,
+        eEma,
+        eStd,
+        eMax,
+        eMin,
+        eRsi,
+        eZScore,
+        eVolatility,
+        eDrawdown,
+        eNegate,
+        eAdd,
+        eSubtract,
+        eMultiply,
+        eDivide,
+        eLess,
+        eLessEqual,
+        eGreater,
+        eGreaterEqual,
+        eEqual,
+        eNotEqual,
+        eAnd,
+        eOr,
+        eNot
+    };
+
+    struct Node
+    {
+        Op op;
+        ScreenField field{ScreenField::eClose};
+        uint32_t period{0};    // Dates of a window, or dates before the latest of a column.
+        float value{0.f};
+        uint32_t left{0};
+        uint32_t right{0};
+    };
+
+    std::vector<Node> mNodes;
+    uint32_t mRoot{0};
+    uint32_t mRank{0};
+    bool mRanked{false};
+    bool mAscending{false};
+    uint32_t mLimit{0};    // 0 keeps every result.
+
+    uint32_t mLookback{1};    // Dates the universe must hold.
+    std::string mPushdown;
+
+    [[nodiscard]] static bool IsPredicate(const Op aOp)
+    {
+        return aOp >= Op::eLess;
+    }
+
+    [[nodiscard]] static bool IsComparison(const Op aOp)
+    {
+        return aOp >= Op::eLess && aOp <= Op::eNotEqual;
+    }
+
+    void Prepare();
+
+    // aNode on the codes of aSelection, into aScratch.values[aDepth].
+    void Evaluate(const ScreenUniverse& aUniverse, const uint32_t aNode, const std::vector<uint32_t>& aSelection, const size_t aDepth, Scratch& aScratch) const;
+
+    // The codes of aSelection that pass aNode, into aScratch.selections[aDepth].
+    void Select(const ScreenUniverse& aUniverse, const uint32_t aNode, const std::vector<uint32_t>& aSelection, const size_t aDepth, Scratch& aScratch) const;
+
+public:
+    // Throws std::invalid_argument naming the offset of the first error in aText.
+    [[nodiscard]] static Screen Compile(std::string_view aText);
+
+    [[nodiscard]] uint32_t Lookback() const
+    {
+        return mLookback;
+    }
+
+    // SQL condition of the pushed down conjuncts, empty when there are none.
+    [[nodiscard]] const std::string& Pushdown() const
+    {
+        return mPushdown;
+    }
+
+    // Load a universe deep enough for this screen, restricted by its pushed down conjuncts.
+    [[nodiscard]] ScreenUniverse Load(DataLoader& aDataLoader) const;
+
+    // Codes of aUniverse that pass the screen, ranked when the screen has a rank clause and ordered by code otherwise.
+    // aUniverse must hold Lookback() dates, a universe loaded once serves every screen that looks back no further.
+    [[nodiscard]] std::vector<ScreenResult> Run(const ScreenUniverse& aUniverse, WorkStealingPool& aPool) const;
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_SCREENER_H__
@@ -3,6 +3,10 @@
 
 
 
+#include <chrono>
+
+#include <date/date.h>
+
 #include "Market/Model/ChunkedArray.h"
 #include "Market/Model/ColumnTraits.h"
 
@@ -18,6 +22,11 @@ using Column = ChunkedArray<C, Size, Y>;
 
 
 
+// Start of an intraday bar.
+using MinuteTime = date::sys_time<std::chrono::minutes>;
+
+
+
 template <typename Tag>
 struct RowValue
 {
@@ -32,7 +41,16 @@ struct RowValue<date_tag>
 {
     using type = date_tag;
 
-    date::year_month_day value;
+    date::sys_days value;
+};
+
+
+template <>
+struct RowValue<time_tag>
+{
+    using type = time_tag;
+
+    MinuteTime value;
 };
 
 
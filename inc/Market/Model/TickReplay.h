@@ -0,0 +1,74 @@
+#ifndef __ABOLLO_MARKET_MODEL_TICK_REPLAY_H__
+#define __ABOLLO_MARKET_MODEL_TICK_REPLAY_H__
+
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Market/Model/MinuteBarFeed.h"
+#include "Utility/NonCopyable.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Stand-in for a live feed: replays the ticks of a local file on a thread of its own through a BarAggregator, and posts the bars of
+// every interval to a MinuteBarFeed. The ticks due at the same time are aggregated as one batch, after which the bars still forming are
+// posted again, like a live feed revises them.
+// Ticks are replayed at aSpeed times the pace they were recorded at. At a speed of 0 they are replayed as fast as the consumer drains
+// them, the replay then waits for the queue rather than holding back an unbounded backlog.
+class TickReplay final : private internal::NonCopyable
+{
+private:
+    MinuteBarFeed& mFeed;
+    const std::vector<Tick> mTicks;
+    const double mSpeed;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    bool mStopping{false};    // Guarded by mMutex.
+    std::atomic<bool> mFinished{false};
+
+    std::thread mThread;
+
+    // Sleep until aTime, returns false if the replay is stopped meanwhile.
+    bool WaitUntil(const std::chrono::steady_clock::time_point aTime);
+
+    void Run();
+
+public:
+    // Ticks of aPath in time order. A .csv file holds one tick per line, "YYYY-MM-DD HH:MM:SS[.fff],price,volume", after an optional
+    // header line. Any other file is packed little-endian records of int64 milliseconds since the epoch, float price, float volume.
+    // Throws std::runtime_error if the file cannot be read or a tick is malformed.
+    [[nodiscard]] static std::vector<Tick> Load(const std::filesystem::path& aPath);
+
+    // Load the ticks of aPath on the calling thread, then start replaying them.
+    TickReplay(const std::filesystem::path& aPath, MinuteBarFeed& aFeed, const double aSpeed = 1.0);
+    ~TickReplay();
+
+    // Stop the replay at the next tick and join it.
+    void Stop();
+
+    // Every tick has been posted and is in the queue of the feed.
+    [[nodiscard]] bool Finished() const
+    {
+        return mFinished.load(std::memory_order_acquire);
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_TICK_REPLAY_H__
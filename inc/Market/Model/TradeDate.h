@@ -11,6 +11,8 @@
 #include <soci/soci.h>
 #include <soci/sqlite3/soci-sqlite3.h>
 
+#include "Market/Model/QueryProfiler.h"
+
 
 
 namespace abollo
@@ -32,10 +34,10 @@ private:
     soci::session mSession{soci::sqlite3, R"(data/ashare.db)"};
     soci::statement mTradeDateStmt;
 
-    std::vector<date::year_month_day> mTradeDates{20};
+    std::vector<date::sys_days> mTradeDates{20};
 
 public:
-    TradeDate() : mTradeDateStmt(mSession.prepare << TRADE_DATE_SQL)
+    TradeDate() : mTradeDateStmt(QueryProfiler::Prepare(QueryProfiler::Attach(mSession), TRADE_DATE_SQL))
     {
     }
 
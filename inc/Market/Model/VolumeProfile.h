@@ -0,0 +1,146 @@
+#ifndef __ABOLLO_MARKET_MODEL_VOLUME_PROFILE_H__
+#define __ABOLLO_MARKET_MODEL_VOLUME_PROFILE_H__
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include <thrust/copy.h>
+#include <thrust/device_vector.h>
+#include <thrust/host_vector.h>
+#include <thrust/transform.h>
+
+#include "Market/Model/ColumnExpression.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Volume traded at every price of a range of candles. The range [low, high] is cut into bins of equal height, in the same space as the
+// price axis, linear or log. The volume of a candle is spread evenly over its low-high range, a bin receives the part of its own height.
+struct VolumeProfile
+{
+    float low{0.f};
+    float high{0.f};
+    std::vector<float> volumes;    // From the lowest bin to the highest one.
+
+    [[nodiscard]] float BinHeight() const
+    {
+        return volumes.empty() ? 0.f : (high - low) / static_cast<float>(volumes.size());
+    }
+};
+
+
+
+namespace internal
+{
+
+
+
+// Volume of one bin. Every bin is a thread that reads the candles of the range, the bins are independent, so the histogram needs
+// neither atomic adds nor a merge of partial bins, and the candles are few enough (a screen of them) to be read once per bin.
+struct ProfileBin
+{
+    const float* lows;
+    const float* highs;
+    const float* volumes;
+    uint32_t first;
+    uint32_t last;
+    float bottom;
+    float height;
+    bool logarithmic;
+
+    __host__ __device__ float operator()(const uint32_t aBin) const
+    {
+        const auto lBinLow  = bottom + height * static_cast<float>(aBin);
+        const auto lBinHigh = lBinLow + height;
+
+        float lVolume = 0.f;
+
+        for (auto r = first; r < last; ++r)
+        {
+            const auto lLow  = logarithmic ? logf(lows[r]) : lows[r];
+            const auto lHigh = logarithmic ? logf(highs[r]) : highs[r];
+
+            if (lHigh > lLow)
+            {
+                const auto lOverlap = thrust::min(lHigh, lBinHigh) - thrust::max(lLow, lBinLow);
+
+                lVolume += lOverlap > 0.f ? volumes[r] * lOverlap / (lHigh - lLow) : 0.f;
+            }
+            else
+                lVolume += lLow >= lBinLow && lLow < lBinHigh ? volumes[r] : 0.f;
+        }
+
+        return lVolume;
+    }
+};
+
+
+
+}    // namespace internal
+
+
+
+// Profile of the rows [aFirst, aLast) of aTable over aBins bins between aLow and aHigh, computed on the backend of aTable.
+template <typename T>
+[[nodiscard]] VolumeProfile Profile(const T& aTable, const uint32_t aFirst, const uint32_t aLast, const float aLow, const float aHigh, const uint32_t aBins,
+                                   const bool aLogarithmic)
+{
+    using System      = internal::expression_system_t<T, ColumnExpression<low_tag>>;
+    using BufferType  = std::conditional_t<std::is_same<System, thrust::host_system_tag>::value, thrust::host_vector<float>, thrust::device_vector<float>>;
+    using CounterType = thrust::counting_iterator<uint32_t, System>;
+
+    VolumeProfile lProfile{aLow, aHigh, std::vector<float>(aBins, 0.f)};
+
+    if (aBins == 0 || aFirst >= aLast || !(aHigh > aLow))
+        return lProfile;
+
+    const internal::ProfileBin lBin{Bind(aTable, col<low_tag>()).data,
+                                    Bind(aTable, col<high_tag>()).data,
+                                    Bind(aTable, col<volume_tag>()).data,
+                                    aFirst,
+                                    aLast,
+                                    aLow,
+                                    lProfile.BinHeight(),
+                                    aLogarithmic};
+
+    BufferType lVolumes(aBins);
+
+    thrust::transform(CounterType{0}, CounterType{aBins}, lVolumes.begin(), lBin);
+    thrust::copy(lVolumes.begin(), lVolumes.end(), lProfile.volumes.begin());
+
+    return lProfile;
+}
+
+
+// Profile of the rows of a ring, the bins of every segment are added up.
+template <typename T>
+[[nodiscard]] VolumeProfile Profile(const T& aTable, const RingRange& aRange, const float aLow, const float aHigh, const uint32_t aBins, const bool aLogarithmic)
+{
+    VolumeProfile lProfile{aLow, aHigh, std::vector<float>(aBins, 0.f)};
+
+    aRange.ForEach([&](const RingSegment& aSegment) {
+        const auto lSegment = Profile(aTable, aSegment.first, aSegment.last, aLow, aHigh, aBins, aLogarithmic);
+
+        std::transform(lSegment.volumes.cbegin(), lSegment.volumes.cend(), lProfile.volumes.cbegin(), lProfile.volumes.begin(), std::plus<float>{});
+    });
+
+    return lProfile;
+}
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_MARKET_MODEL_VOLUME_PROFILE_H__
@@ -5,13 +5,17 @@
 
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <date/date.h>
 #include <skia/include/core/SkCanvas.h>
 #include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkPaint.h>
 
+#include "Market/Model/BarAggregator.h"
+#include "Market/Model/CandlePatterns.h"
 #include "Market/Model/MarketDataFields.h"
+#include "Market/Model/VolumeProfile.h"
 
 
 
@@ -25,26 +29,60 @@ class Painter final
 private:
     constexpr static std::string_view DEFAULT_DATE_FORMAT     = "00/00";    // The default date format is MM/DD
     constexpr static std::string_view DEFAULT_DATE_FORMAT_STR = "{:02}/{:02}";
+    constexpr static SkScalar PROFILE_WIDTH                   = 0.2f;    // Width of the longest bar of a volume profile, as a fraction of the canvas.
+    constexpr static std::string_view DEFAULT_TIME_FORMAT_STR = "{:02}:{:02}";    // HH:MM, as wide as the date labels.
+    constexpr static SkScalar BAR_SPACING                     = 8.f;     // Pixels between two intraday bars.
+    constexpr static SkScalar BAR_VOLUME_HEIGHT               = 0.2f;    // Height of the volumes under the intraday bars, as a fraction of the canvas.
 
     SkPaint mCandlePaint;
     SkPaint mCandlestickPaint;
     SkPaint mAxisPaint;
     SkPaint mVolumePaint;
+    SkPaint mPatternPaint;
+    SkPaint mOverlayPaint;
+    SkPaint mProfilePaint;
 
     SkFont mAxisLabelFont;
 
     SkScalar mDateLabelWidth;
     SkScalar mDateLabelSpace;
 
-    SkScalar DrawDateAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const SkScalar aCoordY, const date::year_month_day& aDate) const;
+    SkScalar DrawDateAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const SkScalar aCoordY, const date::sys_days aDate) const;
+    SkScalar DrawTimeAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const SkScalar aCoordY, const MinuteTime aTime) const;
 
 public:
     Painter();
     virtual ~Painter() = default;
 
+    // Rasterize the axis label glyphs once so that the first frame finds them in the glyph cache.
+    void WarmUp() const;
+
     void Highlight(SkCanvas& aCanvas, const MarketDataFields& aCandleData, const SkScalar aCandleWidth);
 
+    // Total volume and VWAP over a range of candles, labelled at aPos.
+    void DrawStatistics(SkCanvas& aCanvas, const SkPoint& aPos, const double aVolume, const double aVwap) const;
+
+    // Annualized volatility, z-score of the close and drawdown from the rolling peak of one candle, as RollingStatistics computes them,
+    // labelled on the line below the statistics at aPos.
+    void DrawRollingStatistics(SkCanvas& aCanvas, const SkPoint& aPos, const float aVolatility, const float aZScore, const float aDrawdown) const;
+
+    // Horizontal histogram of aProfile docked to the right edge, where the price axis is. aScaleY and aTransY map the space of the
+    // profile to the window, as for the price axis.
+    void DrawVolumeProfile(SkCanvas& aCanvas, const VolumeProfile& aProfile, const SkScalar aScaleY, const SkScalar aTransY) const;
+
     void DrawCandle(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator, DatePriceZipIterator>& lData, const SkScalar aCandleWidth);
+
+    // Candles of the latest bars of aBars that fit the canvas, the newest at the right edge, scaled to their own lowest low and highest
+    // high, with their volumes along the bottom. Labelled with the time of the day, or with the date for daily bars.
+    void DrawBars(SkCanvas& aCanvas, const MinuteBarTable& aBars, const BarInterval aInterval);
+
+    // Line through the window Y coordinates aCoordsY, one per candle of lData in the same order, broken where they are NaN.
+    void DrawOverlay(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator, DatePriceZipIterator>& lData, const std::vector<SkScalar>& aCoordsY, const SkColor aColor);
+
+    // Mark the candles of lData at the distances aOffsets, as returned by DataAnalyzer::Patterns, with one draw call per pattern.
+    // Bullish patterns are marked below the low, the others above the high.
+    void DrawPatterns(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator, DatePriceZipIterator>& lData, const CandlePattern aPattern,
+                      const std::vector<uint32_t>& aOffsets, const SkScalar aCandleWidth);
 };
 
 
@@ -12,6 +12,7 @@
 #include <skia/include/core/SkFont.h>
 #include <skia/include/core/SkFontMgr.h>
 #include <skia/include/core/SkPaint.h>
+#include <skia/include/core/SkSurface.h>
 
 
 
@@ -96,6 +97,15 @@ public:
         mLabelSpace  = mLabelHeight + mLabelHeight;
     }
 
+    // Rasterize the label glyphs once so that the first frame finds them in the glyph cache.
+    void WarmUp() const
+    {
+        constexpr std::string_view lGlyphs = "0123456789.-";
+
+        const auto lSurface = SkSurface::MakeRasterN32Premul(static_cast<int>(mLabelWidth * 2.f), static_cast<int>(mLabelSpace));
+        lSurface->getCanvas()->drawSimpleText(lGlyphs.data(), lGlyphs.size(), SkTextEncoding::kUTF8, 0.f, mLabelHeight, mLabelFont, mPaint);
+    }
+
     template <typename Pos, typename T, typename Tag>
     void Draw(SkCanvas& aCanvas, const Axis<T, Tag>& aAxis) const
     {
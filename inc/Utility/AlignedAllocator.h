@@ -0,0 +1,99 @@
+#ifndef __ABOLLO_UTILITY_ALIGNED_ALLOCATOR_H__
+#define __ABOLLO_UTILITY_ALIGNED_ALLOCATOR_H__
+
+
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+
+
+namespace abollo
+{
+
+
+
+constexpr size_t SIMD_ALIGNMENT = 64;         // A cache line, and the widest vector register, AVX-512.
+constexpr size_t HUGE_PAGE_SIZE = 2 << 20;    // Smaller allocations never ask for huge pages.
+
+
+// Number of values of T that fill whole SIMD registers and hold at least aCount values.
+template <typename T>
+[[nodiscard]] constexpr size_t PaddedCount(const size_t aCount)
+{
+    constexpr auto lLanes = SIMD_ALIGNMENT / sizeof(T) > 0 ? SIMD_ALIGNMENT / sizeof(T) : 1;
+
+    return (aCount + lLanes - 1) / lLanes * lLanes;
+}
+
+
+// At least aBytes aligned on SIMD_ALIGNMENT, throws std::bad_alloc. With aHugePages an allocation of HUGE_PAGE_SIZE or more is backed
+// by large pages when the system grants them, on Windows that takes the Lock Pages in Memory privilege, and by normal pages otherwise.
+// FreeAligned must be given the same size and flag.
+[[nodiscard]] void* AllocateAligned(const size_t aBytes, const bool aHugePages = false);
+void FreeAligned(void* aMemory, const size_t aBytes, const bool aHugePages = false);
+
+
+
+// Allocator of aligned storage padded to whole SIMD registers: a vector of n values owns PaddedCount(n) of them, so a kernel may load
+// full vectors up to the padded count without a scalar epilogue, and every column starts on a register boundary, without a prologue.
+// The padding is allocated, not constructed, kernels may read it but must not rely on its values.
+template <typename T, const bool HugePages = false>
+class AlignedAllocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, HugePages>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, HugePages>&) noexcept
+    {
+    }
+
+    [[nodiscard]] T* allocate(const size_t aCount)
+    {
+        if (aCount > std::numeric_limits<size_t>::max() / sizeof(T) - SIMD_ALIGNMENT)
+            throw std::bad_alloc();
+
+        return static_cast<T*>(AllocateAligned(PaddedCount<T>(aCount) * sizeof(T), HugePages));
+    }
+
+    void deallocate(T* aMemory, const size_t aCount) noexcept
+    {
+        FreeAligned(aMemory, PaddedCount<T>(aCount) * sizeof(T), HugePages);
+    }
+
+    template <typename U>
+    [[nodiscard]] bool operator==(const AlignedAllocator<U, HugePages>&) const noexcept
+    {
+        return true;
+    }
+
+    template <typename U>
+    [[nodiscard]] bool operator!=(const AlignedAllocator<U, HugePages>&) const noexcept
+    {
+        return false;
+    }
+};
+
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_UTILITY_ALIGNED_ALLOCATOR_H__
@@ -0,0 +1,228 @@
+#ifndef __ABOLLO_UTILITY_DOUBLE_ENDED_VECTOR_H__
+#define __ABOLLO_UTILITY_DOUBLE_ENDED_VECTOR_H__
+
+
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+
+
+namespace abollo
+{
+
+
+
+// Contiguous values that grow and shrink at both ends in amortized O(1) per value, where std::vector moves every value to insert at
+// its front. The values sit at the end of a vector behind free slots: adding to the front fills the slots and reallocates only once
+// they run out, leaving as many free slots as values; dropping from the front frees slots, and those beyond the number of values are
+// given back, so a stream adding at one end and dropping at the other does not grow without bound.
+template <typename T, typename Allocator = std::allocator<T>>
+class DoubleEndedVector final
+{
+public:
+    using value_type             = T;
+    using iterator               = T*;
+    using const_iterator         = const T*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    std::vector<T, Allocator> mValues;
+    size_t mFirst{0};    // Free slots before the first value.
+
+public:
+    DoubleEndedVector() = default;
+
+    explicit DoubleEndedVector(const size_t aCount, const T& aValue = T{}) : mValues(aCount, aValue)
+    {
+    }
+
+    // Add aCount copies of aValue before the first value.
+    void prepend_n(const size_t aCount, const T& aValue)
+    {
+        if (aCount > mFirst)
+        {
+            const auto lSlots = std::max(aCount, size());
+
+            std::vector<T, Allocator> lValues;
+            lValues.reserve(lSlots + size());
+            lValues.resize(lSlots, aValue);
+            lValues.insert(lValues.end(), cbegin(), cend());
+
+            mValues = std::move(lValues);
+            mFirst  = lSlots;
+        }
+
+        mFirst -= aCount;
+
+        std::fill_n(begin(), aCount, aValue);
+    }
+
+    // Add the values of [aBegin, aEnd) before the first value, in their order.
+    template <typename Iterator>
+    void prepend(Iterator aBegin, Iterator aEnd)
+    {
+        prepend_n(static_cast<size_t>(std::distance(aBegin, aEnd)), T{});
+
+        std::copy(aBegin, aEnd, begin());
+    }
+
+    // Add aCount copies of aValue after the last value.
+    void append_n(const size_t aCount, const T& aValue)
+    {
+        mValues.resize(mValues.size() + aCount, aValue);
+    }
+
+    template <typename Iterator>
+    void append(Iterator aBegin, Iterator aEnd)
+    {
+        mValues.insert(mValues.end(), aBegin, aEnd);
+    }
+
+    // Drop the aCount first values.
+    void drop_front(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        mFirst += aCount;
+
+        const auto lSize = size();
+
+        if (mFirst > lSize)
+        {
+            mValues.erase(mValues.begin(), mValues.begin() + (mFirst - lSize));
+            mFirst = lSize;
+        }
+    }
+
+    // Drop the aCount last values.
+    void drop_back(const size_t aCount)
+    {
+        assert(aCount <= size());
+
+        mValues.erase(mValues.end() - aCount, mValues.end());
+    }
+
+    void clear()
+    {
+        mValues.clear();
+        mFirst = 0;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return mValues.size() - mFirst;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return size() == 0;
+    }
+
+    [[nodiscard]] T* data()
+    {
+        return mValues.data() + mFirst;
+    }
+
+    [[nodiscard]] const T* data() const
+    {
+        return mValues.data() + mFirst;
+    }
+
+    [[nodiscard]] T& operator[](const size_t aIndex)
+    {
+        assert(aIndex < size());
+
+        return data()[aIndex];
+    }
+
+    [[nodiscard]] const T& operator[](const size_t aIndex) const
+    {
+        assert(aIndex < size());
+
+        return data()[aIndex];
+    }
+
+    [[nodiscard]] T& front()
+    {
+        return (*this)[0];
+    }
+
+    [[nodiscard]] const T& front() const
+    {
+        return (*this)[0];
+    }
+
+    [[nodiscard]] T& back()
+    {
+        return (*this)[size() - 1];
+    }
+
+    [[nodiscard]] const T& back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    [[nodiscard]] iterator begin()
+    {
+        return data();
+    }
+
+    [[nodiscard]] iterator end()
+    {
+        return data() + size();
+    }
+
+    [[nodiscard]] const_iterator begin() const
+    {
+        return data();
+    }
+
+    [[nodiscard]] const_iterator end() const
+    {
+        return data() + size();
+    }
+
+    [[nodiscard]] const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    [[nodiscard]] const_iterator cend() const
+    {
+        return end();
+    }
+
+    [[nodiscard]] reverse_iterator rbegin()
+    {
+        return reverse_iterator{end()};
+    }
+
+    [[nodiscard]] reverse_iterator rend()
+    {
+        return reverse_iterator{begin()};
+    }
+
+    [[nodiscard]] const_reverse_iterator crbegin() const
+    {
+        return const_reverse_iterator{cend()};
+    }
+
+    [[nodiscard]] const_reverse_iterator crend() const
+    {
+        return const_reverse_iterator{cbegin()};
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_UTILITY_DOUBLE_ENDED_VECTOR_H__
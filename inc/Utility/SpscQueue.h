@@ -0,0 +1,86 @@
+#ifndef __ABOLLO_UTILITY_SPSC_QUEUE_H__
+#define __ABOLLO_UTILITY_SPSC_QUEUE_H__
+
+
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "Utility/NonCopyable.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Head and tail are only ever written by one side each, so a push or a pop costs one acquire load and one release store.
+template <typename T, size_t Capacity>
+class SpscQueue final : private internal::NonCopyable
+{
+private:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2.");
+    static_assert(std::is_trivially_copyable_v<T>, "Elements are copied in and out of the ring.");
+
+    constexpr static size_t MASK            = Capacity - 1;
+    constexpr static size_t CACHE_LINE_SIZE = 64;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mHead{0};    // Next slot to pop, written by the consumer.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mTail{0};    // Next slot to push, written by the producer.
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> mSlots;
+
+public:
+    SpscQueue() = default;
+
+    // Producer side. Returns false if the queue is full.
+    bool TryPush(const T& aValue)
+    {
+        const auto lTail = mTail.load(std::memory_order_relaxed);
+
+        if (lTail - mHead.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        mSlots[lTail & MASK] = aValue;
+        mTail.store(lTail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer side. Returns an empty optional if the queue is empty.
+    std::optional<T> TryPop()
+    {
+        const auto lHead = mHead.load(std::memory_order_relaxed);
+
+        if (lHead == mTail.load(std::memory_order_acquire))
+            return std::nullopt;
+
+        const auto lValue = mSlots[lHead & MASK];
+        mHead.store(lHead + 1, std::memory_order_release);
+
+        return lValue;
+    }
+
+    [[nodiscard]] bool Empty() const
+    {
+        return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] constexpr static size_t capacity()
+    {
+        return Capacity;
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_UTILITY_SPSC_QUEUE_H__
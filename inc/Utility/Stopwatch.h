@@ -0,0 +1,63 @@
+#ifndef __ABOLLO_UTILITY_STOPWATCH_H__
+#define __ABOLLO_UTILITY_STOPWATCH_H__
+
+
+
+#include <chrono>
+#include <utility>
+
+
+
+namespace abollo
+{
+
+
+
+class Stopwatch final
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point mStart{Clock::now()};
+
+public:
+    void Reset()
+    {
+        mStart = Clock::now();
+    }
+
+    // Elapsed time in milliseconds since construction or the last Reset().
+    [[nodiscard]] double Elapsed() const
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - mStart).count();
+    }
+
+    // Elapsed time in milliseconds, restarting the stopwatch.
+    double Lap()
+    {
+        const auto lNow     = Clock::now();
+        const auto lElapsed = std::chrono::duration<double, std::milli>(lNow - mStart).count();
+
+        mStart = lNow;
+
+        return lElapsed;
+    }
+
+    template <typename Op, typename... Args>
+    static double Measure(Op&& aOp, Args&&... aArgs)
+    {
+        const Stopwatch lStopwatch;
+
+        std::forward<Op>(aOp)(std::forward<Args>(aArgs)...);
+
+        return lStopwatch.Elapsed();
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_UTILITY_STOPWATCH_H__
@@ -0,0 +1,154 @@
+#ifndef __ABOLLO_UTILITY_TASK_GRAPH_H__
+#define __ABOLLO_UTILITY_TASK_GRAPH_H__
+
+
+
+#include <deque>
+#include <future>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Utility/NonCopyable.h"
+#include "Utility/Stopwatch.h"
+
+
+
+namespace abollo
+{
+
+
+
+// A minimal dependency graph of one-shot tasks. Spawned tasks run on their own thread as soon as their dependencies have finished,
+// Run() executes on the calling thread. Every task is timed relative to the construction of the graph.
+class TaskGraph final : private internal::NonCopyable
+{
+public:
+    using TaskId = size_t;
+
+private:
+    struct Task
+    {
+        std::string name;
+        bool onCaller{false};
+
+        double start{0.0};
+        double elapsed{0.0};
+
+        std::shared_future<void> future;
+    };
+
+    Stopwatch mStopwatch;
+    std::deque<Task> mTasks;    // Tasks are filled in by their own thread, so the elements must not move.
+
+    class Scope final
+    {
+    private:
+        const Stopwatch& mStopwatch;
+        Task& mTask;
+
+    public:
+        Scope(const Stopwatch& aStopwatch, Task& aTask) : mStopwatch{aStopwatch}, mTask{aTask}
+        {
+            mTask.start = mStopwatch.Elapsed();
+        }
+
+        ~Scope()
+        {
+            mTask.elapsed = mStopwatch.Elapsed() - mTask.start;
+        }
+    };
+
+public:
+    TaskGraph() = default;
+
+    ~TaskGraph()
+    {
+        for (const auto& lTask : mTasks)
+            if (lTask.future.valid())
+                lTask.future.wait();
+    }
+
+    template <typename Op>
+    TaskId Spawn(std::string aName, const std::initializer_list<TaskId> aDependencies, Op&& aOp)
+    {
+        std::vector<std::shared_future<void>> lDependencies;
+
+        for (const auto lId : aDependencies)
+            lDependencies.push_back(mTasks.at(lId).future);
+
+        auto& lTask = mTasks.emplace_back();
+        lTask.name  = std::move(aName);
+
+        lTask.future = std::async(std::launch::async, [this, &lTask, lDependencies = std::move(lDependencies), lOp = std::forward<Op>(aOp)]() mutable {
+                           for (const auto& lDependency : lDependencies)
+                               lDependency.get();    // Rethrow the failure of a dependency.
+
+                           const Scope lScope{mStopwatch, lTask};
+
+                           lOp();
+                       }).share();
+
+        return mTasks.size() - 1;
+    }
+
+    template <typename Op>
+    decltype(auto) Run(std::string aName, Op&& aOp)
+    {
+        auto& lTask    = mTasks.emplace_back();
+        lTask.name     = std::move(aName);
+        lTask.onCaller = true;
+
+        const Scope lScope{mStopwatch, lTask};
+
+        return std::forward<Op>(aOp)();
+    }
+
+    // Block until the task has finished, rethrowing its exception if it failed.
+    void Wait(const TaskId aId) const
+    {
+        if (const auto& lFuture = mTasks.at(aId).future; lFuture.valid())
+            lFuture.get();
+    }
+
+    template <typename... Ids>
+    void Wait(const TaskId aId, const Ids... aIds) const
+    {
+        Wait(aId);
+        (Wait(aIds), ...);
+    }
+
+    [[nodiscard]] double Elapsed() const
+    {
+        return mStopwatch.Elapsed();
+    }
+
+    void Report(std::ostream& aStream) const
+    {
+        aStream << fmt::format("{:<32}{:>8}{:>12}{:>12}{:>12}\n", "phase", "thread", "start(ms)", "end(ms)", "took(ms)");
+
+        for (const auto& lTask : mTasks)
+        {
+            if (lTask.future.valid())
+                lTask.future.wait();
+
+            aStream << fmt::format("{:<32}{:>8}{:>12.2f}{:>12.2f}{:>12.2f}\n", lTask.name, lTask.onCaller ? "caller" : "worker", lTask.start, lTask.start + lTask.elapsed,
+                                   lTask.elapsed);
+        }
+
+        aStream << fmt::format("{:<32}{:>8}{:>12}{:>12.2f}\n", "total", "", "", mStopwatch.Elapsed());
+        aStream.flush();
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_UTILITY_TASK_GRAPH_H__
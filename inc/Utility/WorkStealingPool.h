@@ -0,0 +1,202 @@
+#ifndef __ABOLLO_UTILITY_WORK_STEALING_POOL_H__
+#define __ABOLLO_UTILITY_WORK_STEALING_POOL_H__
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Utility/NonCopyable.h"
+#include "Utility/Singleton.h"
+
+
+
+namespace abollo
+{
+
+
+
+// Fixed set of threads running the iterations of ForEach. The range is cut into chunks dealt round-robin to one deque per worker,
+// a worker takes its own chunks from the back and, once it runs dry, steals from the front of the others, so uneven iterations
+// still keep every core busy. The calling thread is the last worker and takes part until the whole range is done.
+// Every iteration receives the index of the worker running it, which callers use to keep per-thread scratch buffers.
+class WorkStealingPool final : private internal::Singleton<WorkStealingPool>
+{
+private:
+    using Chunk = std::pair<size_t, size_t>;
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;    // One more than mThreads, the last one belongs to the caller of ForEach.
+    std::vector<std::thread> mThreads;
+
+    std::mutex mForEachMutex;    // ForEach calls from different threads run one after the other.
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::condition_variable mDone;
+    uint64_t mGeneration{0};
+    bool mStopping{false};
+
+    const std::function<void(size_t, size_t)>* mpOp{nullptr};
+    std::atomic<size_t> mRemaining{0};
+
+    [[nodiscard]] std::optional<Chunk> Pop(const size_t aWorker)
+    {
+        auto& lWorker = *mWorkers[aWorker];
+
+        {
+            const std::lock_guard lLock{lWorker.mutex};
+
+            if (!lWorker.chunks.empty())
+            {
+                const auto lChunk = lWorker.chunks.back();
+                lWorker.chunks.pop_back();
+
+                return lChunk;
+            }
+        }
+
+        for (size_t i = 1; i < mWorkers.size(); ++i)
+        {
+            auto& lVictim = *mWorkers[(aWorker + i) % mWorkers.size()];
+
+            const std::lock_guard lLock{lVictim.mutex};
+
+            if (!lVictim.chunks.empty())
+            {
+                const auto lChunk = lVictim.chunks.front();
+                lVictim.chunks.pop_front();
+
+                return lChunk;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void Drain(const size_t aWorker)
+    {
+        while (const auto lChunk = Pop(aWorker))
+        {
+            for (auto i = lChunk->first; i < lChunk->second; ++i)
+                (*mpOp)(i, aWorker);
+
+            if (mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                const std::lock_guard lLock{mMutex};
+                mDone.notify_all();
+            }
+        }
+    }
+
+    void Run(const size_t aWorker)
+    {
+        for (uint64_t lGeneration = 0;;)
+        {
+            {
+                std::unique_lock lLock{mMutex};
+                mWakeUp.wait(lLock, [this, lGeneration] { return mStopping || mGeneration != lGeneration; });
+
+                if (mStopping)
+                    return;
+
+                lGeneration = mGeneration;
+            }
+
+            Drain(aWorker);
+        }
+    }
+
+public:
+    using Singleton<WorkStealingPool>::Instance;
+
+    explicit WorkStealingPool(const size_t aThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1)
+    {
+        for (size_t i = 0; i <= aThreads; ++i)
+            mWorkers.push_back(std::make_unique<Worker>());
+
+        for (size_t i = 0; i < aThreads; ++i)
+            mThreads.emplace_back(&WorkStealingPool::Run, this, i);
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            const std::lock_guard lLock{mMutex};
+            mStopping = true;
+        }
+
+        mWakeUp.notify_all();
+
+        for (auto& lThread : mThreads)
+            lThread.join();
+    }
+
+    // Number of distinct worker indices passed to the iterations, the size of a per-thread scratch array.
+    [[nodiscard]] size_t WorkerCount() const
+    {
+        return mWorkers.size();
+    }
+
+    // Call aOp(i, worker) for every i in [0, aCount), aGrain iterations per chunk. Returns once every iteration has run.
+    // aOp must not call ForEach.
+    void ForEach(const size_t aCount, const size_t aGrain, const std::function<void(size_t, size_t)>& aOp)
+    {
+        if (aCount == 0)
+            return;
+
+        const std::lock_guard lForEachLock{mForEachMutex};
+
+        const auto lGrain  = std::max<size_t>(aGrain, 1);
+        const auto lChunks = (aCount + lGrain - 1) / lGrain;
+        const auto lCaller = mWorkers.size() - 1;
+
+        mpOp = &aOp;
+        mRemaining.store(lChunks, std::memory_order_release);
+
+        for (size_t i = 0; i < lChunks; ++i)
+        {
+            auto& lWorker = *mWorkers[i % mWorkers.size()];
+
+            const std::lock_guard lLock{lWorker.mutex};
+            lWorker.chunks.emplace_back(i * lGrain, std::min(aCount, (i + 1) * lGrain));
+        }
+
+        {
+            const std::lock_guard lLock{mMutex};
+            ++mGeneration;
+        }
+
+        mWakeUp.notify_all();
+
+        Drain(lCaller);
+
+        std::unique_lock lLock{mMutex};
+        mDone.wait(lLock, [this] { return mRemaining.load(std::memory_order_acquire) == 0; });
+
+        mpOp = nullptr;
+    }
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_UTILITY_WORK_STEALING_POOL_H__
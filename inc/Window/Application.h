@@ -3,13 +3,19 @@
 
 
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
-#include <unordered_map>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <SDL2/SDL.h>
 
 #include "Utility/Singleton.h"
+#include "Window/WindowWorker.h"
 
 
 
@@ -68,13 +74,59 @@ enum class CursorType : Uint8
 class Application final : private internal::Singleton<Application>
 {
 private:
-    std::unordered_map<Uint32, const EventDispatcher&> mEventDispatchers;
-    std::unique_ptr<SDL_Cursor, decltype(&SDL_FreeCursor)> mCursor;
+    constexpr static Uint32 OVERFLOW_RETRY_INTERVAL = 1;    // ms
+
+    struct Route
+    {
+        Uint32 windowId;
+        const EventDispatcher* pEventDispatcher;
+        std::unique_ptr<WindowWorker> pWorker;    // Null if the handlers run on the SDL thread.
+    };
+
+    std::vector<Route> mRoutes;    // Flat map sorted by window id, there are only ever a handful of windows.
+
+    const std::thread::id mThreadId;    // Of the SDL thread, which owns the windows and their message queues.
+    const Uint32 mTaskEvent;            // Wakes the SDL thread up for the tasks posted by other threads.
+
+    std::mutex mTaskMutex;
+    std::vector<std::function<void()>> mTasks;    // Guarded by mTaskMutex.
+    bool mAcceptingTasks{true};                   // Guarded by mTaskMutex, false once the event loop is over.
+
+    std::unique_ptr<SDL_Cursor, decltype(&SDL_FreeCursor)> mCursor;    // Only touched on the SDL thread.
+
+    [[nodiscard]] auto Find(const Uint32 aWindowId) const
+    {
+        const auto lRoute = std::lower_bound(mRoutes.cbegin(), mRoutes.cend(), aWindowId, [](const Route& aRoute, const Uint32 aId) { return aRoute.windowId < aId; });
+
+        return lRoute != mRoutes.cend() && lRoute->windowId == aWindowId ? lRoute : mRoutes.cend();
+    }
+
+    bool Insert(Route&& aRoute)
+    {
+        const auto lRoute =
+            std::lower_bound(mRoutes.cbegin(), mRoutes.cend(), aRoute.windowId, [](const Route& aExisting, const Uint32 aId) { return aExisting.windowId < aId; });
+
+        if (lRoute != mRoutes.cend() && lRoute->windowId == aRoute.windowId)
+            return false;
+
+        mRoutes.insert(lRoute, std::move(aRoute));
+
+        return true;
+    }
+
+    [[nodiscard]] std::vector<std::function<void()>> TakeTasks()
+    {
+        const std::lock_guard lLock{mTaskMutex};
+
+        return std::exchange(mTasks, {});
+    }
 
 public:
     using Singleton<Application>::Instance;
 
-    explicit Application(const SubSystem& aFlags) : mCursor(nullptr, &SDL_FreeCursor)
+    // Must be constructed on the thread that runs the event loop.
+    explicit Application(const SubSystem& aFlags)
+        : mThreadId{std::this_thread::get_id()}, mTaskEvent{SDL_RegisterEvents(1)}, mCursor(nullptr, &SDL_FreeCursor)
     {
         if (const auto lRet = SDL_Init(static_cast<Uint32>(aFlags)); lRet != 0)
             throw std::runtime_error("Failed to initialize SDL subsystems.");
@@ -82,23 +134,46 @@ public:
 
     ~Application()
     {
+        mRoutes.clear();
+
         SDL_Quit();
     }
 
-    void Run() const;
+    void Run();
 
-    auto Bind(const Uint32 aWindowId, const EventDispatcher& aEventDispatcher)
+    // The handlers of the window run on the SDL thread.
+    bool Bind(const Uint32 aWindowId, const EventDispatcher& aEventDispatcher)
     {
-        return mEventDispatchers.try_emplace(aWindowId, aEventDispatcher);
+        return Insert({aWindowId, &aEventDispatcher, nullptr});
     }
 
+    // The handlers of the window run on a thread of its own, fed through a lock-free queue.
+    bool BindAsync(const Uint32 aWindowId, const EventDispatcher& aEventDispatcher)
+    {
+        if (Find(aWindowId) != mRoutes.cend())
+            return false;
+
+        return Insert({aWindowId, &aEventDispatcher, std::make_unique<WindowWorker>(aEventDispatcher)});
+    }
+
+    // Run aTask on the SDL thread, from any thread, without waiting for it. Returns false once the event loop is over, the task is
+    // dropped then.
+    bool Post(std::function<void()> aTask);
+
+    // Run aTask on the SDL thread and wait for it, in place if called from the SDL thread. Windows are only resized, queried or given
+    // a cursor from there: on Win32 those calls only take effect on the thread that owns the message queue of the window.
+    void Invoke(std::function<void()> aTask);
+
+    // May be called from the render thread of any window.
     void SetCursor(const CursorType aCursorType)
     {
         using Underlying = std::underlying_type_t<CursorType>;
 
-        mCursor.reset(SDL_CreateSystemCursor(static_cast<SDL_SystemCursor>(static_cast<Underlying>(aCursorType))));
+        Post([this, aCursorType] {
+            mCursor.reset(SDL_CreateSystemCursor(static_cast<SDL_SystemCursor>(static_cast<Underlying>(aCursorType))));
 
-        SDL_SetCursor(mCursor.get());
+            SDL_SetCursor(mCursor.get());
+        });
     }
 
     [[maybe_unused]] static bool ShowCursor()
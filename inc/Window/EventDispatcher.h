@@ -23,6 +23,70 @@ public:
 
     virtual void OnKeyDownEvent(const SDL_KeyboardEvent& aEvent) const = 0;
     virtual void OnKeyUpEvent(const SDL_KeyboardEvent& aEvent) const   = 0;
+
+    void Dispatch(const SDL_Event& aEvent) const
+    {
+        switch (aEvent.type)
+        {
+        case SDL_WINDOWEVENT:
+            OnWindowEvent(aEvent.window);
+            break;
+
+        case SDL_MOUSEMOTION:
+            OnMouseMotionEvent(aEvent.motion);
+            break;
+
+        case SDL_MOUSEBUTTONDOWN:
+            OnMouseButtonDownEvent(aEvent.button);
+            break;
+
+        case SDL_MOUSEBUTTONUP:
+            OnMouseButtonUpEvent(aEvent.button);
+            break;
+
+        case SDL_MOUSEWHEEL:
+            OnMouseWheelEvent(aEvent.wheel);
+            break;
+
+        case SDL_KEYDOWN:
+            OnKeyDownEvent(aEvent.key);
+            break;
+
+        case SDL_KEYUP:
+            OnKeyUpEvent(aEvent.key);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Id of the window an event is targeted at, 0 if the event is not bound to a window.
+    static Uint32 GetWindowId(const SDL_Event& aEvent)
+    {
+        switch (aEvent.type)
+        {
+        case SDL_WINDOWEVENT:
+            return aEvent.window.windowID;
+
+        case SDL_MOUSEMOTION:
+            return aEvent.motion.windowID;
+
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            return aEvent.button.windowID;
+
+        case SDL_MOUSEWHEEL:
+            return aEvent.wheel.windowID;
+
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            return aEvent.key.windowID;
+
+        default:
+            return 0;
+        }
+    }
 };
 
 
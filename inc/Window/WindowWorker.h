@@ -0,0 +1,66 @@
+#ifndef __ABOLLO_WINDOW_WINDOW_WORKER_H__
+#define __ABOLLO_WINDOW_WINDOW_WORKER_H__
+
+
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+
+#include <SDL2/SDL.h>
+
+#include "Utility/NonCopyable.h"
+#include "Utility/SpscQueue.h"
+
+
+
+namespace abollo
+{
+
+
+
+class EventDispatcher;
+
+
+
+// Runs the handlers of one window on a dedicated thread. The SDL thread is the only producer and the worker the only consumer of
+// the event queue, so a window busy repainting only delays its own events.
+class WindowWorker final : private internal::NonCopyable
+{
+private:
+    constexpr static size_t EVENT_QUEUE_CAPACITY = 1024;
+
+    const EventDispatcher& mEventDispatcher;
+
+    SpscQueue<SDL_Event, EVENT_QUEUE_CAPACITY> mEvents;
+    std::deque<SDL_Event> mOverflow;    // Owned by the producer, holds events while the queue is full instead of blocking the SDL thread.
+
+    std::unique_ptr<SDL_sem, decltype(&SDL_DestroySemaphore)> mSignal;
+    std::atomic<bool> mRunning{true};
+
+    std::thread mThread;
+
+    void Run();
+
+public:
+    explicit WindowWorker(const EventDispatcher& aEventDispatcher);
+    ~WindowWorker();
+
+    // Producer side, must only be called from the SDL thread.
+    void Post(const SDL_Event& aEvent);
+
+    // Move the events held back while the queue was full into the queue. Returns true once nothing is held back.
+    bool Flush();
+
+    // Let the worker finish the events already queued and join it.
+    void Stop();
+};
+
+
+
+}    // namespace abollo
+
+
+
+#endif    // __ABOLLO_WINDOW_WINDOW_WORKER_H__
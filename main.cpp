@@ -4,7 +4,19 @@
 // #include <cstdlib>
 // #endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <date/date.h>
 #include <fmt/format.h>
@@ -13,6 +25,14 @@
 
 #include "Graphics/VulkanContext.h"
 #include "Market/MarketCanvas.h"
+#include "Market/Model/CorrelationMatrix.h"
+#include "Market/Model/DataLoader.h"
+#include "Market/Model/PatternScanner.h"
+#include "Market/Model/QueryProfiler.h"
+#include "Market/Model/Screener.h"
+#include "Utility/Stopwatch.h"
+#include "Utility/TaskGraph.h"
+#include "Utility/WorkStealingPool.h"
 #include "Window/Application.h"
 #include "Window/Event.h"
 #include "Window/EventSlot.h"
@@ -21,35 +41,271 @@
 
 
 using abollo::Application;
+using abollo::AxisPainter;
+using abollo::BarInterval;
+using abollo::CorrelationMatrix;
 using abollo::CursorType;
+using abollo::DataAnalyzer;
+using abollo::DataLoader;
 using abollo::Event;
+using abollo::JoinSeries;
 using abollo::Key;
 using abollo::KeyEvent;
 using abollo::MarketCanvas;
 using abollo::MouseEvent;
 using abollo::MouseMask;
+using abollo::Painter;
+using abollo::PatternScanner;
+using abollo::QueryProfiler;
+using abollo::ReplayEngine;
+using abollo::Screen;
+using abollo::ScreenUniverse;
+using abollo::Stopwatch;
 using abollo::SubSystem;
+using abollo::TaskGraph;
 using abollo::VulkanContext;
 using abollo::Window;
 using abollo::WindowEvent;
+using abollo::WorkStealingPool;
 
 
 
-int main(int /*argc*/, char* /*argv*/[])
+namespace
+{
+
+
+
+using ChartEvents = Event<MouseEvent::eLButtonDown, MouseEvent::eLButtonUp, MouseEvent::eRButtonDown, MouseEvent::eRButtonUp, MouseEvent::eMotion, MouseEvent::eWheel,
+                          KeyEvent::eDown, KeyEvent::eUp, WindowEvent::eShown, WindowEvent::eExposed, WindowEvent::eMoved, WindowEvent::eResized,
+                          WindowEvent::eSizeChanged, WindowEvent::eEnter, WindowEvent::eLeave>;
+
+
+// Replay of the latest bars of the charted code, see MarketCanvas::StartReplay.
+constexpr auto REPLAY_CODE             = "000905.SH";
+constexpr uint32_t REPLAY_BARS         = 1024;
+constexpr uint32_t REPLAY_WARM_UP      = 120;
+constexpr double REPLAY_SPEED_FACTOR   = 10.;    // Plus and minus multiply or divide the speed by it.
+constexpr double REPLAY_MAX_SPEED      = 1000.;
+constexpr Uint32 REPLAY_FRAME_INTERVAL = 16;    // ms
+
+// Series of the charted code against RELATIVE_BASE_CODE, see MarketCanvas::ShowRelative.
+constexpr auto RELATIVE_BASE_CODE    = "000300.SH";
+constexpr uint32_t RELATIVE_BARS     = 1024;
+constexpr std::array RELATIVE_SERIES = {JoinSeries::eSpread, JoinSeries::eRatio, JoinSeries::eRebased};
+
+// Moving average crossovers swept on the charted code, see MarketCanvas::ShowBacktest.
+constexpr uint32_t BACKTEST_MIN_PERIOD = 2;
+constexpr uint32_t BACKTEST_MAX_PERIOD = 120;
+constexpr uint32_t BACKTEST_BARS       = 1024;
+
+// Periods of the SMA, EMA and Bollinger bands drawn over the candles, I cycles through them.
+constexpr std::array INDICATOR_PERIODS = {20u, 60u, 120u};
+
+// Correlations of the daily returns of every code, C loads them, then slides them to the latest date stored, see CorrelationMatrix.
+constexpr uint32_t CORRELATION_DAYS = 250;
+constexpr auto CORRELATION_FILE     = "data/correlation.bin";
+constexpr size_t CORRELATION_PEERS  = 5;    // Codes listed as the closest to the charted one.
+
+// Candlestick patterns of every code on the latest date, see PatternScanner. Named in the order of CandlePattern.
+constexpr std::array<const char*, abollo::PATTERN_COUNT> PATTERN_NAMES = {"doji",         "hammer",     "bullish engulfing", "bearish engulfing",
+                                                                          "morning star", "inside bar", "gap up",            "gap down"};
+
+// Screens of every code, S runs the next one, see Screen. The universe is loaded once, deep enough for all of them, and every screen
+// then only runs over memory.
+constexpr uint32_t SCREEN_DAYS = 250;
+constexpr std::array SCREENS   = {"close > sma(close, 200) and rsi(14) < 30 and volume > 2 * avg(volume, 20) rank by volume / avg(volume, 20) desc limit 20",
+                                "close >= max(close, 60) and vol(20) < 0.3 rank by close / ref(close, 20) desc limit 20",
+                                "zscore(20) < -2 or drawdown(120) < -0.3 rank by zscore(20) asc limit 20"};
+
+// Ticks aggregated into the intraday bars, T starts and stops them and D charts them, see MarketCanvas::StartTickReplay.
+constexpr auto TICK_FILE    = "ticks.csv";
+constexpr double TICK_SPEED = 60.;    // An hour of ticks a minute.
+
+
+
+// Everything one window owns. After startup all of it is only touched by the render thread of the window.
+struct ChartWindow
+{
+    std::unique_ptr<DataAnalyzer> pDataAnalyzer;
+    std::unique_ptr<Painter> pMarketPainter;
+    std::unique_ptr<AxisPainter> pAxisPainter;
+
+    std::optional<Window> window;
+    ChartEvents events;
+    std::optional<VulkanContext> vulkanContext;
+    std::optional<MarketCanvas> marketCanvas;
+
+    // Set by the render thread while a replay plays or ticks stream in, the frame timer only asks for frames then, one at a time.
+    std::atomic<bool> playing{false};
+    std::atomic<bool> framePending{false};
+    SDL_TimerID frameTimer{0};
+
+    uint8_t series{0};    // Charted series, J cycles through the code itself and RELATIVE_SERIES.
+    uint8_t period{0};    // Index in INDICATOR_PERIODS.
+    uint8_t bars{0};      // Charted bars, D cycles through the daily candles and the intraday bars of every BarInterval.
+
+    std::optional<DataLoader> dataLoader;    // Reads every code, opened by the first key that needs it.
+    std::optional<CorrelationMatrix> correlations;
+    std::optional<ScreenUniverse> universe;
+    uint8_t screen{0};    // Index in SCREENS of the next screen.
+
+    DataLoader& GetDataLoader()
+    {
+        if (!dataLoader)
+            dataLoader.emplace();
+
+        return *dataLoader;
+    }
+
+    void UpdatePlaying()
+    {
+        const auto* lpReplay = marketCanvas->Replay();
+
+        playing.store((lpReplay && !lpReplay->Paused() && !lpReplay->Finished()) || marketCanvas->Streaming(), std::memory_order_relaxed);
+    }
+
+    void Repaint()
+    {
+        if (const auto lBackBuffer = vulkanContext->GetBackBufferSurface(); lBackBuffer)
+        {
+            marketCanvas->Paint(lBackBuffer.get());
+            lBackBuffer->flush();
+            vulkanContext->SwapBuffers();
+        }
+    }
+};
+
+
+
+// Runs on the SDL timer thread. Frames are requested as expose events, handled on the render thread like any other event.
+Uint32 RequestFrame(const Uint32 aInterval, void* apChart)
 {
-    auto& lApp = Application::Instance(SubSystem::eVideo);
-    const Window lWindow{"Hello World", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 768, SDL_WINDOW_RESIZABLE | SDL_WINDOW_VULKAN};
+    auto& lChart = *static_cast<ChartWindow*>(apChart);
+
+    if (lChart.playing.load(std::memory_order_relaxed) && !lChart.framePending.exchange(true, std::memory_order_relaxed))
+    {
+        SDL_Event lEvent{};
+        lEvent.type            = SDL_WINDOWEVENT;
+        lEvent.window.event    = SDL_WINDOWEVENT_EXPOSED;
+        lEvent.window.windowID = lChart.window->GetWindowId();
+
+        SDL_PushEvent(&lEvent);
+    }
+
+    return aInterval;
+}
+
+
+// SDL only reads and warps the mouse on the thread that owns the video subsystem, the key handlers run on the render thread.
+void NudgeMouse(Application& aApp, const Window& aWindow, const int aDeltaX, const int aDeltaY)
+{
+    aApp.Invoke([&aWindow, aDeltaX, aDeltaY] {
+        int x, y;
+        SDL_GetMouseState(&x, &y);
+
+        SDL_WarpMouseInWindow(aWindow.GetHandle(), x + aDeltaX, y + aDeltaY);
+    });
+}
+
+
+// Load the correlations on the first call and append the dates stored since on the next ones, then save and store them and list the
+// codes whose returns follow aCode the most.
+void UpdateCorrelations(ChartWindow& aChart, const std::string& aCode)
+{
+    auto& lDataLoader = aChart.GetDataLoader();
+
+    Stopwatch lStopwatch;
+    auto lDates = CORRELATION_DAYS;
+
+    if (aChart.correlations)
+        lDates = aChart.correlations->Update(lDataLoader);
+    else
+        aChart.correlations.emplace(CorrelationMatrix::Load(lDataLoader, CORRELATION_DAYS));
+
+    const auto lUpdateMs = lStopwatch.Lap();
+    const auto& lMatrix  = *aChart.correlations;
+
+    if (!lMatrix.Save(CORRELATION_FILE))
+        std::cerr << fmt::format("Failed to save the correlations to {}\n", CORRELATION_FILE);
+
+    lMatrix.Store(lDataLoader);
 
-    Event<MouseEvent::eLButtonDown, MouseEvent::eLButtonUp, MouseEvent::eRButtonDown, MouseEvent::eRButtonUp, MouseEvent::eMotion, MouseEvent::eWheel, KeyEvent::eDown,
-          KeyEvent::eUp, WindowEvent::eShown, WindowEvent::eMoved, WindowEvent::eResized, WindowEvent::eSizeChanged, WindowEvent::eEnter, WindowEvent::eLeave>
-        lEvents;
+    std::cout << fmt::format("Correlations of {} codes over {} days: {} dates in {:.1f} ms, saved and stored in {:.1f} ms\n", lMatrix.Count(), lMatrix.Days(), lDates,
+                             lUpdateMs, lStopwatch.Lap());
 
-    lApp.Bind(lWindow.GetWindowId(), lEvents);
+    const auto& lCodes = lMatrix.Codes();
+    const auto lCode   = std::lower_bound(lCodes.cbegin(), lCodes.cend(), aCode);
 
-    VulkanContext lVulkanContext{lWindow, "Hello World", 1, "", 0};
+    if (lCode == lCodes.cend() || *lCode != aCode)
+        return;
 
-    const auto& lExtent = lVulkanContext.GetExtent();
-    MarketCanvas lMarketCanvas{lExtent.width, lExtent.height};
+    const auto lIndex = static_cast<size_t>(lCode - lCodes.cbegin());
+
+    std::vector<std::pair<float, size_t>> lPeers;
+
+    for (size_t j = 0; j < lCodes.size(); ++j)
+        if (const auto lCorrelation = lMatrix(lIndex, j); j != lIndex && !std::isnan(lCorrelation))
+            lPeers.emplace_back(lCorrelation, j);
+
+    const auto lCount = std::min(CORRELATION_PEERS, lPeers.size());
+    std::partial_sort(lPeers.begin(), lPeers.begin() + lCount, lPeers.end(), std::greater<>{});
+
+    for (size_t i = 0; i < lCount; ++i)
+        std::cout << fmt::format("    {} {:.3f}\n", lCodes[lPeers[i].second], lPeers[i].first);
+}
+
+
+// Scan every code for the patterns completed on the latest date and list them.
+void ScreenPatterns(ChartWindow& aChart)
+{
+    Stopwatch lStopwatch;
+
+    auto lScanner = PatternScanner::Load(aChart.GetDataLoader());
+    lScanner.Scan(WorkStealingPool::Instance());
+
+    const auto lMatches = lScanner.LatestMatches();
+
+    if (lScanner.Dates().empty())
+        return;
+
+    std::cout << fmt::format("Patterns of {} codes on {}: {} matches in {:.1f} ms\n", lScanner.Codes().size(), lScanner.Dates().back(), lMatches.size(),
+                             lStopwatch.Lap());
+
+    for (const auto& lMatch : lMatches)
+        std::cout << fmt::format("    {} {}\n", lMatch.code, PATTERN_NAMES[static_cast<size_t>(lMatch.pattern)]);
+}
+
+
+// Run the next of SCREENS over the universe, loaded on the first call, and list the results.
+void RunScreen(ChartWindow& aChart)
+{
+    const auto lText = SCREENS[aChart.screen];
+    aChart.screen    = static_cast<uint8_t>((aChart.screen + 1) % SCREENS.size());
+
+    Stopwatch lStopwatch;
+
+    if (!aChart.universe)
+        aChart.universe.emplace(ScreenUniverse::Load(aChart.GetDataLoader(), SCREEN_DAYS));
+
+    const auto lLoadMs = lStopwatch.Lap();
+
+    const auto lScreen  = Screen::Compile(lText);
+    const auto lResults = lScreen.Run(*aChart.universe, WorkStealingPool::Instance());
+
+    std::cout << fmt::format("{}\n{} of {} codes in {:.1f} ms (universe loaded in {:.1f} ms)\n", lText, lResults.size(), aChart.universe->Count(), lStopwatch.Lap(),
+                             lLoadMs);
+
+    for (const auto& lResult : lResults)
+        std::cout << fmt::format("    {} {:.3f}\n", lResult.code, lResult.score);
+}
+
+
+void BindHandlers(ChartWindow& aChart, Application& aApp)
+{
+    auto& lEvents        = aChart.events;
+    auto& lMarketCanvas  = *aChart.marketCanvas;
+    auto& lVulkanContext = *aChart.vulkanContext;
+    const auto& lWindow  = *aChart.window;
 
     lEvents.On<MouseEvent::eLButtonDown>([&lMarketCanvas](const Sint32 aPosX, const Sint32 aPosY) {
         // lMarketCanvas.ResetMode(CanvasMode::eTrendLine);
@@ -65,34 +321,29 @@ int main(int /*argc*/, char* /*argv*/[])
         lMarketCanvas.End(static_cast<SkScalar>(aPosX), static_cast<SkScalar>(aPosY));
     });
 
-    lEvents.On<MouseEvent::eRButtonDown>([&lApp](const Sint32 /*aPosX*/, const Sint32 /*aPosY*/) { lApp.SetCursor(CursorType::eHand); });
-    lEvents.On<MouseEvent::eRButtonUp>([&lApp](const Sint32 /*aPosX*/, const Sint32 /*aPosY*/) { lApp.SetCursor(CursorType::eArrow); });
+    lEvents.On<MouseEvent::eRButtonDown>([&aApp](const Sint32 /*aPosX*/, const Sint32 /*aPosY*/) { aApp.SetCursor(CursorType::eHand); });
+    lEvents.On<MouseEvent::eRButtonUp>([&aApp](const Sint32 /*aPosX*/, const Sint32 /*aPosY*/) { aApp.SetCursor(CursorType::eArrow); });
 
-    lEvents.On<WindowEvent::eShown>([&lVulkanContext, &lMarketCanvas] {
-        const auto lBackBuffer = lVulkanContext.GetBackBufferSurface();
+    lEvents.On<WindowEvent::eShown>([&aChart] { aChart.Repaint(); });
 
-        if (lBackBuffer)
-        {
-            lMarketCanvas.Paint(lBackBuffer.get());
-            lBackBuffer->flush();
-            lVulkanContext.SwapBuffers();
-        }
-    });
+    lEvents.On<WindowEvent::eExposed>([&aChart, &lMarketCanvas] {
+        aChart.framePending.store(false, std::memory_order_relaxed);
 
-    lEvents.On<WindowEvent::eResized>([&lVulkanContext, &lMarketCanvas](const Sint32 /*aWidth*/, const Sint32 /*aHeight*/) {
-        lVulkanContext.CreateSwapchain();
+        lMarketCanvas.Advance();
+        aChart.UpdatePlaying();
 
-        if (const auto lBackBuffer = lVulkanContext.GetBackBufferSurface(); lBackBuffer)
-        {
-            lMarketCanvas.Resize();
+        aChart.Repaint();
+    });
 
-            lMarketCanvas.Paint(lBackBuffer.get());
-            lBackBuffer->flush();
-            lVulkanContext.SwapBuffers();
-        }
+    // The swapchain queries the surface size of the window, which is only done on the SDL thread.
+    lEvents.On<WindowEvent::eResized>([&aChart, &aApp, &lVulkanContext, &lMarketCanvas](const Sint32 /*aWidth*/, const Sint32 /*aHeight*/) {
+        aApp.Invoke([&lVulkanContext] { lVulkanContext.CreateSwapchain(); });
+        lMarketCanvas.Resize();
+
+        aChart.Repaint();
     });
 
-    lEvents.On<MouseEvent::eMotion>([&lVulkanContext, &lMarketCanvas](const Sint32 aPosX, const Sint32 aPosY, const Sint32 aPosRelX, const Sint32 aPosRelY, const Uint32 aMask) {
+    lEvents.On<MouseEvent::eMotion>([&aChart, &lMarketCanvas](const Sint32 aPosX, const Sint32 aPosY, const Sint32 aPosRelX, const Sint32 aPosRelY, const Uint32 aMask) {
         lMarketCanvas.Pick(static_cast<SkScalar>(aPosX), static_cast<SkScalar>(aPosY));
 
         if ((aMask & MouseMask::eRight) == MouseMask::eRight)
@@ -102,30 +353,16 @@ int main(int /*argc*/, char* /*argv*/[])
         // else
         // return;
 
-        const auto lBackBuffer = lVulkanContext.GetBackBufferSurface();
-
-        if (lBackBuffer)
-        {
-            lMarketCanvas.Paint(lBackBuffer.get());
-            lBackBuffer->flush();
-            lVulkanContext.SwapBuffers();
-        }
+        aChart.Repaint();
     });
 
-    lEvents.On<MouseEvent::eWheel>([&lVulkanContext, &lMarketCanvas](const Sint32 aScrolledX, const Sint32 aScrolledY) {
+    lEvents.On<MouseEvent::eWheel>([&aChart, &lMarketCanvas](const Sint32 aScrolledX, const Sint32 aScrolledY) {
         lMarketCanvas.Zoom(static_cast<SkScalar>(aScrolledX), static_cast<SkScalar>(aScrolledY));
 
-        const auto lBackBuffer = lVulkanContext.GetBackBufferSurface();
-
-        if (lBackBuffer)
-        {
-            lMarketCanvas.Paint(lBackBuffer.get());
-            lBackBuffer->flush();
-            lVulkanContext.SwapBuffers();
-        }
+        aChart.Repaint();
     });
 
-    lEvents.On<KeyEvent::eDown>([&lVulkanContext, &lMarketCanvas, &lWindow](const Key aKey, const Uint16 /*aModifier*/) {
+    lEvents.On<KeyEvent::eDown>([&aChart, &aApp, &lMarketCanvas, &lWindow](const Key aKey, const Uint16 /*aModifier*/) {
         switch (aKey)
         {
             // case Key::ePrintScreen:
@@ -143,55 +380,252 @@ int main(int /*argc*/, char* /*argv*/[])
             lMarketCanvas.ResetMode<abollo::FibRetracement>();
             break;
 
-        case Key::eEsc:
-            // lMarketCanvas.Begin<abollo::fib_retracement_tag>();
-            lMarketCanvas.ResetMode();
+        case Key::eP:
+            QueryProfiler::Instance().Report(std::cout);
             break;
 
-        case Key::eLeft:
-        {
-            int x, y;
-            SDL_GetMouseState(&x, &y);
+        case Key::eR:
+            if (lMarketCanvas.Replay())
+                lMarketCanvas.StopReplay();
+            else
+                lMarketCanvas.StartReplay(REPLAY_CODE, REPLAY_BARS, REPLAY_WARM_UP);
 
-            SDL_WarpMouseInWindow(lWindow.GetHandle(), x - 1, y);
+            aChart.UpdatePlaying();
+            aChart.Repaint();
             break;
-        }
 
-        case Key::eRight:
-        {
-            int x, y;
-            SDL_GetMouseState(&x, &y);
+        case Key::eJ:
+            aChart.series = static_cast<uint8_t>((aChart.series + 1) % (RELATIVE_SERIES.size() + 1));
 
-            SDL_WarpMouseInWindow(lWindow.GetHandle(), x + 1, y);
+            if (aChart.series == 0)
+                lMarketCanvas.ShowIndex(REPLAY_CODE, RELATIVE_BARS);
+            else
+                lMarketCanvas.ShowRelative(RELATIVE_BASE_CODE, REPLAY_CODE, RELATIVE_SERIES[aChart.series - 1], RELATIVE_BARS);
 
+            aChart.UpdatePlaying();
+            aChart.Repaint();
             break;
-        }
 
-        case Key::eUp:
+        case Key::eD:
+            aChart.bars = static_cast<uint8_t>((aChart.bars + 1) % (abollo::BAR_INTERVAL_COUNT + 1));
+
+            if (aChart.bars == 0)
+                lMarketCanvas.ShowBars(std::nullopt);
+            else
+                lMarketCanvas.ShowBars(static_cast<BarInterval>(aChart.bars - 1));
+
+            aChart.Repaint();
+            break;
+
+        case Key::eI:
         {
-            int x, y;
-            SDL_GetMouseState(&x, &y);
+            aChart.period = static_cast<uint8_t>((aChart.period + 1) % INDICATOR_PERIODS.size());
+
+            auto lParameters            = lMarketCanvas.GetIndicatorParameters();
+            lParameters.smaPeriod       = INDICATOR_PERIODS[aChart.period];
+            lParameters.emaPeriod       = INDICATOR_PERIODS[aChart.period];
+            lParameters.bollingerPeriod = INDICATOR_PERIODS[aChart.period];
+
+            lMarketCanvas.SetIndicatorParameters(lParameters);
 
-            SDL_WarpMouseInWindow(lWindow.GetHandle(), x, y - 1);
+            aChart.Repaint();
             break;
         }
 
-        case Key::eDown:
+        case Key::eB:
         {
-            int x, y;
-            SDL_GetMouseState(&x, &y);
+            const auto lResult = lMarketCanvas.ShowBacktest(REPLAY_CODE, BACKTEST_MIN_PERIOD, BACKTEST_MAX_PERIOD, BACKTEST_BARS);
 
-            SDL_WarpMouseInWindow(lWindow.GetHandle(), x, y + 1);
+            std::cout << fmt::format("Crossover {}/{}: return {:.4f}, max drawdown {:.4f}, sharpe {:.2f}, turnover {:.1f}\n", lResult.fastPeriod, lResult.slowPeriod,
+                                     lResult.totalReturn, lResult.maxDrawdown, lResult.sharpe, lResult.turnover);
 
+            aChart.series = 0;
+            aChart.UpdatePlaying();
+            aChart.Repaint();
             break;
         }
 
+        case Key::eC:
+            try
+            {
+                UpdateCorrelations(aChart, REPLAY_CODE);
+            }
+            catch (const std::exception& aException)
+            {
+                std::cerr << aException.what() << std::endl;
+            }
+            break;
+
+        case Key::eK:
+            try
+            {
+                ScreenPatterns(aChart);
+            }
+            catch (const std::exception& aException)
+            {
+                std::cerr << aException.what() << std::endl;
+            }
+            break;
+
+        case Key::eS:
+            try
+            {
+                RunScreen(aChart);
+            }
+            catch (const std::exception& aException)
+            {
+                std::cerr << aException.what() << std::endl;
+            }
+            break;
+
+        case Key::eT:
+            if (lMarketCanvas.TickReplaying())
+            {
+                lMarketCanvas.StopTickReplay();
+
+                std::cout << fmt::format("Intraday bars: {} of 1 minute, {} of 5 minutes, {} of 15 minutes, {} of 60 minutes, {} daily\n",
+                                         lMarketCanvas.Bars(BarInterval::e1Minute).size(), lMarketCanvas.Bars(BarInterval::e5Minutes).size(),
+                                         lMarketCanvas.Bars(BarInterval::e15Minutes).size(), lMarketCanvas.Bars(BarInterval::e60Minutes).size(),
+                                         lMarketCanvas.Bars(BarInterval::eDaily).size());
+            }
+            else
+            {
+                try
+                {
+                    lMarketCanvas.StartTickReplay(TICK_FILE, TICK_SPEED);
+                }
+                catch (const std::exception& aException)
+                {
+                    std::cerr << aException.what() << std::endl;
+                }
+            }
+
+            aChart.UpdatePlaying();
+            break;
+
+        case Key::eSpace:
+            if (auto* lpReplay = lMarketCanvas.Replay(); lpReplay && lpReplay->Paused())
+                lpReplay->Resume();
+            else if (lpReplay)
+                lpReplay->Pause();
+
+            aChart.UpdatePlaying();
+            break;
+
+        case Key::eN:
+            lMarketCanvas.StepReplay();
+
+            aChart.UpdatePlaying();
+            aChart.Repaint();
+            break;
+
+        case Key::ePlus:
+        case Key::eEqual:
+            if (auto* lpReplay = lMarketCanvas.Replay())
+                lpReplay->SetSpeed(std::min(lpReplay->Speed() * REPLAY_SPEED_FACTOR, REPLAY_MAX_SPEED));
+            break;
+
+        case Key::eMinus:
+            if (auto* lpReplay = lMarketCanvas.Replay())
+                lpReplay->SetSpeed(std::max(lpReplay->Speed() / REPLAY_SPEED_FACTOR, ReplayEngine::DEFAULT_SPEED));
+            break;
+
+        case Key::eEsc:
+            // lMarketCanvas.Begin<abollo::fib_retracement_tag>();
+            lMarketCanvas.ResetMode();
+            break;
+
+        case Key::eLeft:
+            NudgeMouse(aApp, lWindow, -1, 0);
+            break;
+
+        case Key::eRight:
+            NudgeMouse(aApp, lWindow, 1, 0);
+            break;
+
+        case Key::eUp:
+            NudgeMouse(aApp, lWindow, 0, -1);
+            break;
+
+        case Key::eDown:
+            NudgeMouse(aApp, lWindow, 0, 1);
+            break;
+
         default:
             break;
         }
     });
+}
+
+
+
+}    // namespace
+
+
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+    std::vector<std::unique_ptr<ChartWindow>> lCharts;
+
+    TaskGraph lStartup;    // Declared after the task outputs, its destructor waits for the tasks still writing to them.
+
+    auto& lApp = lStartup.Run("SDL init", []() -> auto& { return Application::Instance(SubSystem::eVideo | SubSystem::eTimer); });
+
+    // One chart per display, each window gets its own GPU context and render thread so a heavy repaint never stalls the others.
+    const auto lWindowCount = std::max(SDL_GetNumVideoDisplays(), 1);
+    std::vector<TaskGraph::TaskId> lLoads;
+
+    for (auto i = 0; i < lWindowCount; ++i)
+    {
+        auto& lChart = *lCharts.emplace_back(std::make_unique<ChartWindow>());
+
+        // Neither the data nor the fonts depend on SDL or Vulkan, so they are loaded while the windows and the GPU contexts are set up.
+        lLoads.push_back(lStartup.Spawn(fmt::format("load market data #{}", i), {}, [&lChart] { lChart.pDataAnalyzer = MarketCanvas::LoadData(); }));
+        lLoads.push_back(lStartup.Spawn(fmt::format("typeface & glyph warm-up #{}", i), {},
+                                        [&lChart] { std::tie(lChart.pMarketPainter, lChart.pAxisPainter) = MarketCanvas::LoadPainters(); }));
+    }
+
+    for (auto i = 0; i < lWindowCount; ++i)
+    {
+        auto& lChart = *lCharts[i];
+
+        lStartup.Run(fmt::format("create window #{}", i), [&lChart, i] {
+            lChart.window.emplace("Hello World", SDL_WINDOWPOS_CENTERED_DISPLAY(i), SDL_WINDOWPOS_CENTERED_DISPLAY(i), 1024, 768, SDL_WINDOW_RESIZABLE | SDL_WINDOW_VULKAN);
+        });
+
+        lStartup.Run(fmt::format("GPU context & swapchain #{}", i), [&lChart] { lChart.vulkanContext.emplace(*lChart.window, "Hello World", 1, "", 0); });
+    }
+
+    lStartup.Run("wait for data & fonts", [&lStartup, &lLoads] {
+        for (const auto lLoad : lLoads)
+            lStartup.Wait(lLoad);
+    });
+
+    for (auto i = 0; i < lWindowCount; ++i)
+    {
+        auto& lChart = *lCharts[i];
+
+        lStartup.Run(fmt::format("layout #{}", i), [&lChart] {
+            const auto& lExtent = lChart.vulkanContext->GetExtent();
+            lChart.marketCanvas.emplace(lExtent.width, lExtent.height, std::move(lChart.pDataAnalyzer), std::move(lChart.pMarketPainter), std::move(lChart.pAxisPainter));
+        });
+
+        BindHandlers(lChart, lApp);
+
+        // The render thread only starts dispatching once lApp.Run() posts the first event, so the first frame can still be drawn from here.
+        lApp.BindAsync(lChart.window->GetWindowId(), lChart.events);
+
+        lStartup.Run(fmt::format("first frame #{}", i), [&lChart] { lChart.Repaint(); });
+
+        lChart.frameTimer = SDL_AddTimer(REPLAY_FRAME_INTERVAL, &RequestFrame, &lChart);
+    }
+
+    lStartup.Report(std::clog);
 
     lApp.Run();
 
+    for (const auto& lChart : lCharts)
+        SDL_RemoveTimer(lChart->frameTimer);
+
     return 0;
 }
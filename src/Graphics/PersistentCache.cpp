@@ -0,0 +1,208 @@
+#include "Graphics/PersistentCache.h"
+
+#include <fstream>
+#include <system_error>
+
+#include <fmt/format.h>
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+uint64_t HashKey(const std::string& aKey)    // FNV-1a
+{
+    uint64_t lHash = 0xCBF29CE484222325ull;
+
+    for (const auto lByte : aKey)
+    {
+        lHash ^= static_cast<uint8_t>(lByte);
+        lHash *= 0x100000001B3ull;
+    }
+
+    return lHash;
+}
+
+
+
+}    // namespace
+
+
+
+PersistentCache::PersistentCache(const std::filesystem::path& aRoot, const std::string_view aDeviceKey)
+    : mDirectory{aRoot / fmt::format("v{}", CACHE_VERSION) / std::string{aDeviceKey}}
+{
+    std::error_code lErrorCode;
+    std::filesystem::create_directories(mDirectory, lErrorCode);
+
+    ReadEntries();
+
+    mWriter = std::thread{&PersistentCache::WriteBack, this};
+}
+
+
+PersistentCache::~PersistentCache()
+{
+    {
+        std::lock_guard lLock{mMutex};
+        mStopping = true;
+    }
+
+    mPendingCondition.notify_one();
+    mWriter.join();
+}
+
+
+std::filesystem::path PersistentCache::EntryPath(const std::string& aKey) const
+{
+    return mDirectory / fmt::format("{:016x}.bin", HashKey(aKey));
+}
+
+
+void PersistentCache::ReadEntries()
+{
+    std::error_code lErrorCode;
+
+    for (const auto& lEntry : std::filesystem::directory_iterator{mDirectory, lErrorCode})
+    {
+        if (!lEntry.is_regular_file() || lEntry.path().extension() != ".bin")
+            continue;
+
+        std::ifstream lFile{lEntry.path(), std::ios::binary};
+
+        EntryHeader lHeader{};
+        lFile.read(reinterpret_cast<char*>(&lHeader), sizeof(lHeader));
+
+        const auto lValid = lFile && lHeader.magic == CACHE_MAGIC && lHeader.version == CACHE_VERSION &&
+                            sizeof(lHeader) + lHeader.keySize + lHeader.dataSize == lEntry.file_size(lErrorCode);
+
+        if (!lValid)
+        {
+            lFile.close();
+            std::filesystem::remove(lEntry.path(), lErrorCode);    // Stale or truncated, it will be rewritten on the next store.
+            continue;
+        }
+
+        std::string lKey(lHeader.keySize, '\0');
+        auto lData = SkData::MakeUninitialized(lHeader.dataSize);
+
+        lFile.read(lKey.data(), lHeader.keySize);
+        lFile.read(static_cast<char*>(lData->writable_data()), lHeader.dataSize);
+
+        if (lFile)
+            mEntries.insert_or_assign(std::move(lKey), std::move(lData));
+    }
+}
+
+
+void PersistentCache::WriteEntry(const std::string& aKey, const SkData& aData) const
+{
+    const auto lPath     = EntryPath(aKey);
+    const auto lTempPath = std::filesystem::path{lPath}.replace_extension(".tmp");
+
+    {
+        std::ofstream lFile{lTempPath, std::ios::binary | std::ios::trunc};
+
+        const EntryHeader lHeader{CACHE_MAGIC, CACHE_VERSION, static_cast<uint32_t>(aKey.size()), static_cast<uint32_t>(aData.size())};
+
+        lFile.write(reinterpret_cast<const char*>(&lHeader), sizeof(lHeader));
+        lFile.write(aKey.data(), aKey.size());
+        lFile.write(static_cast<const char*>(aData.data()), aData.size());
+
+        if (!lFile)
+            return;
+    }
+
+    // Readers never see a partially written entry.
+    std::error_code lErrorCode;
+    std::filesystem::rename(lTempPath, lPath, lErrorCode);
+}
+
+
+void PersistentCache::WriteBack()
+{
+    std::unique_lock lLock{mMutex};
+
+    for (;;)
+    {
+        mPendingCondition.wait(lLock, [this] { return mStopping || !mPendingWrites.empty(); });
+
+        if (mPendingWrites.empty())
+            break;
+
+        auto [lKey, lData] = std::move(mPendingWrites.front());
+        mPendingWrites.pop_front();
+        mWriting = true;
+
+        lLock.unlock();
+
+        WriteEntry(lKey, *lData);
+        ++mWrites;
+
+        lLock.lock();
+        mWriting = false;
+
+        if (mPendingWrites.empty())
+            mIdleCondition.notify_all();
+    }
+
+    mIdleCondition.notify_all();
+}
+
+
+sk_sp<SkData> PersistentCache::load(const SkData& aKey)
+{
+    const std::string lKey{static_cast<const char*>(aKey.data()), aKey.size()};
+
+    std::lock_guard lLock{mMutex};
+
+    if (const auto lEntry = mEntries.find(lKey); lEntry != mEntries.cend())
+    {
+        ++mHits;
+        return lEntry->second;
+    }
+
+    ++mMisses;
+    return nullptr;
+}
+
+
+void PersistentCache::store(const SkData& aKey, const SkData& aData)
+{
+    std::string lKey{static_cast<const char*>(aKey.data()), aKey.size()};
+    auto lData = SkData::MakeWithCopy(aData.data(), aData.size());
+
+    ++mStores;
+
+    {
+        std::lock_guard lLock{mMutex};
+
+        // Skia stores the pipeline cache blob on every request, skip the disk when nothing has changed.
+        if (const auto lEntry = mEntries.find(lKey); lEntry != mEntries.cend() && lEntry->second->equals(lData.get()))
+            return;
+
+        mEntries.insert_or_assign(lKey, lData);
+        mPendingWrites.emplace_back(std::move(lKey), std::move(lData));
+    }
+
+    mPendingCondition.notify_one();
+}
+
+
+void PersistentCache::Flush()
+{
+    std::unique_lock lLock{mMutex};
+
+    mIdleCondition.wait(lLock, [this] { return mStopping || (mPendingWrites.empty() && !mWriting); });
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <array>
 #include <cassert>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include <SDL2/SDL_vulkan.h>
@@ -130,6 +132,16 @@ VulkanContext::VulkanContext(const Window& aWindow, const std::string_view aAppN
                                              .fDeviceFeatures2    = nullptr,
                                              .fGetProc            = lGetProc};
 
+    // Shader modules and pipeline caches are only valid for the device and driver that produced them.
+    VkPhysicalDeviceIDProperties lIDProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES, .pNext = nullptr};
+    const auto lDeviceProperties = mPhysicalDevice.GetProperties(&lIDProperties);
+
+    mpPersistentCache = AcquirePersistentCache(
+        fmt::format("{:02x}-{:02x}-{:08x}", fmt::join(lIDProperties.deviceUUID, ""), fmt::join(lIDProperties.driverUUID, ""), lDeviceProperties.driverVersion));
+
+    mContextOptions.fPersistentCache     = mpPersistentCache.get();
+    mContextOptions.fShaderCacheStrategy = GrContextOptions::ShaderCacheStrategy::kBackendBinary;    // SPIR-V for the Vulkan backend.
+
     mContext = GrContext::MakeVulkan(lBackendContext, mContextOptions);
 
     CreateSwapchain();
@@ -146,6 +158,7 @@ VulkanContext::~VulkanContext()
 
     vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
 
+    StorePipelineCache();
     mContext.reset();
 
     // vkDestroyDevice(mDevice, nullptr);
@@ -153,6 +166,33 @@ VulkanContext::~VulkanContext()
 }
 
 
+std::shared_ptr<PersistentCache> VulkanContext::AcquirePersistentCache(const std::string& aDeviceKey)
+{
+    // Two caches on the same directory would overwrite each other's entries, windows on the same device share one instead.
+    static std::mutex sMutex;
+    static std::unordered_map<std::string, std::weak_ptr<PersistentCache>> sCaches;
+
+    std::lock_guard lLock{sMutex};
+
+    auto& lCache = sCaches[aDeviceKey];
+
+    if (auto lShared = lCache.lock())
+        return lShared;
+
+    auto lShared = std::make_shared<PersistentCache>(DEFAULT_CACHE_DIRECTORY, aDeviceKey);
+    lCache       = lShared;
+
+    return lShared;
+}
+
+
+void VulkanContext::StorePipelineCache()
+{
+    mContext->storeVkPipelineCacheData();
+    mpPersistentCache->Flush();
+}
+
+
 void VulkanContext::CreateSwapchain()
 {
     const auto& lSurfaceCapabilities = mPhysicalDevice.GetSurfaceCapabilities(mSurface);
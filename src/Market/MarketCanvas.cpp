@@ -1,7 +1,12 @@
 #include "Market/MarketCanvas.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <fstream>
+#include <iterator>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include <date/date.h>
@@ -13,6 +18,7 @@
 
 #include "Market/Model/ColumnTraits.h"
 #include "Market/Model/DataAnalyzer.h"
+#include "Utility/WorkStealingPool.h"
 
 
 
@@ -21,20 +27,61 @@ namespace abollo
 
 
 
-MarketCanvas::MarketCanvas(const uint32_t& aWidth, const uint32_t& aHeight) : mWidth{aWidth}, mHeight{aHeight}
+namespace
+{
+
+
+
+constexpr std::array OVERLAY_COLORS = {SkColorSetARGB(0xFF, 0xB5, 0x89, 0x00), SkColorSetARGB(0xFF, 0x26, 0x8B, 0xD2), SkColorSetARGB(0xA0, 0xEE, 0xE8, 0xD5),
+                                       SkColorSetARGB(0xA0, 0xEE, 0xE8, 0xD5), SkColorSetARGB(0x80, 0x2A, 0xA1, 0x98),
+                                       SkColorSetARGB(0x80, 0x2A, 0xA1, 0x98)};    // SMA, EMA, Bollinger bands, rolling high and low
+
+
+
+}    // namespace
+
+
+
+std::unique_ptr<DataAnalyzer> MarketCanvas::LoadData()
 {
     // using date::operator"" _y;
 
     // constexpr auto lStartDate{2019_y / 10 / 20}, lEndDate{2020_y / 1 / 1};
-    // mDataAnalyzer.LoadIndex("000905.SH", lStartDate, lEndDate);
+    // lpDataAnalyzer->LoadIndex("000905.SH", lStartDate, lEndDate);
 
-    std::tie(mStartSeq, mEndSeq) = mDataAnalyzer.LoadIndex("000905.SH", 0, 1024);
+    auto lpDataAnalyzer = std::make_unique<DataAnalyzer>();
+    lpDataAnalyzer->LoadIndex("000905.SH", 0, 1024);
 
-    Resize();
+    return lpDataAnalyzer;
+}
+
+
+std::pair<std::unique_ptr<Painter>, std::unique_ptr<AxisPainter>> MarketCanvas::LoadPainters()
+{
+    auto lpMarketPainter = std::make_unique<Painter>();
+    auto lpAxisPainter   = std::make_unique<AxisPainter>();
 
-    mpMarketPainter = std::make_unique<Painter>();
-    mpAxisPainter   = std::make_unique<AxisPainter>();
-    mpMarkupPainter = std::make_unique<MarkupPainter>();
+    lpMarketPainter->WarmUp();
+    lpAxisPainter->WarmUp();
+
+    return {std::move(lpMarketPainter), std::move(lpAxisPainter)};
+}
+
+
+MarketCanvas::MarketCanvas(const uint32_t& aWidth, const uint32_t& aHeight)
+    : MarketCanvas(aWidth, aHeight, LoadData(), std::make_unique<Painter>(), std::make_unique<AxisPainter>())
+{
+}
+
+
+MarketCanvas::MarketCanvas(const uint32_t& aWidth, const uint32_t& aHeight, std::unique_ptr<DataAnalyzer> apDataAnalyzer, std::unique_ptr<Painter> apMarketPainter,
+                           std::unique_ptr<AxisPainter> apAxisPainter)
+    : mWidth{aWidth}, mHeight{aHeight}, mpMarketPainter{std::move(apMarketPainter)}, mpAxisPainter{std::move(apAxisPainter)},
+      mpMarkupPainter{std::make_unique<MarkupPainter>()}, mpDataAnalyzer{std::move(apDataAnalyzer)}
+{
+    std::tie(mStartSeq, mEndSeq) = mpDataAnalyzer->SeqRange();
+
+    Resize();
 
     mMarkups.emplace_back();
 }
@@ -52,6 +99,128 @@ void MarketCanvas::Resize()
 }
 
 
+void MarketCanvas::Follow()
+{
+    std::tie(mStartSeq, mEndSeq) = mpDataAnalyzer->SeqRange();
+
+    Resize();
+}
+
+
+void MarketCanvas::ShowIndex(const std::string& aCode, const uint32_t aLimit)
+{
+    mpReplayEngine.reset();
+
+    mpDataAnalyzer->Clear();
+    mpDataAnalyzer->LoadIndex(aCode, 0, aLimit);
+
+    Follow();
+}
+
+
+void MarketCanvas::ShowRelative(const std::string& aBaseCode, const std::string& aCode, const JoinSeries aSeries, const uint32_t aLimit)
+{
+    mpReplayEngine.reset();
+
+    mpDataAnalyzer->LoadRelative(aBaseCode, aCode, aSeries, 0, aLimit);
+
+    Follow();
+}
+
+
+BacktestResult MarketCanvas::ShowBacktest(const std::string& aCode, const uint32_t aMinPeriod, const uint32_t aMaxPeriod, const uint32_t aLimit)
+{
+    mpReplayEngine.reset();
+
+    const auto lResult = mpDataAnalyzer->LoadBacktest(aCode, aMinPeriod, aMaxPeriod, WorkStealingPool::Instance(), 0, aLimit);
+
+    Follow();
+
+    return lResult;
+}
+
+
+void MarketCanvas::StartReplay(const std::string& aCode, const uint32_t aLimit, const uint32_t aWarmUp, const double aSpeed)
+{
+    mpReplayEngine = std::make_unique<ReplayEngine>(*mpDataAnalyzer, aCode, 0, aLimit, aWarmUp, aSpeed);
+
+    Follow();
+}
+
+
+void MarketCanvas::StopReplay()
+{
+    if (!mpReplayEngine)
+        return;
+
+    mpReplayEngine->Step(mpReplayEngine->Pending());
+    mpReplayEngine.reset();
+
+    Follow();
+}
+
+
+void MarketCanvas::StepReplay(const uint32_t aCount)
+{
+    if (mpReplayEngine && mpReplayEngine->Step(aCount) > 0)
+        Follow();
+}
+
+
+void MarketCanvas::StartTickReplay(const std::filesystem::path& aPath, const double aSpeed)
+{
+    StopTickReplay();
+
+    // The bars still queued by the previous replay go with its tables. Its thread is joined, this one may flush what it held back.
+    bool lFlushed;
+
+    do
+    {
+        lFlushed = mBarFeed.Flush();
+    } while (mBarFeed.Drain(mBarTables) > 0 || !lFlushed);
+
+    mBarTables = BarTables{};
+
+    mpTickReplay = std::make_unique<TickReplay>(aPath, mBarFeed, aSpeed);
+    mStreaming   = true;
+}
+
+
+void MarketCanvas::StopTickReplay()
+{
+    mpTickReplay.reset();
+    mStreaming = false;
+}
+
+
+bool MarketCanvas::Advance()
+{
+    // The render thread is the consumer of the feed, it takes the bars between two frames. Once the replay has posted every tick, all
+    // of its bars are in the queue and this drain is the last one it needs.
+    const auto lPosted = mpTickReplay && mpTickReplay->Finished();
+
+    const auto lDrained = mBarFeed.Drain(mBarTables);
+    mStreaming          = mpTickReplay && !lPosted;
+
+    // The daily bar the ticks are forming revises the statistics of the newest candle while it is for the same date.
+    const auto& lDaily  = mBarTables[static_cast<size_t>(BarInterval::eDaily)];
+    const auto lRevised = lDrained > 0 && lDaily.size() > 0 &&
+                          mpDataAnalyzer->Revise(date::floor<date::days>(lDaily.back<time_tag>()), lDaily.back<close_tag>(), lDaily.back<high_tag>(), lDaily.back<low_tag>());
+
+    if (!mpReplayEngine || mpReplayEngine->Update() == 0)
+    {
+        if (lRevised)
+            Reload();
+
+        return lRevised || (lDrained > 0 && mShownBars);
+    }
+
+    Follow();
+
+    return true;
+}
+
+
 void MarketCanvas::Capture(SkSurface* apSurface) const
 {
     const auto lImageSnapshot = apSurface->makeImageSnapshot();
@@ -227,7 +396,7 @@ void MarketCanvas::Reload()
     if (mXAxis.min < mStartSeq)
         mXAxis.min = mStartSeq;
 
-    auto [lLow, lHigh] = mDataAnalyzer.MinMax<log_price_tag>(mXAxis.min, mXAxis.max);    // range in y axis is: [low boundary, high boundary]
+    auto [lLow, lHigh] = mpDataAnalyzer->MinMax<log_price_tag>(mXAxis.min, mXAxis.max);    // range in y axis is: [low boundary, high boundary]
     lLow *= 0.999f;
     lHigh *= 1.001f;
 
@@ -236,7 +405,7 @@ void MarketCanvas::Reload()
     mPriceAxis.scale = mZoomScaleY * mHeight / (lLow - lHigh);
     mPriceAxis.trans = mZoomScaleY * (mHeight * lHigh / (lHigh - lLow)) + mZoomTransY;
 
-    auto [lMin, lMax] = mDataAnalyzer.MinMax<log_volume_tag>(mXAxis.min, mXAxis.max);
+    auto [lMin, lMax] = mpDataAnalyzer->MinMax<log_volume_tag>(mXAxis.min, mXAxis.max);
     lMin *= 0.99f;
     lMax *= 1.01f;
     mVolumeAxis.min   = lMin;
@@ -246,7 +415,28 @@ void MarketCanvas::Reload()
 
     assert(!std::isinf(mVolumeAxis.scale));
 
-    mTransPrices = mDataAnalyzer.Saxpy<log_price_tag>(mXAxis.min, mXAxis.max, mXAxis.scale, mXAxis.trans, mPriceAxis.scale, mPriceAxis.trans, mVolumeAxis.scale, mVolumeAxis.trans);
+    mTransPrices = mpDataAnalyzer->Saxpy<log_price_tag>(mXAxis.min, mXAxis.max, mXAxis.scale, mXAxis.trans, mPriceAxis.scale, mPriceAxis.trans, mVolumeAxis.scale, mVolumeAxis.trans);
+
+    mVolumeProfile = mpDataAnalyzer->Profile<log_price_tag>(mXAxis.min, mXAxis.max, mPriceAxis.min, mPriceAxis.max, PROFILE_BINS);
+
+    mPatternMarkers.resize(mShownPatterns.size());
+
+    for (size_t i = 0; i < mShownPatterns.size(); ++i)
+        mPatternMarkers[i] = mpDataAnalyzer->Patterns(mShownPatterns[i], mXAxis.min, mXAxis.max);
+
+    // The indicators and the rolling high and low are prices, mapped like the candles on the log price axis.
+    const auto lOverlay = [this](const auto& aRange, std::vector<SkScalar>& aCoordsY) {
+        aCoordsY.resize(static_cast<size_t>(std::distance(aRange.first, aRange.second)));
+
+        std::transform(aRange.first, aRange.second, aCoordsY.begin(), [this](const float aValue) { return std::fma(std::logf(aValue), mPriceAxis.scale, mPriceAxis.trans); });
+    };
+
+    lOverlay(mpDataAnalyzer->Indicator<sma_tag>(mXAxis.min, mXAxis.max), mOverlays[0]);
+    lOverlay(mpDataAnalyzer->Indicator<ema_tag>(mXAxis.min, mXAxis.max), mOverlays[1]);
+    lOverlay(mpDataAnalyzer->Indicator<bollinger_upper_tag>(mXAxis.min, mXAxis.max), mOverlays[2]);
+    lOverlay(mpDataAnalyzer->Indicator<bollinger_lower_tag>(mXAxis.min, mXAxis.max), mOverlays[3]);
+    lOverlay(mpDataAnalyzer->Statistic<rolling_high_tag>(mXAxis.min, mXAxis.max), mOverlays[4]);
+    lOverlay(mpDataAnalyzer->Statistic<rolling_low_tag>(mXAxis.min, mXAxis.max), mOverlays[5]);
 }
 
 
@@ -256,39 +446,86 @@ void MarketCanvas::Paint(SkSurface* apSurface) const
 
     lCanvas.clear(SK_ColorDKGRAY);
 
+    if (mShownBars)
+    {
+        mpMarketPainter->DrawBars(lCanvas, Bars(*mShownBars), *mShownBars);
+        return;
+    }
+
     // const auto lPrice = std::expf((mMousePosY - mPriceAxis.trans) / mPriceAxis.scale);
     // fmt::print("(x, y) -> ({}, {}) -> ({}, {})\n", mMousePosX, mMousePosY, mSelectedCandle, lPrice);
 
-    mpMarketPainter->DrawCandle(lCanvas, mTransPrices, mCandleWidth);
+    PaintCandles(lCanvas);
+    PaintAxes(lCanvas);
+    PaintMarkups(lCanvas);
+}
 
-    mpAxisPainter->Draw<axis::Right>(lCanvas, mPriceAxis);
-    mpAxisPainter->Draw<axis::Left>(lCanvas, mVolumeAxis);
 
-    const auto& lCandleData = mDataAnalyzer[mXAxis.max - Median(mXAxis.min, mXAxis.max, mSelectedCandle)];
-    mpMarketPainter->Highlight(lCanvas, lCandleData, mCandleWidth);
+void MarketCanvas::PaintCandles(SkCanvas& aCanvas) const
+{
+    mpMarketPainter->DrawCandle(aCanvas, mTransPrices, mCandleWidth);
 
-    {
-        SkAutoCanvasRestore lGuard(&lCanvas, true);
-
-        // lCanvas.translate(mXAxis.trans, mPriceAxis.trans);
-        // lCanvas.scale(mXAxis.scale, mPriceAxis.scale);
-
-        for (const auto& lMarkup : mMarkups)
-            std::visit(
-                [&lCanvas, &lPainter = *mpMarkupPainter, lPos = SkPoint::Make(mMousePosX, mMousePosY)](auto&& aMarkup) {
-                    if (aMarkup.HitTest(lPos) != ControlPointType::eNone)
-                    {
-                        lPainter.SetColor(SK_ColorYELLOW);
-                        lPainter.Highlight(lCanvas, aMarkup);
-                    }
-                    else
-                    {
-                        lPainter.SetColor(SK_ColorMAGENTA);
-                        lPainter.Draw(lCanvas, aMarkup);
-                    }
-                },
-                lMarkup);
-    }
+    for (size_t i = 0; i < mOverlays.size(); ++i)
+        mpMarketPainter->DrawOverlay(aCanvas, mTransPrices, mOverlays[i], OVERLAY_COLORS[i]);
+
+    for (size_t i = 0; i < mShownPatterns.size(); ++i)
+        mpMarketPainter->DrawPatterns(aCanvas, mTransPrices, mShownPatterns[i], mPatternMarkers[i], mCandleWidth);
+}
+
+
+void MarketCanvas::PaintAxes(SkCanvas& aCanvas) const
+{
+    mpMarketPainter->DrawVolumeProfile(aCanvas, mVolumeProfile, mPriceAxis.scale, mPriceAxis.trans);
+
+    mpAxisPainter->Draw<axis::Right>(aCanvas, mPriceAxis);
+    mpAxisPainter->Draw<axis::Left>(aCanvas, mVolumeAxis);
+}
+
+
+void MarketCanvas::PaintMarkups(SkCanvas& aCanvas) const
+{
+    const auto lSelectedSeq = Median(mXAxis.min, mXAxis.max, mSelectedCandle);
+    const auto& lCandleData = (*mpDataAnalyzer)[mXAxis.max - lSelectedSeq];
+    mpMarketPainter->Highlight(aCanvas, lCandleData, mCandleWidth);
+
+    // From the first visible candle to the one under the crosshair.
+    mpMarketPainter->DrawStatistics(aCanvas, {mMousePosX, mMousePosY}, mpDataAnalyzer->Sum<volume_tag>(mXAxis.min, lSelectedSeq),
+                                    mpDataAnalyzer->Vwap(mXAxis.min, lSelectedSeq));
+    mpMarketPainter->DrawRollingStatistics(aCanvas, {mMousePosX, mMousePosY}, *mpDataAnalyzer->Statistic<volatility_tag>(lSelectedSeq, lSelectedSeq).first,
+                                           *mpDataAnalyzer->Statistic<zscore_tag>(lSelectedSeq, lSelectedSeq).first,
+                                           *mpDataAnalyzer->Statistic<drawdown_tag>(lSelectedSeq, lSelectedSeq).first);
+
+    SkAutoCanvasRestore lGuard(&aCanvas, true);
+
+    // aCanvas.translate(mXAxis.trans, mPriceAxis.trans);
+    // aCanvas.scale(mXAxis.scale, mPriceAxis.scale);
+
+    for (const auto& lMarkup : mMarkups)
+        std::visit(
+            [this, &aCanvas, &lPainter = *mpMarkupPainter, lPos = SkPoint::Make(mMousePosX, mMousePosY)](auto&& aMarkup) {
+                if (aMarkup.HitTest(lPos) != ControlPointType::eNone)
+                {
+                    lPainter.SetColor(SK_ColorYELLOW);
+                    lPainter.Highlight(aCanvas, aMarkup);
+                }
+                else
+                {
+                    lPainter.SetColor(SK_ColorMAGENTA);
+                    lPainter.Draw(aCanvas, aMarkup);
+                }
+
+                if constexpr (std::is_same_v<std::decay_t<decltype(aMarkup)>, TrendLine>)
+                {
+                    const auto lBeginSeq = ConvertToSeq(aMarkup.Start().x());
+                    const auto lEndSeq   = ConvertToSeq(aMarkup.End().x());
+
+                    const auto lStartSeq = std::min(lBeginSeq, lEndSeq);
+                    const auto lStopSeq  = std::max(lBeginSeq, lEndSeq);
+
+                    mpMarketPainter->DrawStatistics(aCanvas, aMarkup.End(), mpDataAnalyzer->Sum<volume_tag>(lStartSeq, lStopSeq), mpDataAnalyzer->Vwap(lStartSeq, lStopSeq));
+                }
+            },
+            lMarkup);
 }
 
 
@@ -0,0 +1,228 @@
+#include "Market/Model/Backtester.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "Market/Model/ColumnExpression.h"
+#include "Utility/WorkStealingPool.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+struct fast_average_tag;
+struct slow_average_tag;
+
+
+// Columns of a backtest bound by the expressions, oldest first.
+struct BacktestColumns
+{
+    const float* closes;
+    const float* fastAverages;
+    const float* slowAverages;
+
+    template <typename Tag>
+    [[nodiscard]] const float* begin() const;
+};
+
+
+template <>
+const float* BacktestColumns::begin<close_tag>() const
+{
+    return closes;
+}
+
+template <>
+const float* BacktestColumns::begin<fast_average_tag>() const
+{
+    return fastAverages;
+}
+
+template <>
+const float* BacktestColumns::begin<slow_average_tag>() const
+{
+    return slowAverages;
+}
+
+
+
+}    // namespace
+
+
+
+void Backtester::Prepare()
+{
+    const auto lSize = static_cast<uint32_t>(mCloses.size());
+
+    mReturns.assign(lSize, 0.f);
+
+    // Rows are oldest first here, so offset 1 is the next close and row t yields the return of row t + 1.
+    if (lSize > 1)
+        abollo::Evaluate(BacktestColumns{mCloses.data(), nullptr, nullptr}, col<close_tag>(1) / col<close_tag>() - 1.f, 0, lSize - 1, mReturns.data() + 1);
+
+    mSums.assign(lSize + 1, 0.0);
+    std::inclusive_scan(mCloses.cbegin(), mCloses.cend(), mSums.begin() + 1, std::plus<>{}, 0.0);
+}
+
+
+void Backtester::Averages(const uint32_t aPeriod, float* aAverages) const
+{
+    const auto lSize   = mCloses.size();
+    const auto lPeriod = std::min<size_t>(aPeriod, lSize + 1);
+
+    assert(aPeriod > 0);
+
+    std::fill_n(aAverages, lPeriod - 1, std::numeric_limits<float>::quiet_NaN());
+    std::transform(mSums.cbegin() + lPeriod, mSums.cend(), mSums.cbegin(), aAverages + lPeriod - 1,
+                   [aPeriod](const double aSum, const double aStart) { return static_cast<float>((aSum - aStart) / aPeriod); });
+}
+
+
+void Backtester::CrossoverPositions(const float* aFastAverages, const float* aSlowAverages, std::vector<float>& aPositions) const
+{
+    const auto lSize = static_cast<uint32_t>(mCloses.size());
+
+    aPositions.resize(lSize);
+
+    // The slow average is NaN until it is defined, the comparison is false there.
+    abollo::Evaluate(BacktestColumns{mCloses.data(), aFastAverages, aSlowAverages}, Greater(col<fast_average_tag>(), col<slow_average_tag>()), 0, lSize,
+                     aPositions.data());
+}
+
+
+BacktestResult Backtester::Evaluate(Scratch& aScratch) const
+{
+    const auto lSize       = mCloses.size();
+    const auto& lPositions = aScratch.positions;
+
+    assert(lPositions.size() == lSize);
+
+    BacktestResult lResult;
+
+    if (lSize == 0)
+        return lResult;
+
+    auto& lEquity = aScratch.equity;
+    auto& lPeaks  = aScratch.peaks;
+
+    lEquity.resize(lSize);
+    lPeaks.resize(lSize);
+
+    // Profit and loss of every row: the position held since the previous close, minus the cost of moving to the new position.
+    lEquity[0] = -mCost * std::fabs(lPositions[0]);
+
+    for (size_t t = 1; t < lSize; ++t)
+        lEquity[t] = static_cast<double>(lPositions[t - 1]) * mReturns[t] - mCost * std::fabs(lPositions[t] - lPositions[t - 1]);
+
+    const auto lMean     = std::reduce(lEquity.cbegin(), lEquity.cend()) / lSize;
+    const auto lVariance = std::transform_reduce(lEquity.cbegin(), lEquity.cend(), 0.0, std::plus<>{}, [lMean](const double aPnl) { return (aPnl - lMean) * (aPnl - lMean); }) / lSize;
+
+    lResult.sharpe = lVariance > 0.0 ? lMean / std::sqrt(lVariance) * std::sqrt(TRADING_DAYS) : 0.0;
+
+    // The equity compounds the growth factors of the rows, a product scan.
+    std::transform(lEquity.cbegin(), lEquity.cend(), lEquity.begin(), [](const double aPnl) { return 1.0 + aPnl; });
+    std::inclusive_scan(lEquity.cbegin(), lEquity.cend(), lEquity.begin(), std::multiplies<>{});
+
+    std::inclusive_scan(lEquity.cbegin(), lEquity.cend(), lPeaks.begin(), [](const double aFirst, const double aSecond) { return std::max(aFirst, aSecond); });
+
+    lResult.totalReturn = lEquity.back() - 1.0;
+    lResult.maxDrawdown = std::transform_reduce(lEquity.cbegin(), lEquity.cend(), lPeaks.cbegin(), 0.0, [](const double aFirst, const double aSecond) { return std::max(aFirst, aSecond); },
+                                                [](const double aEquity, const double aPeak) { return 1.0 - aEquity / std::max(aPeak, 1.0); });
+
+    const auto lChanges = std::transform_reduce(lPositions.cbegin() + 1, lPositions.cend(), lPositions.cbegin(), static_cast<double>(std::fabs(lPositions[0])), std::plus<>{},
+                                                [](const float aPosition, const float aPrevious) { return static_cast<double>(std::fabs(aPosition - aPrevious)); });
+
+    lResult.turnover = lChanges * TRADING_DAYS / lSize;
+
+    return lResult;
+}
+
+
+BacktestResult Backtester::RunCrossover(const uint32_t aFastPeriod, const uint32_t aSlowPeriod, const float* aFastAverages, const float* aSlowAverages,
+                                        Scratch& aScratch) const
+{
+    assert(0 < aFastPeriod && aFastPeriod < aSlowPeriod);
+
+    CrossoverPositions(aFastAverages, aSlowAverages, aScratch.positions);
+
+    auto lResult       = Evaluate(aScratch);
+    lResult.fastPeriod = aFastPeriod;
+    lResult.slowPeriod = aSlowPeriod;
+
+    return lResult;
+}
+
+
+BacktestResult Backtester::RunCrossover(const uint32_t aFastPeriod, const uint32_t aSlowPeriod, Scratch& aScratch) const
+{
+    const auto lSize = mCloses.size();
+    auto& lAverages  = aScratch.averages;
+
+    lAverages.resize(2 * lSize);
+
+    Averages(aFastPeriod, lAverages.data());
+    Averages(aSlowPeriod, lAverages.data() + lSize);
+
+    return RunCrossover(aFastPeriod, aSlowPeriod, lAverages.data(), lAverages.data() + lSize, aScratch);
+}
+
+
+std::vector<BacktestResult> Backtester::SweepCrossovers(WorkStealingPool& aPool, const uint32_t aMinPeriod, const uint32_t aMaxPeriod) const
+{
+    std::vector<std::pair<uint32_t, uint32_t>> lPairs;
+
+    for (auto lFast = std::max(aMinPeriod, 1u); lFast < aMaxPeriod; ++lFast)
+        for (auto lSlow = lFast + 1; lSlow <= aMaxPeriod; ++lSlow)
+            lPairs.emplace_back(lFast, lSlow);
+
+    std::vector<BacktestResult> lResults(lPairs.size());
+    std::vector<Scratch> lScratches(aPool.WorkerCount());
+
+    if (lPairs.empty())
+        return lResults;
+
+    // One moving average column per period of the sweep, row t of period p at (p - lMinPeriod) * size() + t.
+    const auto lMinPeriod = lPairs.front().first;
+    const auto lSize      = mCloses.size();
+    std::vector<float> lAverages((aMaxPeriod - lMinPeriod + 1) * lSize);
+
+    aPool.ForEach(aMaxPeriod - lMinPeriod + 1, 1, [this, lMinPeriod, lSize, &lAverages](const size_t i, const size_t) {
+        Averages(lMinPeriod + static_cast<uint32_t>(i), lAverages.data() + i * lSize);
+    });
+
+    // Short fast periods and long slow ones cost the same, but the grain keeps the chunks small enough for stealing to balance the tail.
+    aPool.ForEach(lPairs.size(), SWEEP_GRAIN, [this, lMinPeriod, lSize, &lPairs, &lAverages, &lResults, &lScratches](const size_t i, const size_t aWorker) {
+        const auto lFast = lPairs[i].first;
+        const auto lSlow = lPairs[i].second;
+
+        lResults[i] = RunCrossover(lFast, lSlow, lAverages.data() + (lFast - lMinPeriod) * lSize, lAverages.data() + (lSlow - lMinPeriod) * lSize, lScratches[aWorker]);
+    });
+
+    return lResults;
+}
+
+
+std::vector<double> Backtester::CrossoverEquity(const uint32_t aFastPeriod, const uint32_t aSlowPeriod) const
+{
+    Scratch lScratch;
+    (void)RunCrossover(aFastPeriod, aSlowPeriod, lScratch);
+
+    return std::move(lScratch.equity);
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
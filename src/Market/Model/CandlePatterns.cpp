@@ -0,0 +1,304 @@
+#include "Market/Model/CandlePatterns.h"
+
+#include <algorithm>
+#include <bit>
+
+#include <skia/include/private/SkVx.h>
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr auto NOT_AVAILABLE = std::numeric_limits<float>::quiet_NaN();
+
+constexpr float DOJI_BODY      = 0.1f;    // Largest body of a doji, as a fraction of the range.
+constexpr float HAMMER_SHADOW  = 2.f;     // Smallest lower shadow of a hammer, as a multiple of the body.
+constexpr float HAMMER_UPPER   = 0.1f;    // Largest upper shadow of a hammer, as a fraction of the range.
+constexpr float LONG_BODY      = 0.5f;    // Smallest body of the first candle of a morning star, as a fraction of the range.
+constexpr float STAR_BODY      = 0.3f;    // Largest body of the star, as a fraction of the body of the first candle.
+
+constexpr uint64_t STEP_BITS = (uint64_t{1} << CandlePatterns::LANES) - 1;
+
+using Vec  = skvx::Vec<CandlePatterns::LANES, float>;
+using Mask = skvx::Vec<CandlePatterns::LANES, int32_t>;
+
+
+// LANES consecutive candles.
+struct Candles
+{
+    Vec open;
+    Vec close;
+    Vec low;
+    Vec high;
+
+    Candles(const float* aOpens, const float* aCloses, const float* aLows, const float* aHighs, const size_t aRow)
+        : open{Vec::Load(aOpens + aRow)}, close{Vec::Load(aCloses + aRow)}, low{Vec::Load(aLows + aRow)}, high{Vec::Load(aHighs + aRow)}
+    {
+    }
+
+    [[nodiscard]] Vec Body() const
+    {
+        return skvx::abs(close - open);
+    }
+
+    [[nodiscard]] Vec Range() const
+    {
+        return high - low;
+    }
+
+    [[nodiscard]] Vec Top() const
+    {
+        return skvx::max(open, close);
+    }
+
+    [[nodiscard]] Vec Bottom() const
+    {
+        return skvx::min(open, close);
+    }
+
+    [[nodiscard]] Mask Rising() const
+    {
+        return close > open;
+    }
+
+    [[nodiscard]] Mask Falling() const
+    {
+        return close < open;
+    }
+};
+
+
+// Lane i of aMask to bit i.
+uint32_t ToBits(const Mask& aMask)
+{
+    int32_t lLanes[CandlePatterns::LANES];
+    (aMask & Mask{1, 2, 4, 8, 16, 32, 64, 128}).store(lLanes);
+
+    uint32_t lBits = 0;
+
+    for (const auto lLane : lLanes)
+        lBits |= static_cast<uint32_t>(lLane);
+
+    return lBits;
+}
+
+
+// Every pattern completed by the candles aCurrent, aPrevious and aFirst are the candles one and two rows before.
+std::array<Mask, PATTERN_COUNT> Match(const Candles& aCurrent, const Candles& aPrevious, const Candles& aFirst)
+{
+    std::array<Mask, PATTERN_COUNT> lMasks;
+
+    const auto lBody  = aCurrent.Body();
+    const auto lRange = aCurrent.Range();
+
+    lMasks[static_cast<size_t>(CandlePattern::eDoji)] = (lBody <= lRange * DOJI_BODY) & (lRange > 0.f);
+
+    lMasks[static_cast<size_t>(CandlePattern::eHammer)] =
+        (aCurrent.Bottom() - aCurrent.low >= lBody * HAMMER_SHADOW) & (aCurrent.high - aCurrent.Top() <= lRange * HAMMER_UPPER) & (lRange > 0.f);
+
+    lMasks[static_cast<size_t>(CandlePattern::eBullishEngulfing)] =
+        aPrevious.Falling() & aCurrent.Rising() & (aCurrent.open <= aPrevious.close) & (aCurrent.close >= aPrevious.open);
+
+    lMasks[static_cast<size_t>(CandlePattern::eBearishEngulfing)] =
+        aPrevious.Rising() & aCurrent.Falling() & (aCurrent.open >= aPrevious.close) & (aCurrent.close <= aPrevious.open);
+
+    // A long falling candle, a small one gapping below its close, then a rising one closing above the middle of the first body.
+    const auto lFirstBody = aFirst.Body();
+
+    lMasks[static_cast<size_t>(CandlePattern::eMorningStar)] = aFirst.Falling() & (lFirstBody >= aFirst.Range() * LONG_BODY) &
+                                                               (aPrevious.Body() <= lFirstBody * STAR_BODY) & (aPrevious.Top() < aFirst.close) &
+                                                               aCurrent.Rising() & (aCurrent.close > (aFirst.open + aFirst.close) * 0.5f);
+
+    lMasks[static_cast<size_t>(CandlePattern::eInsideBar)] = (aCurrent.high < aPrevious.high) & (aCurrent.low > aPrevious.low);
+
+    lMasks[static_cast<size_t>(CandlePattern::eGapUp)]   = aCurrent.low > aPrevious.high;
+    lMasks[static_cast<size_t>(CandlePattern::eGapDown)] = aCurrent.high < aPrevious.low;
+
+    return lMasks;
+}
+
+
+
+}    // namespace
+
+
+
+void CandlePatterns::Resize(const uint32_t aSize)
+{
+    mSize = aSize;
+
+    for (auto* lpColumn : {&mOpens, &mCloses, &mLows, &mHighs})
+    {
+        lpColumn->clear();
+        lpColumn->append_n(Stride(aSize), NOT_AVAILABLE);
+    }
+
+    for (auto& lBits : mBits)
+        lBits.assign((aSize + WORD_BITS - 1) / WORD_BITS, 0);
+}
+
+
+void CandlePatterns::Pad()
+{
+    for (auto* lpColumn : {&mOpens, &mCloses, &mLows, &mHighs})
+    {
+        lpColumn->drop_back(lpColumn->size() - HISTORY - mSize);
+        lpColumn->append_n(Stride(mSize) - HISTORY - mSize, NOT_AVAILABLE);
+    }
+}
+
+
+void CandlePatterns::ShiftUp(const uint32_t aCount)
+{
+    const auto lWords = (mSize + WORD_BITS - 1) / WORD_BITS;
+    const auto lSkip  = aCount / WORD_BITS;
+    const auto lShift = aCount % WORD_BITS;
+
+    for (auto& lBits : mBits)
+    {
+        std::vector<uint64_t> lShifted(lWords, 0);
+
+        for (size_t w = 0; w < lBits.size() && w + lSkip < lWords; ++w)
+        {
+            lShifted[w + lSkip] |= lBits[w] << lShift;
+
+            if (lShift != 0 && w + lSkip + 1 < lWords)
+                lShifted[w + lSkip + 1] |= lBits[w] >> (WORD_BITS - lShift);
+        }
+
+        lBits.swap(lShifted);
+    }
+}
+
+
+void CandlePatterns::ShiftDown(const uint32_t aCount)
+{
+    const auto lWords = (mSize + WORD_BITS - 1) / WORD_BITS;
+    const auto lSkip  = aCount / WORD_BITS;
+    const auto lShift = aCount % WORD_BITS;
+
+    for (auto& lBits : mBits)
+    {
+        for (size_t w = 0; w < lWords; ++w)
+        {
+            const auto lHigh = w + lSkip + 1 < lBits.size() && lShift != 0 ? lBits[w + lSkip + 1] << (WORD_BITS - lShift) : 0;
+
+            lBits[w] = lBits[w + lSkip] >> lShift | lHigh;
+        }
+
+        lBits.resize(lWords);
+
+        if (mSize % WORD_BITS != 0)
+            lBits.back() &= ~(~uint64_t{0} << (mSize % WORD_BITS));
+    }
+}
+
+
+void CandlePatterns::pop_back(const uint32_t aCount)
+{
+    assert(aCount <= mSize);
+
+    mSize -= aCount;
+
+    // The new oldest rows get the padding of the history before them.
+    for (auto* lpColumn : {&mOpens, &mCloses, &mLows, &mHighs})
+    {
+        lpColumn->drop_front(HISTORY + aCount);
+        lpColumn->prepend_n(HISTORY, NOT_AVAILABLE);
+    }
+
+    Pad();
+    ShiftDown(aCount);
+    Scan(0, HISTORY);
+}
+
+
+void CandlePatterns::pop_front(const uint32_t aCount)
+{
+    assert(aCount <= mSize);
+
+    mSize -= aCount;
+
+    Pad();
+    ShiftDown(0);
+}
+
+
+void CandlePatterns::Scan(const uint32_t aFrom, const uint32_t aTo)
+{
+    // Steps start on a multiple of LANES and are written whole, the LANES bits of a step are replaced.
+    const auto lStart = aFrom / LANES * LANES;
+    const auto lLast  = std::min(Stride(mSize), HISTORY + (static_cast<size_t>(std::min(aTo, mSize)) + LANES - 1) / LANES * LANES);
+
+    for (auto& lBits : mBits)
+        lBits.resize((mSize + WORD_BITS - 1) / WORD_BITS, 0);
+
+    // Rows are shifted by HISTORY in the columns, position p holds row p - HISTORY.
+    for (size_t p = HISTORY + lStart; p < lLast; p += LANES)
+    {
+        const Candles lCurrent{mOpens.data(), mCloses.data(), mLows.data(), mHighs.data(), p};
+        const Candles lPrevious{mOpens.data(), mCloses.data(), mLows.data(), mHighs.data(), p - 1};
+        const Candles lFirst{mOpens.data(), mCloses.data(), mLows.data(), mHighs.data(), p - 2};
+
+        const auto lMasks = Match(lCurrent, lPrevious, lFirst);
+        const auto lRow   = p - HISTORY;
+        const auto lShift = lRow % WORD_BITS;
+
+        // LANES divides WORD_BITS, the LANES bits of a step never straddle two words.
+        for (size_t i = 0; i < PATTERN_COUNT; ++i)
+        {
+            auto& lWord = mBits[i][lRow / WORD_BITS];
+
+            lWord = (lWord & ~(STEP_BITS << lShift)) | static_cast<uint64_t>(ToBits(lMasks[i])) << lShift;
+        }
+    }
+}
+
+
+std::vector<uint32_t> CandlePatterns::Matches(const CandlePattern aPattern, const uint32_t aFirst, const uint32_t aLast) const
+{
+    assert(aFirst <= aLast && aLast <= mSize);
+
+    std::vector<uint32_t> lOffsets;
+
+    if (aFirst == aLast)
+        return lOffsets;
+
+    const auto& lBits = Bits(aPattern);
+
+    // [aFirst, aLast) newest first is [mSize - aLast, mSize - aFirst) oldest first.
+    const auto lBegin = mSize - aLast;
+    const auto lEnd   = mSize - aFirst;
+
+    for (auto w = lBegin / WORD_BITS; w <= (lEnd - 1) / WORD_BITS; ++w)
+    {
+        auto lWord = lBits[w];
+
+        if (w == lBegin / WORD_BITS)
+            lWord &= ~uint64_t{0} << (lBegin % WORD_BITS);
+
+        if (w == (lEnd - 1) / WORD_BITS && lEnd % WORD_BITS != 0)
+            lWord &= ~(~uint64_t{0} << (lEnd % WORD_BITS));
+
+        for (; lWord != 0; lWord &= lWord - 1)
+        {
+            const auto lRow = w * WORD_BITS + static_cast<uint32_t>(std::countr_zero(lWord));
+
+            lOffsets.push_back(mSize - 1 - lRow - aFirst);
+        }
+    }
+
+    return lOffsets;
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,409 @@
+#include "Market/Model/CorrelationMatrix.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include <fmt/format.h>
+#include <skia/include/private/SkVx.h>
+
+#include "Market/Model/DataLoader.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr auto NOT_AVAILABLE = std::numeric_limits<float>::quiet_NaN();
+
+
+// Dot product of two rows whose length aCount is a multiple of N. Two accumulators hide the latency of the multiply-adds.
+template <int N>
+float Dot(const float* aFirst, const float* aSecond, const size_t aCount)
+{
+    using Vec = skvx::Vec<N, float>;
+
+    Vec lEven{0.f};
+    Vec lOdd{0.f};
+
+    size_t k = 0;
+
+    for (; k + 2 * N <= aCount; k += 2 * N)
+    {
+        lEven = skvx::mad(Vec::Load(aFirst + k), Vec::Load(aSecond + k), lEven);
+        lOdd  = skvx::mad(Vec::Load(aFirst + k + N), Vec::Load(aSecond + k + N), lOdd);
+    }
+
+    if (k < aCount)
+        lEven = skvx::mad(Vec::Load(aFirst + k), Vec::Load(aSecond + k), lEven);
+
+    float lLanes[N];
+    (lEven + lOdd).store(lLanes);
+
+    return std::accumulate(lLanes, lLanes + N, 0.f);
+}
+
+
+// Closes of consecutive trading dates, one row per date and one column per code.
+struct CloseGrid
+{
+    std::vector<date::sys_days> dates;
+    std::vector<float> closes;
+    std::vector<std::string> codes;    // Codes that are not in the columns, sorted.
+};
+
+
+// aCodes must be sorted. Closes of the codes that are not in aCodes are dropped, the codes are kept in codes.
+CloseGrid LoadCloses(DataLoader& aDataLoader, const date::sys_days aAfter, const uint32_t aLimit, const std::vector<std::string>& aCodes)
+{
+    CloseGrid lGrid;
+
+    aDataLoader.LoadCloses(aAfter, aLimit, [&lGrid, &aCodes](const std::string& aCode, const date::sys_days aDate, const float aClose) {
+        if (lGrid.dates.empty() || lGrid.dates.back() != aDate)
+        {
+            lGrid.dates.push_back(aDate);
+            lGrid.closes.resize(lGrid.closes.size() + aCodes.size(), NOT_AVAILABLE);
+        }
+
+        if (const auto lCode = std::lower_bound(aCodes.cbegin(), aCodes.cend(), aCode); lCode != aCodes.cend() && *lCode == aCode)
+            lGrid.closes[lGrid.closes.size() - aCodes.size() + (lCode - aCodes.cbegin())] = aClose;
+        else if (const auto lNew = std::lower_bound(lGrid.codes.cbegin(), lGrid.codes.cend(), aCode); lNew == lGrid.codes.cend() || *lNew != aCode)
+            lGrid.codes.insert(lNew, aCode);
+    });
+
+    return lGrid;
+}
+
+
+
+}    // namespace
+
+
+
+CorrelationMatrix::CorrelationMatrix(std::vector<std::string> aCodes, const uint32_t aDays)
+    : mDays{aDays}, mStride{(aDays + LANES - 1) / LANES * LANES}, mCodes{std::move(aCodes)}, mLastCloses(mCodes.size(), NOT_AVAILABLE),
+      mReturns(mCodes.size() * mStride, 0.f), mSums(mCodes.size(), 0.0), mProducts(mCodes.size() * mCodes.size(), 0.0)
+{
+    assert(aDays > 0 && std::is_sorted(mCodes.cbegin(), mCodes.cend()));
+}
+
+
+CorrelationMatrix CorrelationMatrix::Load(DataLoader& aDataLoader, const uint32_t aDays)
+{
+    // The codes are only known once the closes are loaded, keep them as they come and lay out the grid afterwards.
+    std::vector<std::string> lCodes;
+    std::vector<std::pair<uint32_t, float>> lRows;    // (code, close), the index of the date in lDates is lStarts.
+    std::vector<date::sys_days> lDates;
+    std::vector<size_t> lStarts;
+
+    // Every date stored is after the epoch.
+    aDataLoader.LoadCloses(date::sys_days{}, aDays + 1, [&](const std::string& aCode, const date::sys_days aDate, const float aClose) {
+        if (lDates.empty() || lDates.back() != aDate)
+        {
+            lDates.push_back(aDate);
+            lStarts.push_back(lRows.size());
+        }
+
+        auto lCode = std::lower_bound(lCodes.begin(), lCodes.end(), aCode);
+
+        if (lCode == lCodes.end() || *lCode != aCode)
+        {
+            // New codes are rare after the first date, shift the indices already recorded.
+            const auto lIndex = static_cast<uint32_t>(lCode - lCodes.begin());
+
+            for (auto& lRow : lRows)
+                lRow.first += lRow.first >= lIndex ? 1 : 0;
+
+            lCode = lCodes.insert(lCode, aCode);
+        }
+
+        lRows.emplace_back(static_cast<uint32_t>(lCode - lCodes.begin()), aClose);
+    });
+
+    lStarts.push_back(lRows.size());
+
+    CorrelationMatrix lMatrix{std::move(lCodes), aDays};
+
+    if (lDates.empty())
+        return lMatrix;
+
+    std::vector<float> lCloses(lMatrix.Count());
+    std::vector<float> lReturns(lMatrix.Count());
+
+    for (size_t d = 0; d < lDates.size(); ++d)
+    {
+        std::fill(lCloses.begin(), lCloses.end(), NOT_AVAILABLE);
+
+        for (auto r = lStarts[d]; r < lStarts[d + 1]; ++r)
+            lCloses[lRows[r].first] = lRows[r].second;
+
+        lMatrix.Shift(lDates[d], lCloses.data(), lReturns);
+    }
+
+    // The first date only seeded the closes, its zero returns are the first to be overwritten.
+    lMatrix.ComputeProducts();
+
+    return lMatrix;
+}
+
+
+uint32_t CorrelationMatrix::Update(DataLoader& aDataLoader)
+{
+    auto lGrid = LoadCloses(aDataLoader, mDate, mDays + 1, mCodes);
+
+    // Only the latest dates are loaded, if the window moved that far the dates in between may be missing.
+    if (lGrid.dates.size() > mDays)
+    {
+        // Only the latest dates were loaded, count them all before the window moves.
+        const auto lDates = aDataLoader.CountDates(mDate);
+
+        *this = Load(aDataLoader, mDays);
+
+        return lDates;
+    }
+
+    // New codes are rare, the closes are loaded again once they have their columns.
+    if (!lGrid.codes.empty())
+    {
+        for (const auto& lCode : lGrid.codes)
+            Insert(lCode);
+
+        lGrid = LoadCloses(aDataLoader, mDate, mDays + 1, mCodes);
+    }
+
+    std::vector<float> lCloses(Count());
+
+    for (size_t d = 0; d < lGrid.dates.size(); ++d)
+    {
+        std::copy_n(lGrid.closes.cbegin() + d * Count(), Count(), lCloses.begin());
+
+        Append(lGrid.dates[d], lCloses);
+    }
+
+    return static_cast<uint32_t>(lGrid.dates.size());
+}
+
+
+void CorrelationMatrix::Insert(const std::string& aCode)
+{
+    const auto lCount = Count();
+    const auto lIndex = static_cast<size_t>(std::lower_bound(mCodes.cbegin(), mCodes.cend(), aCode) - mCodes.cbegin());
+
+    assert(lIndex == lCount || mCodes[lIndex] != aCode);
+
+    // Returns of 0 add nothing to the sums and cross products, the new row and column are 0.
+    std::vector<double> lProducts((lCount + 1) * (lCount + 1), 0.0);
+
+    for (size_t i = 0; i < lCount; ++i)
+        for (auto j = i; j < lCount; ++j)
+            lProducts[(i + (i >= lIndex ? 1 : 0)) * (lCount + 1) + j + (j >= lIndex ? 1 : 0)] = mProducts[i * lCount + j];
+
+    mProducts.swap(lProducts);
+
+    mCodes.insert(mCodes.begin() + lIndex, aCode);
+    mLastCloses.insert(mLastCloses.begin() + lIndex, NOT_AVAILABLE);
+    mReturns.insert(mReturns.begin() + lIndex * mStride, mStride, 0.f);
+    mSums.insert(mSums.begin() + lIndex, 0.0);
+}
+
+
+void CorrelationMatrix::Shift(const date::sys_days aDate, const float* aCloses, std::vector<float>& aReturns)
+{
+    for (size_t i = 0; i < Count(); ++i)
+    {
+        const auto lClose = aCloses[i];
+
+        aReturns[i] = std::isnan(lClose) || std::isnan(mLastCloses[i]) ? 0.f : lClose / mLastCloses[i] - 1.f;
+
+        if (!std::isnan(lClose))
+            mLastCloses[i] = lClose;
+
+        Returns(i)[mHead] = aReturns[i];
+    }
+
+    mHead = (mHead + 1) % mDays;
+    mDate = aDate;
+}
+
+
+void CorrelationMatrix::Append(const date::sys_days aDate, const std::vector<float>& aCloses)
+{
+    assert(aCloses.size() == Count());
+
+    const auto lCount = Count();
+    const auto lSlot  = mHead;
+
+    std::vector<float> lOld(lCount);
+    std::vector<float> lNew(lCount);
+
+    for (size_t i = 0; i < lCount; ++i)
+        lOld[i] = Returns(i)[lSlot];
+
+    Shift(aDate, aCloses.data(), lNew);
+
+    std::vector<size_t> lRows(lCount);
+    std::iota(lRows.begin(), lRows.end(), size_t{0});
+
+    std::for_each(std::execution::par, lRows.cbegin(), lRows.cend(), [this, lCount, &lOld, &lNew](const size_t i) {
+        mSums[i] += static_cast<double>(lNew[i]) - lOld[i];
+
+        auto* lProducts = mProducts.data() + i * lCount;
+
+        for (auto j = i; j < lCount; ++j)
+            lProducts[j] += static_cast<double>(lNew[i]) * lNew[j] - static_cast<double>(lOld[i]) * lOld[j];
+    });
+}
+
+
+void CorrelationMatrix::ComputeProducts()
+{
+    const auto lCount = Count();
+    const auto lTiles = (lCount + TILE_CODES - 1) / TILE_CODES;
+
+    std::vector<size_t> lRows(lCount);
+    std::iota(lRows.begin(), lRows.end(), size_t{0});
+
+    std::for_each(std::execution::par, lRows.cbegin(), lRows.cend(), [this](const size_t i) {
+        mSums[i] = std::accumulate(Returns(i), Returns(i) + mDays, 0.0);
+    });
+
+    std::vector<std::pair<size_t, size_t>> lTilePairs;
+    lTilePairs.reserve(lTiles * (lTiles + 1) / 2);
+
+    for (size_t i = 0; i < lTiles; ++i)
+        for (auto j = i; j < lTiles; ++j)
+            lTilePairs.emplace_back(i, j);
+
+    std::fill(mProducts.begin(), mProducts.end(), 0.0);
+
+    // Every tile pair owns its own block of the upper triangle, no synchronization is needed.
+    std::for_each(std::execution::par, lTilePairs.cbegin(), lTilePairs.cend(), [this](const auto& aPair) { MultiplyTile(aPair.first, aPair.second); });
+}
+
+
+void CorrelationMatrix::MultiplyTile(const size_t aFirstTile, const size_t aSecondTile)
+{
+    const auto lCount       = Count();
+    const auto lFirstBegin  = aFirstTile * TILE_CODES;
+    const auto lFirstEnd    = std::min(lFirstBegin + TILE_CODES, lCount);
+    const auto lSecondBegin = aSecondTile * TILE_CODES;
+    const auto lSecondEnd   = std::min(lSecondBegin + TILE_CODES, lCount);
+
+    for (size_t lDay = 0; lDay < mStride; lDay += TILE_DAYS)
+    {
+        const auto lDays = std::min<size_t>(TILE_DAYS, mStride - lDay);
+
+        for (auto i = lFirstBegin; i < lFirstEnd; ++i)
+        {
+            const auto* lFirst = Returns(i) + lDay;
+            auto* lProducts    = mProducts.data() + i * lCount;
+
+            // Float partial sums over at most TILE_DAYS days, accumulated in double across the passes.
+            for (auto j = std::max(i, lSecondBegin); j < lSecondEnd; ++j)
+                lProducts[j] += Dot<LANES>(lFirst, Returns(j) + lDay, lDays);
+        }
+    }
+}
+
+
+float CorrelationMatrix::operator()(const size_t aFirst, const size_t aSecond) const
+{
+    const auto lDays   = static_cast<double>(mDays);
+    const auto lFirst  = mSums[aFirst];
+    const auto lSecond = mSums[aSecond];
+
+    const auto lCovariance = Product(aFirst, aSecond) - lFirst * lSecond / lDays;
+    const auto lVariance   = (Product(aFirst, aFirst) - lFirst * lFirst / lDays) * (Product(aSecond, aSecond) - lSecond * lSecond / lDays);
+
+    return lVariance > 0.0 ? static_cast<float>(std::clamp(lCovariance / std::sqrt(lVariance), -1.0, 1.0)) : NOT_AVAILABLE;
+}
+
+
+std::vector<float> CorrelationMatrix::UpperTriangle() const
+{
+    const auto lCount = Count();
+
+    std::vector<float> lValues(lCount * (lCount - std::min<size_t>(lCount, 1)) / 2);
+    std::vector<size_t> lRows(lCount);
+    std::iota(lRows.begin(), lRows.end(), size_t{0});
+
+    std::for_each(std::execution::par, lRows.cbegin(), lRows.cend(), [this, lCount, &lValues](const size_t i) {
+        // Rows before i hold lCount - 1 + ... + lCount - i pairs.
+        auto lValue = lValues.begin() + i * (2 * lCount - i - 1) / 2;
+
+        for (auto j = i + 1; j < lCount; ++j)
+            *lValue++ = (*this)(i, j);
+    });
+
+    return lValues;
+}
+
+
+bool CorrelationMatrix::Save(const std::filesystem::path& aPath) const
+{
+    const auto lTempPath = std::filesystem::path{aPath}.replace_extension(".tmp");
+    const auto lValues   = UpperTriangle();
+
+    auto lWritten = false;
+
+    {
+        std::ofstream lFile{lTempPath, std::ios::binary | std::ios::trunc};
+
+        const date::year_month_day lDate{mDate};
+        const auto lDateText = fmt::format(DATE_FORMAT_STR, static_cast<int>(lDate.year()), static_cast<unsigned>(lDate.month()), static_cast<unsigned>(lDate.day()));
+
+        FileHeader lHeader{FILE_MAGIC, FILE_VERSION, static_cast<uint32_t>(Count()), mDays, {}};
+        std::memcpy(lHeader.date, lDateText.data(), std::min<size_t>(lDateText.size(), CODE_SIZE));
+
+        lFile.write(reinterpret_cast<const char*>(&lHeader), sizeof(lHeader));
+
+        for (const auto& lCode : mCodes)
+        {
+            char lPadded[CODE_SIZE]{};
+            std::memcpy(lPadded, lCode.data(), std::min<size_t>(lCode.size(), CODE_SIZE));
+
+            lFile.write(lPadded, CODE_SIZE);
+        }
+
+        lFile.write(reinterpret_cast<const char*>(lValues.data()), static_cast<std::streamsize>(lValues.size() * sizeof(float)));
+        lFile.close();
+
+        lWritten = !lFile.fail();
+    }
+
+    std::error_code lErrorCode;
+
+    if (lWritten)
+        std::filesystem::rename(lTempPath, aPath, lErrorCode);
+
+    if (lWritten && !lErrorCode)
+        return true;
+
+    // A partial file is never left behind.
+    std::filesystem::remove(lTempPath, lErrorCode);
+
+    return false;
+}
+
+
+void CorrelationMatrix::Store(DataLoader& aDataLoader) const
+{
+    aDataLoader.StoreCorrelations(mDate, mDays, mCodes, UpperTriangle());
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
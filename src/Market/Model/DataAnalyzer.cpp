@@ -1,10 +1,12 @@
 #include "Market/Model/DataAnalyzer.h"
 
+#include <algorithm>
+
 #include <soci/values.h>
-#include <thrust/extrema.h>
 #include <thrust/iterator/zip_iterator.h>
 #include <thrust/tuple.h>
 
+#include "Market/Model/ColumnExpression.h"
 #include "Market/Model/DataAnalyzerImpl.h"
 
 
@@ -67,7 +69,9 @@ struct type_conversion<RowType>
 
     static void from_base(const base_type& v, indicator /*ind*/, RowType& price)
     {
-        price.Set<abollo::date_tag>(v.get<date::year_month_day>("date"));
+        // The date comes as days since the epoch, see INDEX_DAILY_SQL, a row costs no string and no std::tm. An invalid date is NULL
+        // and get throws.
+        price.Set<abollo::date_tag>(date::sys_days{date::days{v.get<int>("epoch_day")}});
 
         price.Set<abollo::seq_tag>(static_cast<float>(v.get<int>("seq")));
         price.Set<abollo::open_tag>(static_cast<float>(v.get<double>("open")));
@@ -80,30 +84,6 @@ struct type_conversion<RowType>
 };
 
 
-template <>
-struct type_conversion<date::year_month_day>
-{
-    using base_type = std::tm;
-
-    static void from_base(const base_type& in, const indicator ind, date::year_month_day& out)
-    {
-        if (ind == i_null)
-            throw soci_error("Null value not allowed for this type");
-
-        out = date::year{in.tm_year + 1900} / (in.tm_mon + 1) / in.tm_mday;
-    }
-
-    static void to_base(const date::year_month_day& in, base_type& out, indicator& ind)
-    {
-        out.tm_mday = static_cast<int>(static_cast<unsigned>(in.day()));
-        out.tm_mon  = static_cast<int>(static_cast<unsigned>(in.month()) - 1);
-        out.tm_year = static_cast<int>(static_cast<int>(in.year()) - 1900);
-
-        ind = i_ok;
-    }
-};
-
-
 // template <>
 // struct type_conversion<std::string_view>
 // {
@@ -144,21 +124,173 @@ DataAnalyzer::DataAnalyzer() : mImpl{std::make_unique<ImplType>()}
 DataAnalyzer::~DataAnalyzer() = default;
 
 
-std::pair<std::uint32_t, std::uint32_t> DataAnalyzer::LoadIndex(const std::string& aCode, const uint32_t& aOffset, const uint32_t& aLimit)
+void DataAnalyzer::Fetch(const std::string& aCode, const uint32_t aOffset, const uint32_t aLimit, PagedTableType& aPage)
+{
+    mDataLoader.LoadIndex<RowType>(aCode, aOffset, aLimit, [&aPage](const auto& aData) { aPage.push_back(aData); });
+}
+
+
+void DataAnalyzer::Trim(const bool aAppended)
 {
-    PagedTableType lPagedTable;
+    const auto lExcess = mPrices.size() - mImpl->Size();
+
+    if (lExcess > 0 && aAppended)
+    {
+        mPrices.pop_front(lExcess);
+        mIndicators.pop_front(lExcess);
+        mPrefixSums.pop_front(lExcess);
+        mPatterns.pop_front(static_cast<uint32_t>(lExcess));
+        mStatistics.pop_front(lExcess);
+    }
+    else if (lExcess > 0)
+    {
+        mPrices.pop_back(lExcess);
+        mIndicators.pop_back(lExcess);
+        mPrefixSums.pop_back(lExcess);
+        mPatterns.pop_back(static_cast<uint32_t>(lExcess));
+        mStatistics.pop_back(lExcess);
+    }
 
-    mDataLoader.LoadIndex<RowType>(aCode, aOffset, aLimit, [&lPagedTable](const auto& aData) { lPagedTable.push_back(aData); });
+    const auto lRange = mImpl->Range<seq_tag>();
 
-    mStartSeq = static_cast<uint32_t>(lPagedTable.back<seq_tag>());
-    mEndSeq   = static_cast<uint32_t>(lPagedTable.front<seq_tag>());
+    mStartSeq = static_cast<uint32_t>(lRange.second);
+    mEndSeq   = static_cast<uint32_t>(lRange.first);
+}
+
+
+std::pair<std::uint32_t, std::uint32_t> DataAnalyzer::LoadIndex(const std::string& aCode, const uint32_t& aOffset, const uint32_t& aLimit)
+{
+    const auto lPage  = mPagePool.Borrow();
+    auto& lPagedTable = *lPage;
+
+    Fetch(aCode, aOffset, aLimit, lPagedTable);
 
     mImpl->Append(lPagedTable);
+    mPrices.push_back(lPagedTable);
+    mIndicators.push_back(lPagedTable.size());
+    mPrefixSums.push_back(lPagedTable);
+    mPatterns.push_back(lPagedTable);
+    mStatistics.push_back(lPagedTable);
+
+    Trim(true);
+
+    return {mStartSeq, mEndSeq};
+}
+
+
+std::pair<std::uint32_t, std::uint32_t> DataAnalyzer::LoadRelative(const std::string& aBaseCode, const std::string& aCode, const JoinSeries aSeries, const uint32_t& aOffset,
+                                                                   const uint32_t& aLimit)
+{
+    const auto lBasePage = mPagePool.Borrow();
+    const auto lPage     = mPagePool.Borrow();
+    auto& lBaseTable     = *lBasePage;
+    auto& lPagedTable    = *lPage;
+
+    Fetch(aBaseCode, aOffset, aLimit, lBaseTable);
+    Fetch(aCode, aOffset, aLimit, lPagedTable);
+
+    const auto lJoined = JoinedTable<PagedTableType>::Join({&lBaseTable, &lPagedTable}, aSeries);
+
+    // Without common dates the rows loaded are kept, the chart never follows an empty ring.
+    if (lJoined.size() == 0)
+        return {mStartSeq, mEndSeq};
+
+    Clear();
+
+    mImpl->Append(lJoined);
+    mPrices.push_back(lJoined);
+    mIndicators.push_back(lJoined.size());
+    mPrefixSums.push_back(lJoined);
+    mPatterns.push_back(lJoined);
+    mStatistics.push_back(lJoined);
+
+    Trim(true);
 
     return {mStartSeq, mEndSeq};
 }
 
 
+BacktestResult DataAnalyzer::LoadBacktest(const std::string& aCode, const uint32_t aMinPeriod, const uint32_t aMaxPeriod, WorkStealingPool& aPool, const uint32_t& aOffset,
+                                          const uint32_t& aLimit)
+{
+    const auto lPage  = mPagePool.Borrow();
+    const auto lCurve = mPagePool.Borrow();
+    auto& lPagedTable = *lPage;
+    auto& lCurveTable = *lCurve;
+
+    Fetch(aCode, aOffset, aLimit, lPagedTable);
+
+    const Backtester lBacktester{lPagedTable};
+    const auto lResults = lBacktester.SweepCrossovers(aPool, aMinPeriod, aMaxPeriod);
+
+    // Without a curve the rows loaded are kept, the chart never follows an empty ring.
+    if (lResults.empty() || lBacktester.size() == 0)
+        return {};
+
+    Clear();
+
+    const auto lBest = *std::max_element(lResults.cbegin(), lResults.cend(), [](const BacktestResult& aFirst, const BacktestResult& aSecond) { return aFirst.sharpe < aSecond.sharpe; });
+
+    lBacktester.CrossoverCurve(lPagedTable, lBest.fastPeriod, lBest.slowPeriod, lCurveTable);
+
+    mImpl->Append(lCurveTable);
+    mPrices.push_back(lCurveTable);
+    mIndicators.push_back(lCurveTable.size());
+    mPrefixSums.push_back(lCurveTable);
+    mPatterns.push_back(lCurveTable);
+    mStatistics.push_back(lCurveTable);
+
+    Trim(true);
+
+    return lBest;
+}
+
+
+std::pair<std::uint32_t, std::uint32_t> DataAnalyzer::LoadNewer(const PagedTableType& aPage)
+{
+    assert(aPage.size() <= DEFAULT_BUFFER_COL_SIZE);
+
+    if (aPage.size() == 0)
+        return {mStartSeq, mEndSeq};
+
+    mImpl->Prepend(aPage);
+    mPrices.push_front(aPage);
+    mIndicators.push_front(aPage.size());
+    mPrefixSums.push_front(aPage);
+    mPatterns.push_front(aPage);
+    mStatistics.push_front(aPage);
+
+    Trim(false);
+
+    return {mStartSeq, mEndSeq};
+}
+
+
+bool DataAnalyzer::Revise(const date::sys_days aDate, const float aClose, const float aHigh, const float aLow)
+{
+    if (Size() == 0 || mImpl->Data().front<date_tag>() != aDate)
+        return false;
+
+    mStatistics.Update(aClose, aHigh, aLow);
+
+    return true;
+}
+
+
+void DataAnalyzer::Clear()
+{
+    mStartSeq = 0;
+    mEndSeq   = 0;
+
+    mImpl       = std::make_unique<ImplType>();
+    mPrices     = PriceColumns{};
+    mIndicators = IndicatorTable{mPrices, mIndicators.GetParameters()};
+    mPrefixSums = PrefixSumTable{};
+    mPatterns   = CandlePatterns{};
+    mStatistics = RollingStatistics{mStatistics.GetParameters()};
+}
+
+
 uint32_t DataAnalyzer::Size() const
 {
     return mImpl->Size();
@@ -183,11 +315,8 @@ std::pair<float, float> DataAnalyzer::MinMax<price_tag>(const uint32_t aStartInd
 {
     const auto lRange = Normalize(aStartIndex, aEndIndex);
 
-    const auto& lData   = mImpl->Data();
-    const auto lMinIter = thrust::min_element(lData.begin<low_tag>() + lRange.first, lData.begin<low_tag>() + lRange.second);
-    const auto lMaxIter = thrust::max_element(lData.begin<high_tag>() + lRange.first, lData.begin<high_tag>() + lRange.second);
-
-    return std::make_pair(*lMinIter, *lMaxIter);
+    // Lowest low and highest high in a single pass over both columns.
+    return abollo::MinMax(mImpl->Data(), col<low_tag>(), col<high_tag>(), mImpl->Data().Segments(lRange.first, lRange.second));
 }
 
 
@@ -205,10 +334,7 @@ std::pair<float, float> DataAnalyzer::MinMax<volume_tag>(const uint32_t aStartIn
 {
     const auto lRange = Normalize(aStartIndex, aEndIndex);
 
-    const auto& lData      = mImpl->Data();
-    const auto lMinMaxIter = thrust::minmax_element(lData.begin<volume_tag>() + lRange.first, lData.begin<volume_tag>() + lRange.second);
-
-    return std::make_pair(*lMinMaxIter.first, *lMinMaxIter.second);
+    return abollo::MinMax(mImpl->Data(), col<volume_tag>(), mImpl->Data().Segments(lRange.first, lRange.second));
 }
 
 
@@ -221,17 +347,32 @@ std::pair<float, float> DataAnalyzer::MinMax<log_volume_tag>(const uint32_t aSta
 }
 
 
+template <>
+VolumeProfile DataAnalyzer::Profile<price_tag>(const uint32_t aStartIndex, const uint32_t aEndIndex, const float aLow, const float aHigh, const uint32_t aBins) const
+{
+    const auto lRange = Normalize(aStartIndex, aEndIndex);
+
+    return abollo::Profile(mImpl->Data(), mImpl->Data().Segments(lRange.first, lRange.second), aLow, aHigh, aBins, false);
+}
+
+
+template <>
+VolumeProfile DataAnalyzer::Profile<log_price_tag>(const uint32_t aStartIndex, const uint32_t aEndIndex, const float aLow, const float aHigh, const uint32_t aBins) const
+{
+    const auto lRange = Normalize(aStartIndex, aEndIndex);
+
+    return abollo::Profile(mImpl->Data(), mImpl->Data().Segments(lRange.first, lRange.second), aLow, aHigh, aBins, true);
+}
+
+
 template <>
 DatePricePair DataAnalyzer::Saxpy<price_tag>(const uint32_t aStartIndex, const uint32_t aEndIndex, const float aScaleX, const float aTransX, const float aScaleY,
                                              const float aTransY, const float aScaleZ, const float aTransZ) const
 {
     const auto lRange = Normalize(aStartIndex, aEndIndex);
 
-    const auto& lData = mImpl->Data();
-    const auto lIter  = lData.begin();
-
     const auto& lResult =
-        mImpl->Transform(lIter + lRange.first, lIter + lRange.second, [sx = aScaleX, tx = aTransX, sy = aScaleY, ty = aTransY, sz = aScaleZ, tz = aTransZ] __device__(auto&& a) {
+        mImpl->Transform(mImpl->Data().Segments(lRange.first, lRange.second), [sx = aScaleX, tx = aTransX, sy = aScaleY, ty = aTransY, sz = aScaleZ, tz = aTransZ] __device__(auto&& a) {
             return MarketDataFields(
                 {
                     thrust::get<0>(a),    // seq
@@ -253,8 +394,10 @@ DatePricePair DataAnalyzer::Saxpy<price_tag>(const uint32_t aStartIndex, const u
                 });
         });
 
-    return std::make_pair(thrust::make_zip_iterator(thrust::make_tuple(lData.begin<date_tag>() + lRange.first, lResult.begin())),
-        thrust::make_zip_iterator(thrust::make_tuple(lData.begin<date_tag>() + lRange.second, lResult.end())));
+    const auto& lDates = mImpl->Dates();
+
+    return std::make_pair(thrust::make_zip_iterator(thrust::make_tuple(lDates.begin(), lResult.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(lDates.begin() + lResult.size(), lResult.end())));
 }
 
 
@@ -264,11 +407,8 @@ DatePricePair DataAnalyzer::Saxpy<log_price_tag>(const uint32_t aStartIndex, con
 {
     const auto lRange = Normalize(aStartIndex, aEndIndex);
 
-    const auto& lData = mImpl->Data();
-    const auto lIter  = lData.begin();
-
     const auto& lResult =
-        mImpl->Transform(lIter + lRange.first, lIter + lRange.second, [sx = aScaleX, tx = aTransX, sy = aScaleY, ty = aTransY, sz = aScaleZ, tz = aTransZ] __device__(auto&& a) {
+        mImpl->Transform(mImpl->Data().Segments(lRange.first, lRange.second), [sx = aScaleX, tx = aTransX, sy = aScaleY, ty = aTransY, sz = aScaleZ, tz = aTransZ] __device__(auto&& a) {
             return MarketDataFields(
                 {
                     thrust::get<0>(a),    // seq
@@ -290,8 +430,10 @@ DatePricePair DataAnalyzer::Saxpy<log_price_tag>(const uint32_t aStartIndex, con
                 });
         });
 
-    return std::make_pair(thrust::make_zip_iterator(thrust::make_tuple(lData.begin<date_tag>() + lRange.first, lResult.begin())),
-                          thrust::make_zip_iterator(thrust::make_tuple(lData.begin<date_tag>() + lRange.second, lResult.end())));
+    const auto& lDates = mImpl->Dates();
+
+    return std::make_pair(thrust::make_zip_iterator(thrust::make_tuple(lDates.begin(), lResult.begin())),
+                          thrust::make_zip_iterator(thrust::make_tuple(lDates.begin() + lResult.size(), lResult.end())));
 }
 
 
@@ -0,0 +1,322 @@
+#include "Market/Model/IndicatorTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr auto NOT_AVAILABLE = std::numeric_limits<float>::quiet_NaN();
+
+
+using Affine  = std::pair<double, double>;    // y -> first * y + second
+using Moments = std::pair<double, double>;    // sum of x, sum of x^2
+
+
+// y[i] = (1 - aAlpha) * y[i - 1] + aAlpha * x[i] over aCount inputs, seeded with x[0] if there is no previous y.
+// The maps y[i - 1] -> y[i] compose associatively, so the recurrence runs as a parallel scan instead of a serial loop.
+template <typename Iterator>
+void Smooth(const Iterator aInput, const size_t aCount, const double aAlpha, const std::optional<float> aPrevious, float* aOutput)
+{
+    if (aCount == 0)
+        return;
+
+    std::vector<Affine> lMaps(aCount);
+
+    std::transform(std::execution::par_unseq, aInput, aInput + aCount, lMaps.begin(), [aAlpha](const float aValue) { return Affine{1.0 - aAlpha, aAlpha * aValue}; });
+
+    if (!aPrevious)
+        lMaps.front() = {0.0, *aInput};
+
+    std::inclusive_scan(std::execution::par, lMaps.cbegin(), lMaps.cend(), lMaps.begin(),
+                        [](const Affine& aFirst, const Affine& aSecond) { return Affine{aFirst.first * aSecond.first, aSecond.first * aFirst.second + aSecond.second}; });
+
+    std::transform(std::execution::par_unseq, lMaps.cbegin(), lMaps.cend(), aOutput,
+                   [lPrevious = static_cast<double>(aPrevious.value_or(0.f))](const Affine& aMap) { return static_cast<float>(aMap.first * lPrevious + aMap.second); });
+}
+
+
+// Call aOp(i, mean, deviation) for every i in [aFrom, aTo) with the moments of the aPeriod inputs ending at i, NaN while the window is incomplete.
+// Windows are differences of prefix sums accumulated in double, so they do not drift however many rows are loaded.
+template <typename Column, typename Op>
+void RollingMoments(const Column& aInput, const size_t aFrom, const size_t aTo, const uint32_t aPeriod, Op&& aOp)
+{
+    if (aFrom >= aTo)
+        return;
+
+    const auto lBase = aFrom + 1 >= aPeriod ? aFrom + 1 - aPeriod : 0;
+
+    std::vector<Moments> lSums(aTo - lBase + 1);    // lSums[i + 1 - lBase] covers [lBase, i]
+
+    std::transform(std::execution::par_unseq, aInput.cbegin() + lBase, aInput.cbegin() + aTo, lSums.begin() + 1,
+                   [](const float aValue) { return Moments{aValue, static_cast<double>(aValue) * aValue}; });
+    std::inclusive_scan(std::execution::par, lSums.cbegin() + 1, lSums.cend(), lSums.begin() + 1,
+                        [](const Moments& aFirst, const Moments& aSecond) { return Moments{aFirst.first + aSecond.first, aFirst.second + aSecond.second}; });
+
+    for (auto i = aFrom; i < aTo; ++i)
+    {
+        if (i + 1 < aPeriod)
+        {
+            aOp(i, NOT_AVAILABLE, NOT_AVAILABLE);
+            continue;
+        }
+
+        const auto& lHead = lSums[i + 1 - lBase];
+        const auto& lTail = lSums[i + 1 - aPeriod - lBase];
+
+        const auto lMean     = (lHead.first - lTail.first) / aPeriod;
+        const auto lVariance = std::max((lHead.second - lTail.second) / aPeriod - lMean * lMean, 0.0);
+
+        aOp(i, static_cast<float>(lMean), static_cast<float>(std::sqrt(lVariance)));
+    }
+}
+
+
+// Rows after which the seed of an exponential average no longer shows in a float.
+size_t Horizon(const double aAlpha)
+{
+    return static_cast<size_t>(std::ceil(std::log(std::numeric_limits<float>::epsilon()) / std::log1p(-aAlpha)));
+}
+
+
+double EmaAlpha(const uint32_t aPeriod)
+{
+    return 2.0 / (aPeriod + 1.0);
+}
+
+
+double WilderAlpha(const uint32_t aPeriod)
+{
+    return 1.0 / aPeriod;
+}
+
+
+template <typename Column>
+std::optional<float> Previous(const Column& aColumn, const size_t aFrom)
+{
+    return aFrom > 0 ? std::optional{aColumn[aFrom - 1]} : std::nullopt;
+}
+
+
+float Sign(const float aValue)
+{
+    return static_cast<float>((aValue > 0.f) - (aValue < 0.f));
+}
+
+
+
+}    // namespace
+
+
+
+void IndicatorTable::ComputeMovingAverage(const size_t aFrom, const size_t aTo)
+{
+    auto& lSma = mColumns.Get<sma_tag>();
+
+    RollingMoments(Prices<close_tag>(), aFrom, aTo, mParameters.smaPeriod, [&lSma](const size_t aIndex, const float aMean, float) { lSma[aIndex] = aMean; });
+}
+
+
+void IndicatorTable::ComputeBollinger(const size_t aFrom, const size_t aTo)
+{
+    auto& lUpper = mColumns.Get<bollinger_upper_tag>();
+    auto& lLower = mColumns.Get<bollinger_lower_tag>();
+
+    RollingMoments(Prices<close_tag>(), aFrom, aTo, mParameters.bollingerPeriod,
+                   [&lUpper, &lLower, lWidth = mParameters.bollingerWidth](const size_t aIndex, const float aMean, const float aDeviation) {
+                       lUpper[aIndex] = aMean + lWidth * aDeviation;
+                       lLower[aIndex] = aMean - lWidth * aDeviation;
+                   });
+}
+
+
+void IndicatorTable::ComputeExponentialAverage(const size_t aFrom, const size_t aTo)
+{
+    if (aFrom >= aTo)
+        return;
+
+    auto& lEma = mColumns.Get<ema_tag>();
+
+    Smooth(Prices<close_tag>().cbegin() + aFrom, aTo - aFrom, EmaAlpha(mParameters.emaPeriod), Previous(lEma, aFrom), lEma.data() + aFrom);
+}
+
+
+void IndicatorTable::ComputeRsi(const size_t aFrom, const size_t aTo)
+{
+    if (aFrom >= aTo)
+        return;
+
+    const auto& lClose = Prices<close_tag>();
+    auto& lAvgGain     = mColumns.Get<internal::rsi_gain_tag>();
+    auto& lAvgLoss     = mColumns.Get<internal::rsi_loss_tag>();
+
+    std::vector<float> lGains(aTo - aFrom), lLosses(aTo - aFrom);
+
+    for (auto i = aFrom; i < aTo; ++i)
+    {
+        const auto lChange = i > 0 ? lClose[i] - lClose[i - 1] : 0.f;
+
+        lGains[i - aFrom]  = std::max(lChange, 0.f);
+        lLosses[i - aFrom] = std::max(-lChange, 0.f);
+    }
+
+    const auto lAlpha = WilderAlpha(mParameters.rsiPeriod);
+
+    Smooth(lGains.cbegin(), lGains.size(), lAlpha, Previous(lAvgGain, aFrom), lAvgGain.data() + aFrom);
+    Smooth(lLosses.cbegin(), lLosses.size(), lAlpha, Previous(lAvgLoss, aFrom), lAvgLoss.data() + aFrom);
+
+    std::transform(std::execution::par_unseq, lAvgGain.cbegin() + aFrom, lAvgGain.cbegin() + aTo, lAvgLoss.cbegin() + aFrom, mColumns.Get<rsi_tag>().begin() + aFrom,
+                   [](const float aGain, const float aLoss) { return aGain + aLoss > 0.f ? 100.f * aGain / (aGain + aLoss) : 50.f; });
+}
+
+
+void IndicatorTable::ComputeMacd(const size_t aFrom, const size_t aTo)
+{
+    if (aFrom >= aTo)
+        return;
+
+    const auto lClose = Prices<close_tag>().cbegin() + aFrom;
+    const auto lCount = aTo - aFrom;
+
+    auto& lFast   = mColumns.Get<internal::macd_fast_tag>();
+    auto& lSlow   = mColumns.Get<internal::macd_slow_tag>();
+    auto& lMacd   = mColumns.Get<macd_tag>();
+    auto& lSignal = mColumns.Get<macd_signal_tag>();
+
+    Smooth(lClose, lCount, EmaAlpha(mParameters.macdFastPeriod), Previous(lFast, aFrom), lFast.data() + aFrom);
+    Smooth(lClose, lCount, EmaAlpha(mParameters.macdSlowPeriod), Previous(lSlow, aFrom), lSlow.data() + aFrom);
+
+    std::transform(std::execution::par_unseq, lFast.cbegin() + aFrom, lFast.cbegin() + aTo, lSlow.cbegin() + aFrom, lMacd.begin() + aFrom, std::minus<>{});
+
+    Smooth(lMacd.cbegin() + aFrom, lCount, EmaAlpha(mParameters.macdSignalPeriod), Previous(lSignal, aFrom), lSignal.data() + aFrom);
+
+    std::transform(std::execution::par_unseq, lMacd.cbegin() + aFrom, lMacd.cbegin() + aTo, lSignal.cbegin() + aFrom, mColumns.Get<macd_histogram_tag>().begin() + aFrom,
+                   std::minus<>{});
+}
+
+
+void IndicatorTable::ComputeAtr(const size_t aFrom, const size_t aTo)
+{
+    if (aFrom >= aTo)
+        return;
+
+    const auto& lClose = Prices<close_tag>();
+    const auto& lHigh  = Prices<high_tag>();
+    const auto& lLow   = Prices<low_tag>();
+    auto& lAtr         = mColumns.Get<atr_tag>();
+
+    std::vector<float> lTrueRanges(aTo - aFrom);
+
+    for (auto i = aFrom; i < aTo; ++i)
+    {
+        const auto lRange = lHigh[i] - lLow[i];
+
+        lTrueRanges[i - aFrom] = i > 0 ? std::max({lRange, std::abs(lHigh[i] - lClose[i - 1]), std::abs(lLow[i] - lClose[i - 1])}) : lRange;
+    }
+
+    Smooth(lTrueRanges.cbegin(), lTrueRanges.size(), WilderAlpha(mParameters.atrPeriod), Previous(lAtr, aFrom), lAtr.data() + aFrom);
+}
+
+
+void IndicatorTable::ComputeObv(const size_t aFrom, const size_t aTo)
+{
+    if (aFrom >= aTo)
+        return;
+
+    const auto& lClose  = Prices<close_tag>();
+    const auto& lVolume = Prices<volume_tag>();
+    auto& lObv          = mColumns.Get<obv_tag>();
+
+    std::vector<double> lSums(aTo - aFrom);
+
+    for (auto i = aFrom; i < aTo; ++i)
+        lSums[i - aFrom] = i > 0 ? Sign(lClose[i] - lClose[i - 1]) * lVolume[i] : 0.0;
+
+    std::inclusive_scan(std::execution::par, lSums.cbegin(), lSums.cend(), lSums.begin());
+
+    std::transform(std::execution::par_unseq, lSums.cbegin(), lSums.cend(), lObv.begin() + aFrom,
+                   [lPrevious = static_cast<double>(Previous(lObv, aFrom).value_or(0.f))](const double aSum) { return static_cast<float>(lPrevious + aSum); });
+}
+
+
+void IndicatorTable::ComputeObvBackward(const size_t aCount)
+{
+    if (aCount == 0 || aCount >= size())
+        return;
+
+    const auto& lClose  = Prices<close_tag>();
+    const auto& lVolume = Prices<volume_tag>();
+    auto& lObv          = mColumns.Get<obv_tag>();
+
+    // obv[j] = obv[aCount] - (the signed volumes of the rows j + 1 .. aCount), a suffix sum.
+    std::vector<double> lSums(aCount);
+
+    for (size_t i = 1; i <= aCount; ++i)
+        lSums[i - 1] = Sign(lClose[i] - lClose[i - 1]) * lVolume[i];
+
+    std::inclusive_scan(std::execution::par, lSums.crbegin(), lSums.crend(), lSums.rbegin());
+
+    std::transform(std::execution::par_unseq, lSums.cbegin(), lSums.cend(), lObv.begin(),
+                   [lAnchor = static_cast<double>(lObv[aCount])](const double aSum) { return static_cast<float>(lAnchor - aSum); });
+}
+
+
+void IndicatorTable::ExtendNewer(const size_t aFrom)
+{
+    const auto lSize = size();
+
+    ComputeMovingAverage(aFrom, lSize);
+    ComputeBollinger(aFrom, lSize);
+    ComputeExponentialAverage(aFrom, lSize);
+    ComputeRsi(aFrom, lSize);
+    ComputeMacd(aFrom, lSize);
+    ComputeAtr(aFrom, lSize);
+    ComputeObv(aFrom, lSize);
+}
+
+
+void IndicatorTable::ExtendOlder(const size_t aCount)
+{
+    const auto lSize  = size();
+    const auto lUntil = [lSize, aCount](const size_t aReach) { return std::min(lSize, aCount + aReach); };
+
+    if (aCount == lSize)
+    {
+        ExtendNewer(0);
+        return;
+    }
+
+    ComputeMovingAverage(0, lUntil(mParameters.smaPeriod - 1));
+    ComputeBollinger(0, lUntil(mParameters.bollingerPeriod - 1));
+    ComputeExponentialAverage(0, lUntil(Horizon(EmaAlpha(mParameters.emaPeriod))));
+    ComputeRsi(0, lUntil(Horizon(WilderAlpha(mParameters.rsiPeriod))));
+    ComputeMacd(0, lUntil(Horizon(EmaAlpha(mParameters.macdSlowPeriod)) + Horizon(EmaAlpha(mParameters.macdSignalPeriod))));
+    ComputeAtr(0, lUntil(Horizon(WilderAlpha(mParameters.atrPeriod))));
+    ComputeObvBackward(aCount);
+}
+
+
+void IndicatorTable::Reset(const IndicatorParameters& aParameters)
+{
+    mParameters = aParameters;
+
+    ExtendNewer(0);
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "Market/Model/IsoDate.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+[[nodiscard]] constexpr bool IsDigit(const char aChar)
+{
+    return aChar >= '0' && aChar <= '9';
+}
+
+
+[[nodiscard]] constexpr int Digits(const char* aText, const size_t aCount)
+{
+    int lValue = 0;
+
+    for (size_t i = 0; i < aCount; ++i)
+        lValue = lValue * 10 + (aText[i] - '0');
+
+    return lValue;
+}
+
+
+
+}    // namespace
+
+
+
+bool ParseIsoDate(const char* aText, const size_t aLength, date::sys_days& aDate)
+{
+    constexpr char lLayout[] = "0000-00-00";
+    constexpr auto lSize     = sizeof(lLayout) - 1;
+
+    if (aLength < lSize)
+        return false;
+
+    for (size_t i = 0; i < lSize; ++i)
+        if (lLayout[i] == '-' ? aText[i] != '-' : !IsDigit(aText[i]))
+            return false;
+
+    const auto lDate = date::year{Digits(aText, 4)} / Digits(aText + 5, 2) / Digits(aText + 8, 2);
+
+    if (!lDate.ok())
+        return false;
+
+    aDate = date::sys_days{lDate};
+    return true;
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
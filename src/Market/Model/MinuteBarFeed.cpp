@@ -0,0 +1,47 @@
+#include "Market/Model/MinuteBarFeed.h"
+
+
+
+namespace abollo
+{
+
+
+
+void MinuteBarFeed::Post(const BarInterval aInterval, const MinuteBar& aBar)
+{
+    Flush();
+
+    if (const IntervalBar lBar{aInterval, aBar}; !mOverflow.empty() || !mBars.TryPush(lBar))
+        mOverflow.push_back(lBar);
+}
+
+
+bool MinuteBarFeed::Flush()
+{
+    while (!mOverflow.empty() && mBars.TryPush(mOverflow.front()))
+        mOverflow.pop_front();
+
+    return mOverflow.empty();
+}
+
+
+uint32_t MinuteBarFeed::Drain(BarTables& aTables)
+{
+    uint32_t lCount = 0;
+
+    for (; lCount < BAR_QUEUE_CAPACITY; ++lCount)
+    {
+        const auto lBar = mBars.TryPop();
+
+        if (!lBar)
+            break;
+
+        aTables[static_cast<size_t>(lBar->interval)].Update(lBar->bar);
+    }
+
+    return lCount;
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
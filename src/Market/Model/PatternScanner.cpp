@@ -0,0 +1,92 @@
+#include "Market/Model/PatternScanner.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+#include "Market/Model/DataLoader.h"
+#include "Utility/WorkStealingPool.h"
+
+
+
+namespace abollo
+{
+
+
+
+PatternScanner PatternScanner::Load(DataLoader& aDataLoader, const uint32_t aDays)
+{
+    struct Row
+    {
+        uint32_t code;
+        uint32_t date;
+        float open;
+        float close;
+        float low;
+        float high;
+    };
+
+    // Codes are numbered as they come and sorted once every candle is in.
+    std::unordered_map<std::string, uint32_t> lIndices;
+    std::vector<std::string> lCodes;
+    std::vector<Row> lRows;
+
+    PatternScanner lScanner;
+
+    aDataLoader.LoadCandles("", aDays, [&](const std::string& aCode, const std::string& aDate, const float aOpen, const float aClose, const float aLow, const float aHigh) {
+        if (lScanner.mDates.empty() || lScanner.mDates.back() != aDate)
+            lScanner.mDates.push_back(aDate);
+
+        const auto [lIndex, lInserted] = lIndices.try_emplace(aCode, static_cast<uint32_t>(lCodes.size()));
+
+        if (lInserted)
+            lCodes.push_back(aCode);
+
+        lRows.push_back({lIndex->second, static_cast<uint32_t>(lScanner.mDates.size() - 1), aOpen, aClose, aLow, aHigh});
+    });
+
+    std::vector<uint32_t> lOrder(lCodes.size());
+    std::iota(lOrder.begin(), lOrder.end(), 0u);
+    std::sort(lOrder.begin(), lOrder.end(), [&lCodes](const uint32_t aFirst, const uint32_t aSecond) { return lCodes[aFirst] < lCodes[aSecond]; });
+
+    std::vector<uint32_t> lRanks(lCodes.size());
+
+    for (uint32_t i = 0; i < lOrder.size(); ++i)
+    {
+        lRanks[lOrder[i]] = i;
+        lScanner.mCodes.push_back(std::move(lCodes[lOrder[i]]));
+    }
+
+    lScanner.mPatterns.resize(lScanner.mCodes.size());
+
+    for (auto& lPatterns : lScanner.mPatterns)
+        lPatterns.Resize(static_cast<uint32_t>(lScanner.mDates.size()));
+
+    for (const auto& lRow : lRows)
+        lScanner.mPatterns[lRanks[lRow.code]].Set(lRow.date, lRow.open, lRow.close, lRow.low, lRow.high);
+
+    return lScanner;
+}
+
+
+void PatternScanner::Scan(WorkStealingPool& aPool)
+{
+    aPool.ForEach(mPatterns.size(), SCAN_GRAIN, [this](const size_t i, const size_t) { mPatterns[i].Scan(); });
+}
+
+
+std::vector<PatternMatch> PatternScanner::Matches(const uint32_t aDate) const
+{
+    std::vector<PatternMatch> lMatches;
+
+    for (size_t i = 0; i < mCodes.size(); ++i)
+        for (size_t p = 0; p < PATTERN_COUNT; ++p)
+            if (const auto lPattern = static_cast<CandlePattern>(p); mPatterns[i].Test(lPattern, aDate))
+                lMatches.push_back({mCodes[i], mDates[aDate], lPattern});
+
+    return lMatches;
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
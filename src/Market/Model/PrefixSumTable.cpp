@@ -0,0 +1,51 @@
+#include "Market/Model/PrefixSumTable.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+
+
+
+namespace abollo
+{
+
+
+
+void PrefixSumTable::ExtendNewer(DoubleEndedVector<double>& aSums, const std::vector<double>& aValues)
+{
+    const auto lFrom = aSums.size();
+
+    aSums.append_n(aValues.size(), 0.0);
+
+    std::inclusive_scan(std::execution::par, aValues.cbegin(), aValues.cend(), aSums.begin() + lFrom, std::plus<>{}, aSums[lFrom - 1]);
+}
+
+
+void PrefixSumTable::ExtendOlder(DoubleEndedVector<double>& aSums, const std::vector<double>& aValues)
+{
+    const auto lCount = aValues.size();
+
+    // The slots before the old first row are reused, the rows already summed do not move.
+    aSums.prepend_n(lCount, 0.0);
+
+    // sums[j] = sums[count] - (rows j .. count - 1), a suffix scan from the old first row downwards.
+    std::inclusive_scan(std::execution::par, aValues.crbegin(), aValues.crend(), aSums.rend() - lCount);
+    std::transform(std::execution::par_unseq, aSums.cbegin(), aSums.cbegin() + lCount, aSums.begin(), [lAnchor = aSums[lCount]](const double aSuffix) { return lAnchor - aSuffix; });
+}
+
+
+void PrefixSumTable::DropNewer(DoubleEndedVector<double>& aSums, const size_t aCount)
+{
+    aSums.drop_back(aCount);
+}
+
+
+void PrefixSumTable::DropOlder(DoubleEndedVector<double>& aSums, const size_t aCount)
+{
+    // The sum before the new oldest row becomes the anchor, no total is recomputed.
+    aSums.drop_front(aCount);
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "Market/Model/QueryProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <fmt/format.h>
+#include <soci/soci.h>
+
+#include "Utility/Stopwatch.h"
+
+
+
+namespace abollo
+{
+
+
+
+uint32_t LatencyHistogram::BucketIndex(const uint64_t aValue)
+{
+    if (aValue < SUB_BUCKET_COUNT)
+        return static_cast<uint32_t>(aValue);
+
+    uint32_t lMsb = SUB_BUCKET_BITS;
+
+    while ((aValue >> (lMsb + 1)) != 0)
+        ++lMsb;
+
+    const auto lShift = lMsb - SUB_BUCKET_BITS;
+
+    return (lShift + 1) * SUB_BUCKET_COUNT + static_cast<uint32_t>((aValue >> lShift) & SUB_BUCKET_MASK);
+}
+
+
+uint64_t LatencyHistogram::BucketLowest(const uint32_t aIndex)
+{
+    if (aIndex < SUB_BUCKET_COUNT)
+        return aIndex;
+
+    const auto lShift = aIndex / SUB_BUCKET_COUNT - 1;
+
+    return static_cast<uint64_t>((aIndex & SUB_BUCKET_MASK) | SUB_BUCKET_COUNT) << lShift;
+}
+
+
+void LatencyHistogram::Record(const uint64_t aMicroseconds)
+{
+    constexpr uint64_t MAX_VALUE = (uint64_t{1} << MAX_VALUE_BITS) - 1;
+
+    const auto lValue = std::min(aMicroseconds, MAX_VALUE);
+
+    ++mCounts[BucketIndex(lValue)];
+    ++mTotalCount;
+
+    mMin = std::min(mMin, lValue);
+    mMax = std::max(mMax, lValue);
+    mSum += static_cast<double>(lValue);
+}
+
+
+uint64_t LatencyHistogram::Percentile(const double aPercentile) const
+{
+    if (mTotalCount == 0)
+        return 0;
+
+    const auto lTarget = std::max(uint64_t{1}, static_cast<uint64_t>(std::ceil(aPercentile / 100.0 * static_cast<double>(mTotalCount))));
+
+    uint64_t lCount = 0;
+
+    for (uint32_t lIndex = 0; lIndex < BUCKET_COUNT; ++lIndex)
+    {
+        lCount += mCounts[lIndex];
+
+        if (lCount >= lTarget)
+            return std::clamp(BucketLowest(lIndex), Min(), mMax);
+    }
+
+    return mMax;
+}
+
+
+
+void ProfilingLogger::start_query(const std::string& aQuery)
+{
+    mLastQuery = aQuery;
+
+    QueryProfiler::Instance().OnQuery(aQuery);
+}
+
+
+
+QueryProfiler::~QueryProfiler()
+{
+    if (!mStatements.empty())
+        Report(std::clog);
+}
+
+
+soci::session& QueryProfiler::Attach(soci::session& aSession)
+{
+    aSession.set_logger(new ProfilingLogger);
+
+    return aSession;
+}
+
+
+soci::statement QueryProfiler::Prepare(soci::session& aSession, const std::string& aQuery)
+{
+    const Stopwatch lStopwatch;
+
+    soci::statement lStatement = (aSession.prepare << aQuery);
+
+    Instance().Record(aQuery, Phase::ePrepare, lStopwatch.Elapsed());
+
+    return lStatement;
+}
+
+
+void QueryProfiler::OnQuery(const std::string& aQuery)
+{
+    if (aQuery.rfind(EXPLAIN_PREFIX, 0) == 0)
+        return;
+
+    std::lock_guard lLock{mMutex};
+
+    ++mStatements[aQuery].prepares;
+}
+
+
+void QueryProfiler::Record(const std::string& aQuery, const Phase aPhase, const double aMilliseconds)
+{
+    std::lock_guard lLock{mMutex};
+
+    mStatements[aQuery].latencies[static_cast<size_t>(aPhase)].Record(static_cast<uint64_t>(aMilliseconds * 1000.0 + 0.5));
+}
+
+
+void QueryProfiler::RecordExecution(soci::session& aSession, const std::string& aQuery, std::string aBindings, const double aExecuteMs, const double aFetchMs,
+                                    const uint64_t aRows)
+{
+    {
+        std::lock_guard lLock{mMutex};
+
+        auto& lStats = mStatements[aQuery];
+
+        lStats.latencies[static_cast<size_t>(Phase::eExecute)].Record(static_cast<uint64_t>(aExecuteMs * 1000.0 + 0.5));
+        lStats.latencies[static_cast<size_t>(Phase::eFetch)].Record(static_cast<uint64_t>(aFetchMs * 1000.0 + 0.5));
+
+        ++lStats.executions;
+        lStats.rows += aRows;
+        lStats.lastBindings = std::move(aBindings);
+    }
+
+    if (ShouldExplain(aQuery))
+        Explain(aSession, aQuery);
+}
+
+
+bool QueryProfiler::ShouldExplain(const std::string& aQuery)
+{
+    std::lock_guard lLock{mMutex};
+
+    auto& lStats = mStatements[aQuery];
+
+    if (lStats.planExplained)
+        return false;
+
+    lStats.planExplained = true;
+
+    return true;
+}
+
+
+void QueryProfiler::Explain(soci::session& aSession, const std::string& aQuery)
+{
+    // The statement runs through the same session (and logger), so the lock must not be held while querying.
+    std::vector<std::string> lPlan;
+    bool lFullScan = false;
+
+    try
+    {
+        const soci::rowset<soci::row> lRows = (aSession.prepare << EXPLAIN_PREFIX + aQuery);
+
+        for (const auto& lRow : lRows)
+        {
+            // Columns are (id, parent, notused, detail), a full table scan is reported as "SCAN <table>".
+            auto lDetail = lRow.get<std::string>(lRow.size() - 1);
+
+            if (lDetail.rfind("SCAN", 0) == 0)
+                lFullScan = true;
+
+            lPlan.emplace_back(std::move(lDetail));
+        }
+    }
+    catch (const std::exception& aException)
+    {
+        lPlan.emplace_back(fmt::format("EXPLAIN QUERY PLAN failed: {}", aException.what()));
+    }
+
+    std::lock_guard lLock{mMutex};
+
+    auto& lStats = mStatements[aQuery];
+
+    lStats.plan     = std::move(lPlan);
+    lStats.fullScan = lFullScan;
+}
+
+
+void QueryProfiler::Report(std::ostream& aStream) const
+{
+    constexpr std::array<const char*, static_cast<size_t>(Phase::eCount)> lPhaseNames{"prepare", "execute", "fetch"};
+
+    const auto lToMs = [](const uint64_t aMicroseconds) { return static_cast<double>(aMicroseconds) / 1000.0; };
+
+    std::lock_guard lLock{mMutex};
+
+    aStream << fmt::format("SQL profile: {} statement(s)\n", mStatements.size());
+
+    for (const auto& [lQuery, lStats] : mStatements)
+    {
+        aStream << fmt::format("\n{}{}\n", lStats.fullScan ? "[FULL SCAN] " : "", lQuery);
+        aStream << fmt::format("    prepares: {}, executions: {}, rows: {}\n", lStats.prepares, lStats.executions, lStats.rows);
+
+        if (!lStats.lastBindings.empty())
+            aStream << fmt::format("    last bindings: {}\n", lStats.lastBindings);
+
+        aStream << fmt::format("    {:<8}{:>8}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10} (ms)\n", "phase", "count", "min", "p50", "p90", "p99", "max", "mean");
+
+        for (size_t lPhase = 0; lPhase < lPhaseNames.size(); ++lPhase)
+        {
+            const auto& lHistogram = lStats.latencies[lPhase];
+
+            if (lHistogram.Count() == 0)
+                continue;
+
+            aStream << fmt::format("    {:<8}{:>8}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}{:>10.3f}\n", lPhaseNames[lPhase], lHistogram.Count(), lToMs(lHistogram.Min()),
+                                   lToMs(lHistogram.Percentile(50.0)), lToMs(lHistogram.Percentile(90.0)), lToMs(lHistogram.Percentile(99.0)), lToMs(lHistogram.Max()),
+                                   lHistogram.Mean() / 1000.0);
+        }
+
+        for (const auto& lDetail : lStats.plan)
+            aStream << fmt::format("    plan: {}\n", lDetail);
+    }
+
+    aStream.flush();
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
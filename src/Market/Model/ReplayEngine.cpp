@@ -0,0 +1,108 @@
+#include "Market/Model/ReplayEngine.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+// Rows [first, first + count) of a table, for PagedMarketingTable::append.
+template <typename U>
+struct RowRange
+{
+    const U& table;
+    uint32_t first;
+    uint32_t count;
+
+    template <typename Tag>
+    [[nodiscard]] auto begin() const
+    {
+        return table.template begin<Tag>() + first;
+    }
+
+    [[nodiscard]] uint32_t size() const
+    {
+        return count;
+    }
+};
+
+
+
+}    // namespace
+
+
+
+ReplayEngine::ReplayEngine(DataAnalyzer& aDataAnalyzer, const std::string& aCode, const uint32_t aOffset, const uint32_t aLimit, const uint32_t aWarmUp,
+                           const double aSpeed)
+    : mDataAnalyzer{aDataAnalyzer}, mSpeed{aSpeed}, mLastUpdate{Clock::now()}
+{
+    assert(aSpeed > 0.);
+
+    mDataAnalyzer.Fetch(aCode, aOffset, aLimit, mBars);
+
+    if (mBars.size() == 0)
+        throw std::runtime_error(fmt::format("No bars of {} to replay.", aCode));
+
+    mDataAnalyzer.Clear();
+
+    mPending = mBars.size();
+
+    Play(std::max(aWarmUp, 1u));
+}
+
+
+uint32_t ReplayEngine::Play(const uint32_t aCount)
+{
+    const auto lCount = std::min(aCount, mPending);
+
+    // mBars is newest first, the next bars are the oldest pending ones, the last rows of mBars[0, mPending).
+    for (uint32_t lPlayed = 0; lPlayed < lCount;)
+    {
+        const auto lBatch = std::min(lCount - lPlayed, MAX_BATCH);
+
+        mBatch.reset();
+        mBatch.append(RowRange<DataAnalyzer::PagedTableType>{mBars, mPending - lBatch, lBatch});
+
+        mDataAnalyzer.LoadNewer(mBatch);
+
+        mPending -= lBatch;
+        lPlayed += lBatch;
+    }
+
+    return lCount;
+}
+
+
+uint32_t ReplayEngine::Update()
+{
+    const auto lNow     = Clock::now();
+    const auto lElapsed = std::chrono::duration<double>{lNow - mLastUpdate}.count();
+
+    mLastUpdate = lNow;
+
+    if (mPaused || Finished())
+        return 0;
+
+    // A frame late by seconds would otherwise play them all at once.
+    mDue = std::min(mDue + lElapsed * mSpeed, std::max(MAX_CATCH_UP * mSpeed, 1.));
+
+    const auto lCount = static_cast<uint32_t>(mDue);
+    mDue -= lCount;
+
+    return Play(lCount);
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "Market/Model/RollingStatistics.h"
+
+#include <cassert>
+#include <limits>
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr auto NOT_AVAILABLE = std::numeric_limits<float>::quiet_NaN();
+
+
+
+}    // namespace
+
+
+
+double RollingStatistics::Return(const size_t aIndex) const
+{
+    const auto& lClose = mColumns.Get<close_tag>();
+
+    return aIndex > 0 && lClose[aIndex - 1] > 0.f && lClose[aIndex] > 0.f ? std::log(static_cast<double>(lClose[aIndex]) / lClose[aIndex - 1])
+                                                                          : std::numeric_limits<double>::quiet_NaN();
+}
+
+
+void RollingStatistics::Settle(Accumulators& aAccumulators, const size_t aIndex) const
+{
+    const auto lRow   = mFirstRow + static_cast<int64_t>(aIndex);
+    const auto lClose = mColumns.Get<close_tag>()[aIndex];
+
+    // The row that leaves a window of aPeriod rows when the row after aIndex joins it, if it was ever added.
+    const auto lLeaving = [this, &aAccumulators, aIndex](const uint32_t aPeriod) {
+        return aIndex + 1 >= aPeriod && mFirstRow + static_cast<int64_t>(aIndex + 1 - aPeriod) >= aAccumulators.first ? aIndex + 1 - aPeriod : size();
+    };
+
+    if (const auto lReturn = Return(aIndex); !std::isnan(lReturn))
+        aAccumulators.returns.Add(lReturn);
+
+    aAccumulators.closes.Add(lClose);
+    aAccumulators.highs.Push(lRow, mColumns.Get<high_tag>()[aIndex]);
+    aAccumulators.lows.Push(lRow, mColumns.Get<low_tag>()[aIndex]);
+    aAccumulators.peaks.Push(lRow, lClose);
+
+    if (const auto lIndex = lLeaving(mParameters.volatilityPeriod); lIndex < size())
+        if (const auto lReturn = Return(lIndex); !std::isnan(lReturn))
+            aAccumulators.returns.Remove(lReturn);
+
+    if (const auto lIndex = lLeaving(mParameters.zscorePeriod); lIndex < size())
+        aAccumulators.closes.Remove(mColumns.Get<close_tag>()[lIndex]);
+
+    aAccumulators.highs.Expire(lRow + 2 - mParameters.rangePeriod);
+    aAccumulators.lows.Expire(lRow + 2 - mParameters.rangePeriod);
+    aAccumulators.peaks.Expire(lRow + 2 - mParameters.drawdownPeriod);
+}
+
+
+void RollingStatistics::Evaluate(const Accumulators& aAccumulators, const size_t aIndex)
+{
+    const auto lClose = mColumns.Get<close_tag>()[aIndex];
+
+    auto lVolatility = NOT_AVAILABLE;
+
+    if (const auto lReturn = Return(aIndex); !std::isnan(lReturn))
+        if (const auto lReturns = aAccumulators.returns.With(lReturn); lReturns.Count() == mParameters.volatilityPeriod)
+            lVolatility = static_cast<float>(std::sqrt(lReturns.Variance() * mParameters.annualization));
+
+    auto lZScore = NOT_AVAILABLE;
+
+    if (const auto lCloses = aAccumulators.closes.With(lClose); lCloses.Count() == mParameters.zscorePeriod && lCloses.Variance() > 0.0)
+        lZScore = static_cast<float>((lClose - lCloses.Mean()) / std::sqrt(lCloses.Variance()));
+
+    const auto lPeak = aAccumulators.peaks.With(lClose);
+
+    mColumns.Get<volatility_tag>()[aIndex]   = lVolatility;
+    mColumns.Get<zscore_tag>()[aIndex]       = lZScore;
+    mColumns.Get<rolling_high_tag>()[aIndex] = aAccumulators.highs.With(mColumns.Get<high_tag>()[aIndex]);
+    mColumns.Get<rolling_low_tag>()[aIndex]  = aAccumulators.lows.With(mColumns.Get<low_tag>()[aIndex]);
+    mColumns.Get<drawdown_tag>()[aIndex]     = lPeak > 0.f ? lClose / lPeak - 1.f : NOT_AVAILABLE;
+}
+
+
+void RollingStatistics::Compute(const size_t aFrom, const size_t aTo)
+{
+    if (aFrom >= aTo)
+        return;
+
+    // Settle the rows before aFrom that the widest window reaches, then run the range forward.
+    const auto lStart = aFrom - std::min<size_t>(aFrom, Reach() - 1);
+
+    Accumulators lAccumulators;
+    lAccumulators.first = mFirstRow + static_cast<int64_t>(lStart);
+
+    for (auto i = lStart; i < aFrom; ++i)
+        Settle(lAccumulators, i);
+
+    for (auto i = aFrom; i < aTo; ++i)
+    {
+        if (i > aFrom)
+            Settle(lAccumulators, i - 1);
+
+        Evaluate(lAccumulators, i);
+    }
+
+    if (aTo == size())
+        mAccumulators = std::move(lAccumulators);
+}
+
+
+void RollingStatistics::pop_back(const size_t aCount)
+{
+    assert(aCount <= size());
+
+    mColumns.DropFront(aCount, ColumnsSchema{});
+    mFirstRow += static_cast<int64_t>(aCount);
+
+    // Rows leaving the windows later are read back from the columns, they must not be among the rows dropped.
+    if (size() > 0 && size() < Reach())
+        Compute(size() - 1, size());
+}
+
+
+void RollingStatistics::pop_front(const size_t aCount)
+{
+    assert(aCount <= size());
+
+    mColumns.DropBack(aCount, ColumnsSchema{});
+
+    if (size() == 0)
+        mAccumulators = {};
+    else
+        Compute(size() - 1, size());
+}
+
+
+void RollingStatistics::Update(const float aClose, const float aHigh, const float aLow)
+{
+    if (size() == 0)
+        return;
+
+    const auto lNewest = size() - 1;
+
+    mColumns.Get<close_tag>()[lNewest] = aClose;
+    mColumns.Get<high_tag>()[lNewest]  = aHigh;
+    mColumns.Get<low_tag>()[lNewest]   = aLow;
+
+    Evaluate(mAccumulators, lNewest);
+}
+
+
+void RollingStatistics::Recompute()
+{
+    Compute(0, size());
+}
+
+
+void RollingStatistics::Reset(const RollingParameters& aParameters)
+{
+    mParameters = aParameters;
+
+    Recompute();
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,861 @@
+#include "Market/Model/Screener.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "Market/Model/DataLoader.h"
+#include "Market/Model/RollingStatistics.h"
+#include "Utility/WorkStealingPool.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr auto NOT_AVAILABLE = std::numeric_limits<float>::quiet_NaN();
+
+// Periods an exponential average looks back before the weight of older rows drops below e^-10.
+constexpr uint32_t EMA_SPAN = 5;
+constexpr uint32_t RSI_SPAN = 10;
+
+constexpr std::array<std::string_view, SCREEN_FIELD_COUNT> FIELD_NAMES{"open", "close", "low", "high", "volume", "amount"};
+
+
+// Codes of aSelection that are not in aRemoved, both sorted.
+void Difference(const std::vector<uint32_t>& aSelection, const std::vector<uint32_t>& aRemoved, std::vector<uint32_t>& aResult)
+{
+    aResult.clear();
+    std::set_difference(aSelection.cbegin(), aSelection.cend(), aRemoved.cbegin(), aRemoved.cend(), std::back_inserter(aResult));
+}
+
+
+// Keep the codes of aSelection for which aCompare holds, without a branch per code.
+template <typename Compare>
+void Filter(const std::vector<uint32_t>& aSelection, const std::vector<float>& aLeft, const std::vector<float>& aRight, std::vector<uint32_t>& aResult, Compare aCompare)
+{
+    aResult.resize(aSelection.size());
+
+    size_t k = 0;
+
+    for (size_t i = 0; i < aSelection.size(); ++i)
+    {
+        aResult[k] = aSelection[i];
+        k += aCompare(aLeft[i], aRight[i]) ? 1 : 0;
+    }
+
+    aResult.resize(k);
+}
+
+
+// aReduce over the last aPeriod bars of every code of aSelection, NaN as soon as one of them is missing.
+template <typename Reduce>
+void Window(const ScreenUniverse& aUniverse, const ScreenField aField, const uint32_t aPeriod, const std::vector<uint32_t>& aSelection, std::vector<float>& aValues,
+            Reduce aReduce)
+{
+    const auto lFirst = aUniverse.Days() - aPeriod;
+
+    for (size_t i = 0; i < aSelection.size(); ++i)
+        aValues[i] = aReduce(aUniverse.Bars(aField, aSelection[i]) + lFirst, aPeriod);
+}
+
+
+
+}    // namespace
+
+
+
+ScreenUniverse ScreenUniverse::Load(DataLoader& aDataLoader, const uint32_t aDays, const std::string& aFilter)
+{
+    struct Row
+    {
+        uint32_t code;
+        uint32_t date;
+        std::array<float, SCREEN_FIELD_COUNT> fields;
+    };
+
+    std::unordered_map<std::string, uint32_t> lIndices;
+    std::vector<std::string> lCodes;
+    std::vector<Row> lRows;
+
+    ScreenUniverse lUniverse;
+
+    aDataLoader.LoadBars(aFilter, aDays,
+                         [&](const std::string& aCode, const std::string& aDate, const float aOpen, const float aClose, const float aLow, const float aHigh, const float aVolume,
+                             const float aAmount) {
+                             if (lUniverse.mDates.empty() || lUniverse.mDates.back() != aDate)
+                                 lUniverse.mDates.push_back(aDate);
+
+                             const auto [lIndex, lInserted] = lIndices.try_emplace(aCode, static_cast<uint32_t>(lCodes.size()));
+
+                             if (lInserted)
+                                 lCodes.push_back(aCode);
+
+                             lRows.push_back({lIndex->second, static_cast<uint32_t>(lUniverse.mDates.size() - 1), {aOpen, aClose, aLow, aHigh, aVolume, aAmount}});
+                         });
+
+    std::vector<uint32_t> lOrder(lCodes.size());
+    std::iota(lOrder.begin(), lOrder.end(), 0u);
+    std::sort(lOrder.begin(), lOrder.end(), [&lCodes](const uint32_t aFirst, const uint32_t aSecond) { return lCodes[aFirst] < lCodes[aSecond]; });
+
+    std::vector<uint32_t> lRanks(lCodes.size());
+
+    for (uint32_t i = 0; i < lOrder.size(); ++i)
+    {
+        lRanks[lOrder[i]] = i;
+        lUniverse.mCodes.push_back(std::move(lCodes[lOrder[i]]));
+    }
+
+    lUniverse.mDays = static_cast<uint32_t>(lUniverse.mDates.size());
+
+    for (auto& lColumn : lUniverse.mColumns)
+        lColumn.assign(lUniverse.mCodes.size() * lUniverse.mDays, NOT_AVAILABLE);
+
+    for (const auto& lRow : lRows)
+        for (size_t f = 0; f < SCREEN_FIELD_COUNT; ++f)
+            lUniverse.mColumns[f][lRanks[lRow.code] * lUniverse.mDays + lRow.date] = lRow.fields[f];
+
+    return lUniverse;
+}
+
+
+
+// Recursive descent over the screen text, one node per operator, appended to the plan of the screen.
+class ScreenParser final
+{
+private:
+    enum class TokenKind : uint8_t
+    {
+        eEnd,
+        eNumber,
+        eWord,
+        eSymbol
+    };
+
+    using Op   = Screen::Op;
+    using Node = Screen::Node;
+
+    std::string_view mText;
+    size_t mPosition{0};
+    Screen& mScreen;
+
+    TokenKind mKind{TokenKind::eEnd};
+    std::string mToken;    // Words are lower case.
+    size_t mOffset{0};
+    float mNumber{0.f};
+
+    [[noreturn]] void Fail(const std::string_view aMessage) const
+    {
+        throw std::invalid_argument(fmt::format("Screen error at offset {}: {}.", mOffset, aMessage));
+    }
+
+    void Next()
+    {
+        while (mPosition < mText.size() && std::isspace(static_cast<unsigned char>(mText[mPosition])))
+            ++mPosition;
+
+        mOffset = mPosition;
+        mToken.clear();
+
+        if (mPosition == mText.size())
+        {
+            mKind = TokenKind::eEnd;
+            return;
+        }
+
+        const auto lChar = static_cast<unsigned char>(mText[mPosition]);
+
+        if (std::isdigit(lChar) || lChar == '.')
+        {
+            const std::string lText{mText.substr(mPosition)};
+            char* lpEnd = nullptr;
+
+            mNumber = std::strtof(lText.c_str(), &lpEnd);
+            mPosition += lpEnd - lText.c_str();
+            mKind = TokenKind::eNumber;
+        }
+        else if (std::isalpha(lChar) || lChar == '_')
+        {
+            for (; mPosition < mText.size() && (std::isalnum(static_cast<unsigned char>(mText[mPosition])) || mText[mPosition] == '_'); ++mPosition)
+                mToken.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(mText[mPosition]))));
+
+            mKind = TokenKind::eWord;
+        }
+        else
+        {
+            constexpr std::string_view lPairs[]{"<=", ">=", "==", "!=", "<>"};
+
+            const auto lPair = mText.substr(mPosition, 2);
+            const auto lSize = std::find(std::begin(lPairs), std::end(lPairs), lPair) != std::end(lPairs) ? 2u : 1u;
+
+            mToken = mText.substr(mPosition, lSize);
+            mPosition += lSize;
+            mKind = TokenKind::eSymbol;
+        }
+    }
+
+    bool Accept(const std::string_view aToken)
+    {
+        if (mKind == TokenKind::eNumber || mToken != aToken)
+            return false;
+
+        Next();
+        return true;
+    }
+
+    void Expect(const std::string_view aToken)
+    {
+        if (!Accept(aToken))
+            Fail(fmt::format("expected '{}'", aToken));
+    }
+
+    uint32_t Integer(const uint32_t aMinimum = 1)
+    {
+        if (mKind != TokenKind::eNumber || mNumber < static_cast<float>(aMinimum) || mNumber != std::floor(mNumber))
+            Fail(fmt::format("expected a whole number of at least {}", aMinimum));
+
+        const auto lValue = static_cast<uint32_t>(mNumber);
+        Next();
+
+        return lValue;
+    }
+
+    ScreenField Field()
+    {
+        const auto lField = std::find(FIELD_NAMES.cbegin(), FIELD_NAMES.cend(), mToken);
+
+        if (mKind != TokenKind::eWord || lField == FIELD_NAMES.cend())
+            Fail("expected a column");
+
+        Next();
+
+        return static_cast<ScreenField>(lField - FIELD_NAMES.cbegin());
+    }
+
+    uint32_t Add(const Node& aNode)
+    {
+        mScreen.mNodes.push_back(aNode);
+
+        return static_cast<uint32_t>(mScreen.mNodes.size() - 1);
+    }
+
+    [[nodiscard]] const Node& At(const uint32_t aNode) const
+    {
+        return mScreen.mNodes[aNode];
+    }
+
+    uint32_t Numeric(const uint32_t aNode) const
+    {
+        if (Screen::IsPredicate(At(aNode).op))
+            Fail("expected a value, not a condition");
+
+        return aNode;
+    }
+
+    uint32_t Predicate(const uint32_t aNode) const
+    {
+        if (!Screen::IsPredicate(At(aNode).op))
+            Fail("expected a condition, not a value");
+
+        return aNode;
+    }
+
+    // Arithmetic on two constants is folded into a constant, so that it can be pushed down.
+    uint32_t Arithmetic(const Op aOp, const uint32_t aLeft, const uint32_t aRight)
+    {
+        Numeric(aLeft);
+        Numeric(aRight);
+
+        if (At(aLeft).op != Op::eConstant || At(aRight).op != Op::eConstant)
+            return Add({aOp, ScreenField::eClose, 0, 0.f, aLeft, aRight});
+
+        const auto lLeft  = At(aLeft).value;
+        const auto lRight = At(aRight).value;
+
+        mScreen.mNodes.resize(std::min(aLeft, aRight));
+
+        switch (aOp)
+        {
+        case Op::eAdd:
+            return Add({Op::eConstant, ScreenField::eClose, 0, lLeft + lRight});
+        case Op::eSubtract:
+            return Add({Op::eConstant, ScreenField::eClose, 0, lLeft - lRight});
+        case Op::eMultiply:
+            return Add({Op::eConstant, ScreenField::eClose, 0, lLeft * lRight});
+        default:
+            return Add({Op::eConstant, ScreenField::eClose, 0, lLeft / lRight});
+        }
+    }
+
+    uint32_t Primary()
+    {
+        if (mKind == TokenKind::eNumber)
+        {
+            const auto lValue = mNumber;
+            Next();
+
+            return Add({Op::eConstant, ScreenField::eClose, 0, lValue});
+        }
+
+        if (Accept("("))
+        {
+            const auto lNode = Or();
+            Expect(")");
+
+            return lNode;
+        }
+
+        if (mKind != TokenKind::eWord)
+            Fail("expected a value");
+
+        const auto lWord = mToken;
+
+        if (std::find(FIELD_NAMES.cbegin(), FIELD_NAMES.cend(), lWord) != FIELD_NAMES.cend())
+            return Add({Op::eColumn, Field()});
+
+        const std::unordered_map<std::string_view, Op> lWindows{{"sma", Op::eSma}, {"avg", Op::eSma}, {"ema", Op::eEma}, {"std", Op::eStd},
+                                                                {"max", Op::eMax}, {"min", Op::eMin}, {"ref", Op::eColumn}};
+
+        Next();
+        Expect("(");
+
+        const std::unordered_map<std::string_view, Op> lCloses{{"rsi", Op::eRsi}, {"zscore", Op::eZScore}, {"vol", Op::eVolatility}, {"drawdown", Op::eDrawdown}};
+
+        Node lNode{Op::eRsi};
+
+        if (const auto lClose = lCloses.find(lWord); lClose != lCloses.cend())
+        {
+            lNode.op     = lClose->second;
+            lNode.period = Integer();
+        }
+        else if (const auto lWindow = lWindows.find(lWord); lWindow != lWindows.cend())
+        {
+            lNode.op    = lWindow->second;
+            lNode.field = Field();
+
+            Expect(",");
+
+            lNode.period = Integer(lNode.op == Op::eColumn ? 0 : 1);
+        }
+        else
+            Fail(fmt::format("unknown function '{}'", lWord));
+
+        Expect(")");
+
+        return Add(lNode);
+    }
+
+    uint32_t Unary()
+    {
+        if (!Accept("-"))
+            return Primary();
+
+        const auto lOperand = Numeric(Unary());
+
+        if (At(lOperand).op == Op::eConstant)
+        {
+            mScreen.mNodes.back().value = -At(lOperand).value;
+            return lOperand;
+        }
+
+        return Add({Op::eNegate, ScreenField::eClose, 0, 0.f, lOperand});
+    }
+
+    uint32_t Product()
+    {
+        for (auto lNode = Unary();;)
+        {
+            if (Accept("*"))
+                lNode = Arithmetic(Op::eMultiply, lNode, Unary());
+            else if (Accept("/"))
+                lNode = Arithmetic(Op::eDivide, lNode, Unary());
+            else
+                return lNode;
+        }
+    }
+
+    uint32_t Sum()
+    {
+        for (auto lNode = Product();;)
+        {
+            if (Accept("+"))
+                lNode = Arithmetic(Op::eAdd, lNode, Product());
+            else if (Accept("-"))
+                lNode = Arithmetic(Op::eSubtract, lNode, Product());
+            else
+                return lNode;
+        }
+    }
+
+    uint32_t Comparison()
+    {
+        const auto lLeft = Sum();
+
+        const std::pair<std::string_view, Op> lComparisons[]{{"<", Op::eLess},   {"<=", Op::eLessEqual}, {">", Op::eGreater},  {">=", Op::eGreaterEqual},
+                                                             {"=", Op::eEqual},  {"==", Op::eEqual},     {"!=", Op::eNotEqual}, {"<>", Op::eNotEqual}};
+
+        for (const auto& [lSymbol, lOp] : lComparisons)
+            if (Accept(lSymbol))
+            {
+                Numeric(lLeft);
+
+                const auto lRight = Numeric(Sum());
+
+                return Add({lOp, ScreenField::eClose, 0, 0.f, lLeft, lRight});
+            }
+
+        return lLeft;
+    }
+
+    uint32_t Not()
+    {
+        if (!Accept("not"))
+            return Comparison();
+
+        return Add({Op::eNot, ScreenField::eClose, 0, 0.f, Predicate(Not())});
+    }
+
+    uint32_t And()
+    {
+        for (auto lNode = Not();;)
+        {
+            if (!Accept("and"))
+                return lNode;
+
+            lNode = Add({Op::eAnd, ScreenField::eClose, 0, 0.f, Predicate(lNode), Predicate(Not())});
+        }
+    }
+
+    uint32_t Or()
+    {
+        for (auto lNode = And();;)
+        {
+            if (!Accept("or"))
+                return lNode;
+
+            lNode = Add({Op::eOr, ScreenField::eClose, 0, 0.f, Predicate(lNode), Predicate(And())});
+        }
+    }
+
+public:
+    ScreenParser(const std::string_view aText, Screen& aScreen) : mText{aText}, mScreen{aScreen}
+    {
+        Next();
+    }
+
+    void Parse()
+    {
+        mScreen.mRoot = Predicate(Or());
+
+        if (Accept("rank"))
+        {
+            Expect("by");
+
+            mScreen.mRank      = Numeric(Sum());
+            mScreen.mRanked    = true;
+            mScreen.mAscending = Accept("asc");
+
+            if (!mScreen.mAscending)
+                (void)Accept("desc");
+        }
+
+        if (Accept("limit"))
+            mScreen.mLimit = Integer();
+
+        if (mKind != TokenKind::eEnd)
+            Fail(fmt::format("unexpected '{}'", mToken));
+    }
+};
+
+
+
+Screen Screen::Compile(const std::string_view aText)
+{
+    Screen lScreen;
+
+    ScreenParser{aText, lScreen}.Parse();
+    lScreen.Prepare();
+
+    return lScreen;
+}
+
+
+void Screen::Prepare()
+{
+    for (const auto& lNode : mNodes)
+    {
+        switch (lNode.op)
+        {
+        case Op::eColumn:
+            mLookback = std::max(mLookback, lNode.period + 1);
+            break;
+        case Op::eSma:
+        case Op::eStd:
+        case Op::eMax:
+        case Op::eMin:
+        case Op::eZScore:
+        case Op::eDrawdown:
+            mLookback = std::max(mLookback, lNode.period);
+            break;
+        case Op::eEma:
+            mLookback = std::max(mLookback, EMA_SPAN * lNode.period);
+            break;
+        case Op::eRsi:
+            mLookback = std::max(mLookback, RSI_SPAN * lNode.period + 1);
+            break;
+        case Op::eVolatility:
+            mLookback = std::max(mLookback, lNode.period + 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Conjuncts of the top level comparing a column of the latest date with a constant.
+    std::vector<uint32_t> lConjuncts{mRoot};
+    std::vector<std::string> lConditions;
+
+    while (!lConjuncts.empty())
+    {
+        const auto& lNode = mNodes[lConjuncts.back()];
+        lConjuncts.pop_back();
+
+        if (lNode.op == Op::eAnd)
+        {
+            lConjuncts.push_back(lNode.right);
+            lConjuncts.push_back(lNode.left);
+            continue;
+        }
+
+        if (!IsComparison(lNode.op))
+            continue;
+
+        const auto& lLeft  = mNodes[lNode.left];
+        const auto& lRight = mNodes[lNode.right];
+
+        const auto IsLatest = [](const Node& aNode) { return aNode.op == Op::eColumn && aNode.period == 0; };
+
+        constexpr std::string_view lSymbols[]{"<", "<=", ">", ">=", "=", "<>"};
+        constexpr std::string_view lMirrors[]{">", ">=", "<", "<=", "=", "<>"};
+
+        const auto lIndex = static_cast<size_t>(lNode.op) - static_cast<size_t>(Op::eLess);
+
+        if (IsLatest(lLeft) && lRight.op == Op::eConstant && std::isfinite(lRight.value))
+            lConditions.push_back(fmt::format("{} {} {}", FIELD_NAMES[static_cast<size_t>(lLeft.field)], lSymbols[lIndex], lRight.value));
+        else if (lLeft.op == Op::eConstant && IsLatest(lRight) && std::isfinite(lLeft.value))
+            lConditions.push_back(fmt::format("{} {} {}", FIELD_NAMES[static_cast<size_t>(lRight.field)], lMirrors[lIndex], lLeft.value));
+    }
+
+    for (const auto& lCondition : lConditions)
+        mPushdown += (mPushdown.empty() ? "" : " AND ") + lCondition;
+}
+
+
+void Screen::Evaluate(const ScreenUniverse& aUniverse, const uint32_t aNode, const std::vector<uint32_t>& aSelection, const size_t aDepth, Scratch& aScratch) const
+{
+    const auto& lNode = mNodes[aNode];
+    auto& lValues     = aScratch.values[aDepth];
+
+    lValues.resize(aSelection.size());
+
+    const auto lLatest = aUniverse.Days() - 1;
+
+    switch (lNode.op)
+    {
+    case Op::eConstant:
+        std::fill(lValues.begin(), lValues.end(), lNode.value);
+        return;
+
+    case Op::eColumn:
+        for (size_t i = 0; i < aSelection.size(); ++i)
+            lValues[i] = aUniverse.Bars(lNode.field, aSelection[i])[lLatest - lNode.period];
+        return;
+
+    case Op::eSma:
+        Window(aUniverse, lNode.field, lNode.period, aSelection, lValues,
+               [](const float* aBars, const uint32_t aCount) { return static_cast<float>(std::accumulate(aBars, aBars + aCount, 0.0) / aCount); });
+        return;
+
+    case Op::eStd:
+        Window(aUniverse, lNode.field, lNode.period, aSelection, lValues, [](const float* aBars, const uint32_t aCount) {
+            const auto lMean     = std::accumulate(aBars, aBars + aCount, 0.0) / aCount;
+            const auto lVariance = std::transform_reduce(aBars, aBars + aCount, 0.0, std::plus<>{}, [lMean](const float aBar) { return (aBar - lMean) * (aBar - lMean); });
+
+            return static_cast<float>(std::sqrt(lVariance / aCount));
+        });
+        return;
+
+    // NaN is neither larger nor smaller than anything, the reductions propagate it explicitly.
+    case Op::eMax:
+        Window(aUniverse, lNode.field, lNode.period, aSelection, lValues, [](const float* aBars, const uint32_t aCount) {
+            return std::accumulate(aBars, aBars + aCount, -std::numeric_limits<float>::infinity(),
+                                   [](const float aFirst, const float aSecond) { return std::isnan(aSecond) ? aSecond : std::max(aFirst, aSecond); });
+        });
+        return;
+
+    case Op::eMin:
+        Window(aUniverse, lNode.field, lNode.period, aSelection, lValues, [](const float* aBars, const uint32_t aCount) {
+            return std::accumulate(aBars, aBars + aCount, std::numeric_limits<float>::infinity(),
+                                   [](const float aFirst, const float aSecond) { return std::isnan(aSecond) ? aSecond : std::min(aFirst, aSecond); });
+        });
+        return;
+
+    case Op::eEma:
+        Window(aUniverse, lNode.field, EMA_SPAN * lNode.period, aSelection, lValues, [lAlpha = 2.f / (lNode.period + 1.f)](const float* aBars, const uint32_t aCount) {
+            return std::accumulate(aBars + 1, aBars + aCount, aBars[0], [lAlpha](const float aAverage, const float aBar) { return aAverage + lAlpha * (aBar - aAverage); });
+        });
+        return;
+
+    // Wilder averages of the gains and losses, as IndicatorTable computes them.
+    case Op::eRsi:
+        Window(aUniverse, ScreenField::eClose, RSI_SPAN * lNode.period + 1, aSelection, lValues, [lAlpha = 1.f / lNode.period](const float* aBars, const uint32_t aCount) {
+            auto lGain = std::max(aBars[1] - aBars[0], 0.f);
+            auto lLoss = std::max(aBars[0] - aBars[1], 0.f);
+
+            for (uint32_t t = 2; t < aCount; ++t)
+            {
+                const auto lChange = aBars[t] - aBars[t - 1];
+
+                lGain += lAlpha * (std::max(lChange, 0.f) - lGain);
+                lLoss += lAlpha * (std::max(-lChange, 0.f) - lLoss);
+            }
+
+            if (std::isnan(lGain + lLoss))
+                return NOT_AVAILABLE;
+
+            return lGain + lLoss > 0.f ? 100.f * lGain / (lGain + lLoss) : 50.f;
+        });
+        return;
+
+    // The statistics of RollingStatistics over the latest window only, a NaN bar turns the mean NaN.
+    case Op::eZScore:
+        Window(aUniverse, ScreenField::eClose, lNode.period, aSelection, lValues, [](const float* aBars, const uint32_t aCount) {
+            WelfordWindow lWindow;
+
+            std::for_each(aBars, aBars + aCount, [&lWindow](const float aBar) { lWindow.Add(aBar); });
+
+            return lWindow.Variance() > 0.0 ? static_cast<float>((aBars[aCount - 1] - lWindow.Mean()) / std::sqrt(lWindow.Variance())) : NOT_AVAILABLE;
+        });
+        return;
+
+    case Op::eVolatility:
+        Window(aUniverse, ScreenField::eClose, lNode.period + 1, aSelection, lValues, [](const float* aBars, const uint32_t aCount) {
+            WelfordWindow lWindow;
+
+            for (uint32_t t = 1; t < aCount; ++t)
+                lWindow.Add(std::log(static_cast<double>(aBars[t]) / aBars[t - 1]));
+
+            return static_cast<float>(std::sqrt(lWindow.Variance() * RollingParameters{}.annualization));
+        });
+        return;
+
+    case Op::eDrawdown:
+        Window(aUniverse, ScreenField::eClose, lNode.period, aSelection, lValues, [](const float* aBars, const uint32_t aCount) {
+            const auto lPeak = std::accumulate(aBars, aBars + aCount, -std::numeric_limits<float>::infinity(),
+                                               [](const float aFirst, const float aSecond) { return std::isnan(aSecond) ? aSecond : std::max(aFirst, aSecond); });
+
+            return lPeak > 0.f ? aBars[aCount - 1] / lPeak - 1.f : NOT_AVAILABLE;
+        });
+        return;
+
+    case Op::eNegate:
+        Evaluate(aUniverse, lNode.left, aSelection, aDepth, aScratch);
+        std::transform(lValues.cbegin(), lValues.cend(), lValues.begin(), std::negate<>{});
+        return;
+
+    default:
+        break;
+    }
+
+    Evaluate(aUniverse, lNode.left, aSelection, aDepth, aScratch);
+    Evaluate(aUniverse, lNode.right, aSelection, aDepth + 1, aScratch);
+
+    const auto& lRight = aScratch.values[aDepth + 1];
+
+    switch (lNode.op)
+    {
+    case Op::eAdd:
+        std::transform(lValues.cbegin(), lValues.cend(), lRight.cbegin(), lValues.begin(), std::plus<>{});
+        break;
+    case Op::eSubtract:
+        std::transform(lValues.cbegin(), lValues.cend(), lRight.cbegin(), lValues.begin(), std::minus<>{});
+        break;
+    case Op::eMultiply:
+        std::transform(lValues.cbegin(), lValues.cend(), lRight.cbegin(), lValues.begin(), std::multiplies<>{});
+        break;
+    case Op::eDivide:
+        std::transform(lValues.cbegin(), lValues.cend(), lRight.cbegin(), lValues.begin(), std::divides<>{});
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+
+void Screen::Select(const ScreenUniverse& aUniverse, const uint32_t aNode, const std::vector<uint32_t>& aSelection, const size_t aDepth, Scratch& aScratch) const
+{
+    const auto& lNode = mNodes[aNode];
+    auto& lResult     = aScratch.selections[aDepth];
+
+    switch (lNode.op)
+    {
+    // The right side only sees the codes the left side kept.
+    case Op::eAnd:
+        Select(aUniverse, lNode.left, aSelection, aDepth + 1, aScratch);
+        Select(aUniverse, lNode.right, aScratch.selections[aDepth + 1], aDepth + 2, aScratch);
+        lResult.swap(aScratch.selections[aDepth + 2]);
+        return;
+
+    // The right side only sees the codes the left side rejected.
+    case Op::eOr:
+    {
+        Select(aUniverse, lNode.left, aSelection, aDepth + 1, aScratch);
+        Difference(aSelection, aScratch.selections[aDepth + 1], aScratch.selections[aDepth + 2]);
+        Select(aUniverse, lNode.right, aScratch.selections[aDepth + 2], aDepth + 3, aScratch);
+
+        const auto& lFirst  = aScratch.selections[aDepth + 1];
+        const auto& lSecond = aScratch.selections[aDepth + 3];
+
+        lResult.clear();
+        std::merge(lFirst.cbegin(), lFirst.cend(), lSecond.cbegin(), lSecond.cend(), std::back_inserter(lResult));
+        return;
+    }
+
+    case Op::eNot:
+        Select(aUniverse, lNode.left, aSelection, aDepth + 1, aScratch);
+        Difference(aSelection, aScratch.selections[aDepth + 1], lResult);
+        return;
+
+    default:
+        break;
+    }
+
+    if (aSelection.empty())
+    {
+        lResult.clear();
+        return;
+    }
+
+    Evaluate(aUniverse, lNode.left, aSelection, aDepth, aScratch);
+    Evaluate(aUniverse, lNode.right, aSelection, aDepth + 1, aScratch);
+
+    const auto& lLeft  = aScratch.values[aDepth];
+    const auto& lRight = aScratch.values[aDepth + 1];
+
+    switch (lNode.op)
+    {
+    case Op::eLess:
+        Filter(aSelection, lLeft, lRight, lResult, std::less<>{});
+        break;
+    case Op::eLessEqual:
+        Filter(aSelection, lLeft, lRight, lResult, std::less_equal<>{});
+        break;
+    case Op::eGreater:
+        Filter(aSelection, lLeft, lRight, lResult, std::greater<>{});
+        break;
+    case Op::eGreaterEqual:
+        Filter(aSelection, lLeft, lRight, lResult, std::greater_equal<>{});
+        break;
+    case Op::eEqual:
+        Filter(aSelection, lLeft, lRight, lResult, std::equal_to<>{});
+        break;
+    default:
+        // NaN must fail != as well.
+        Filter(aSelection, lLeft, lRight, lResult, [](const float aFirst, const float aSecond) { return aFirst < aSecond || aFirst > aSecond; });
+        break;
+    }
+}
+
+
+ScreenUniverse Screen::Load(DataLoader& aDataLoader) const
+{
+    return ScreenUniverse::Load(aDataLoader, mLookback, mPushdown);
+}
+
+
+std::vector<ScreenResult> Screen::Run(const ScreenUniverse& aUniverse, WorkStealingPool& aPool) const
+{
+    if (aUniverse.Days() < mLookback)
+        return {};
+
+    // Every level of the plan takes at most three registers.
+    const auto lLevels = 3 * mNodes.size() + 4;
+
+    std::vector<Scratch> lScratches(aPool.WorkerCount());
+
+    for (auto& lScratch : lScratches)
+    {
+        lScratch.values.resize(lLevels);
+        lScratch.selections.resize(lLevels);
+    }
+
+    const auto lBlocks = (aUniverse.Count() + BLOCK_CODES - 1) / BLOCK_CODES;
+
+    std::vector<std::vector<uint32_t>> lSelected(lBlocks);
+    std::vector<std::vector<float>> lScores(lBlocks);
+
+    aPool.ForEach(lBlocks, 1, [&](const size_t i, const size_t aWorker) {
+        auto& lScratch = lScratches[aWorker];
+
+        std::vector<uint32_t> lCodes(std::min(BLOCK_CODES, aUniverse.Count() - i * BLOCK_CODES));
+        std::iota(lCodes.begin(), lCodes.end(), static_cast<uint32_t>(i * BLOCK_CODES));
+
+        Select(aUniverse, mRoot, lCodes, 0, lScratch);
+        lSelected[i] = lScratch.selections[0];
+
+        if (mRanked && !lSelected[i].empty())
+        {
+            Evaluate(aUniverse, mRank, lSelected[i], 0, lScratch);
+            lScores[i] = lScratch.values[0];
+        }
+        else
+            lScores[i].assign(lSelected[i].size(), 0.f);
+    });
+
+    std::vector<std::pair<uint32_t, float>> lMatches;
+
+    for (size_t i = 0; i < lBlocks; ++i)
+        for (size_t j = 0; j < lSelected[i].size(); ++j)
+            lMatches.emplace_back(lSelected[i][j], lScores[i][j]);
+
+    const auto lCount = mLimit > 0 ? std::min<size_t>(mLimit, lMatches.size()) : lMatches.size();
+
+    // NaN scores rank last.
+    if (mRanked)
+        std::partial_sort(lMatches.begin(), lMatches.begin() + lCount, lMatches.end(), [lAscending = mAscending](const auto& aFirst, const auto& aSecond) {
+            if (std::isnan(aFirst.second) || std::isnan(aSecond.second))
+                return !std::isnan(aFirst.second) && std::isnan(aSecond.second);
+
+            return lAscending ? aFirst.second < aSecond.second : aFirst.second > aSecond.second;
+        });
+
+    std::vector<ScreenResult> lResults;
+    lResults.reserve(lCount);
+
+    for (size_t i = 0; i < lCount; ++i)
+        lResults.push_back({aUniverse.Codes()[lMatches[i].first], lMatches[i].second});
+
+    return lResults;
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
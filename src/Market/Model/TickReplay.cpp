@@ -0,0 +1,243 @@
+#include "Market/Model/TickReplay.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "Market/Model/IsoDate.h"
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+constexpr size_t TICK_RECORD_SIZE = sizeof(int64_t) + 2 * sizeof(float);
+
+
+template <typename T>
+[[nodiscard]] std::optional<T> ParseNumber(const std::string_view aText)
+{
+    T lValue{};
+
+    if (const auto [lEnd, lError] = std::from_chars(aText.data(), aText.data() + aText.size(), lValue); lError != std::errc{} || lEnd != aText.data() + aText.size())
+        return std::nullopt;
+
+    return lValue;
+}
+
+
+// "HH:MM:SS" or "HH:MM:SS.f" with any number of digits of a second, ".5" is 500 ms. Digits past the milliseconds are dropped.
+[[nodiscard]] std::optional<std::chrono::milliseconds> ParseTimeOfDay(const std::string_view aText)
+{
+    if (aText.size() < 8 || aText[2] != ':' || aText[5] != ':')
+        return std::nullopt;
+
+    const auto lHours   = ParseNumber<int>(aText.substr(0, 2));
+    const auto lMinutes = ParseNumber<int>(aText.substr(3, 2));
+    const auto lSeconds = ParseNumber<int>(aText.substr(6, 2));
+    auto lMillis        = 0;
+
+    if (aText.size() > 8)
+    {
+        const auto lFraction = aText.substr(9);
+
+        if (aText[8] != '.' || lFraction.empty() || !std::all_of(lFraction.cbegin(), lFraction.cend(), [](const char aChar) { return aChar >= '0' && aChar <= '9'; }))
+            return std::nullopt;
+
+        for (size_t i = 0; i < 3; ++i)
+            lMillis = lMillis * 10 + (i < lFraction.size() ? lFraction[i] - '0' : 0);
+    }
+
+    if (!lHours || !lMinutes || !lSeconds || *lHours > 23 || *lMinutes > 59 || *lSeconds > 60)
+        return std::nullopt;
+
+    return std::chrono::hours{*lHours} + std::chrono::minutes{*lMinutes} + std::chrono::seconds{*lSeconds} + std::chrono::milliseconds{lMillis};
+}
+
+
+[[nodiscard]] std::optional<Tick> ParseCsvTick(const std::string_view aLine)
+{
+    const auto lFirstComma  = aLine.find(',');
+    const auto lSecondComma = aLine.find(',', lFirstComma + 1);
+
+    if (lFirstComma == std::string_view::npos || lSecondComma == std::string_view::npos || lFirstComma < 11)
+        return std::nullopt;
+
+    date::sys_days lDate;
+
+    const auto lDated  = ParseIsoDate(aLine.data(), 10, lDate);
+    const auto lTime   = ParseTimeOfDay(aLine.substr(11, lFirstComma - 11));
+    const auto lPrice  = ParseNumber<float>(aLine.substr(lFirstComma + 1, lSecondComma - lFirstComma - 1));
+    const auto lVolume = ParseNumber<float>(aLine.substr(lSecondComma + 1));
+
+    if (!lDated || !lTime || !lPrice || !lVolume || (aLine[10] != ' ' && aLine[10] != 'T'))
+        return std::nullopt;
+
+    return Tick{lDate + *lTime, *lPrice, *lVolume};
+}
+
+
+[[nodiscard]] std::vector<Tick> LoadCsv(std::ifstream& aFile, const std::filesystem::path& aPath)
+{
+    std::vector<Tick> lTicks;
+    std::string lLine;
+
+    for (size_t lNumber = 1; std::getline(aFile, lLine); ++lNumber)
+    {
+        if (!lLine.empty() && lLine.back() == '\r')
+            lLine.pop_back();
+
+        if (lLine.empty())
+            continue;
+
+        if (const auto lTick = ParseCsvTick(lLine))
+            lTicks.push_back(*lTick);
+        else if (lNumber > 1)
+            throw std::runtime_error(fmt::format("Invalid tick at line {} of {}.", lNumber, aPath.string()));
+    }
+
+    return lTicks;
+}
+
+
+[[nodiscard]] std::vector<Tick> LoadBinary(std::ifstream& aFile, const std::filesystem::path& aPath)
+{
+    const std::vector<char> lBytes{std::istreambuf_iterator<char>{aFile}, std::istreambuf_iterator<char>{}};
+
+    if (lBytes.size() % TICK_RECORD_SIZE != 0)
+        throw std::runtime_error(fmt::format("Truncated tick file {}.", aPath.string()));
+
+    std::vector<Tick> lTicks(lBytes.size() / TICK_RECORD_SIZE);
+
+    for (size_t i = 0; i < lTicks.size(); ++i)
+    {
+        const auto* lRecord = lBytes.data() + i * TICK_RECORD_SIZE;
+        int64_t lMillis;
+
+        std::memcpy(&lMillis, lRecord, sizeof(lMillis));
+        std::memcpy(&lTicks[i].price, lRecord + sizeof(lMillis), sizeof(float));
+        std::memcpy(&lTicks[i].volume, lRecord + sizeof(lMillis) + sizeof(float), sizeof(float));
+
+        lTicks[i].time = date::sys_time<std::chrono::milliseconds>{std::chrono::milliseconds{lMillis}};
+    }
+
+    return lTicks;
+}
+
+
+
+}    // namespace
+
+
+
+std::vector<Tick> TickReplay::Load(const std::filesystem::path& aPath)
+{
+    const auto lCsv = aPath.extension() == ".csv";
+
+    std::ifstream lFile{aPath, lCsv ? std::ios::in : std::ios::in | std::ios::binary};
+
+    if (!lFile)
+        throw std::runtime_error(fmt::format("Failed to open tick file {}.", aPath.string()));
+
+    auto lTicks = lCsv ? LoadCsv(lFile, aPath) : LoadBinary(lFile, aPath);
+
+    std::stable_sort(lTicks.begin(), lTicks.end(), [](const Tick& aFirst, const Tick& aSecond) { return aFirst.time < aSecond.time; });
+
+    return lTicks;
+}
+
+
+TickReplay::TickReplay(const std::filesystem::path& aPath, MinuteBarFeed& aFeed, const double aSpeed) : mFeed{aFeed}, mTicks{Load(aPath)}, mSpeed{aSpeed}
+{
+    mThread = std::thread{&TickReplay::Run, this};
+}
+
+
+TickReplay::~TickReplay()
+{
+    Stop();
+}
+
+
+void TickReplay::Stop()
+{
+    if (!mThread.joinable())
+        return;
+
+    {
+        const std::lock_guard lLock{mMutex};
+        mStopping = true;
+    }
+
+    mWakeUp.notify_one();
+    mThread.join();
+}
+
+
+bool TickReplay::WaitUntil(const std::chrono::steady_clock::time_point aTime)
+{
+    std::unique_lock lLock{mMutex};
+
+    return !mWakeUp.wait_until(lLock, aTime, [this] { return mStopping; });
+}
+
+
+void TickReplay::Run()
+{
+    using namespace std::chrono;
+
+    constexpr auto lRetry = milliseconds{1};
+
+    const auto lStart = steady_clock::now();
+    const auto lDue   = [this, lStart](const Tick& aTick) {
+        return mSpeed > 0. ? lStart + duration_cast<steady_clock::duration>((aTick.time - mTicks.front().time) / mSpeed) : lStart;
+    };
+    const auto lPost = [this](const BarInterval aInterval, const MinuteBar& aBar) { mFeed.Post(aInterval, aBar); };
+
+    BarAggregator lAggregator;
+
+    for (size_t lFirst = 0; lFirst < mTicks.size();)
+    {
+        if (!WaitUntil(lDue(mTicks[lFirst])))
+            return;
+
+        const auto lNow  = steady_clock::now();
+        const auto lStop = std::min(mTicks.size(), lFirst + BarAggregator::TICK_BATCH_SIZE);
+        auto lLast       = lFirst + 1;
+
+        while (lLast < lStop && lDue(mTicks[lLast]) <= lNow)
+            ++lLast;
+
+        lAggregator.Push(mTicks.data() + lFirst, lLast - lFirst, lPost);
+        lAggregator.ForEachForming(lPost);
+        lFirst = lLast;
+
+        while (mSpeed <= 0. && !mFeed.Flush())
+            if (!WaitUntil(steady_clock::now() + lRetry))
+                return;
+    }
+
+    while (!mFeed.Flush())
+        if (!WaitUntil(steady_clock::now() + lRetry))
+            return;
+
+    mFinished.store(true, std::memory_order_release);
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "Market/Painter.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
 
 #include <fmt/format.h>
 #include <skia/include/core/SkFontMgr.h>
+#include <skia/include/core/SkSurface.h>
 #include <skia/include/effects/SkDashPathEffect.h>
 
 #include "Market/Model/DataAnalyzer.h"
@@ -15,9 +19,12 @@ namespace abollo
 
 
 
-constexpr auto DEFAULT_UPPER_COLOR  = SkColorSetARGB(0xFF, 0xDC, 0x32, 0x2F);
-constexpr auto DEFAULT_LOWER_COLOR  = SkColorSetARGB(0xFF, 0x3C, 0xc8, 0x66);
-constexpr auto DEFAULT_VOLUME_COLOR = SkColorSetARGB(0xFF, 0x6C, 0x71, 0xC4);
+constexpr auto DEFAULT_UPPER_COLOR   = SkColorSetARGB(0xFF, 0xDC, 0x32, 0x2F);
+constexpr auto DEFAULT_LOWER_COLOR   = SkColorSetARGB(0xFF, 0x3C, 0xc8, 0x66);
+constexpr auto DEFAULT_VOLUME_COLOR  = SkColorSetARGB(0xFF, 0x6C, 0x71, 0xC4);
+constexpr auto DEFAULT_NEUTRAL_COLOR = SkColorSetARGB(0xFF, 0xB5, 0x89, 0x00);
+
+constexpr std::array<std::string_view, BAR_INTERVAL_COUNT> BAR_INTERVAL_NAMES{"1 MIN", "5 MIN", "15 MIN", "60 MIN", "DAILY"};
 
 
 Painter::Painter()
@@ -33,6 +40,19 @@ Painter::Painter()
     mVolumePaint.setColor(DEFAULT_VOLUME_COLOR);
     mVolumePaint.setAlphaf(0.5f);
 
+    mPatternPaint.setAntiAlias(true);
+    mPatternPaint.setStyle(SkPaint::kStroke_Style);
+    mPatternPaint.setStrokeCap(SkPaint::kRound_Cap);
+
+    mOverlayPaint.setAntiAlias(true);
+    mOverlayPaint.setStyle(SkPaint::kStroke_Style);
+    mOverlayPaint.setStrokeWidth(1.5f);
+
+    mProfilePaint.setAntiAlias(true);
+    mProfilePaint.setStyle(SkPaint::kFill_Style);
+    mProfilePaint.setColor(DEFAULT_VOLUME_COLOR);
+    mProfilePaint.setAlphaf(0.35f);
+
     mAxisPaint.setAntiAlias(true);
     mAxisPaint.setColor(SK_ColorWHITE);
 
@@ -52,10 +72,22 @@ Painter::Painter()
 }
 
 
-SkScalar Painter::DrawDateAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const SkScalar aCoordY, const date::year_month_day& aDate) const
+void Painter::WarmUp() const
+{
+    constexpr std::string_view lGlyphs = "0123456789/";
+
+    const auto lSurface = SkSurface::MakeRasterN32Premul(static_cast<int>(mDateLabelWidth * static_cast<SkScalar>(lGlyphs.size())), 32);
+    lSurface->getCanvas()->drawSimpleText(lGlyphs.data(), lGlyphs.size(), SkTextEncoding::kUTF8, 0.f, 16.f, mAxisLabelFont, mAxisPaint);
+}
+
+
+SkScalar Painter::DrawDateAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const SkScalar aCoordY, const date::sys_days aDate) const
 {
+    // Dates are kept as days since the epoch, the calendar is only worked out for the few labels that are drawn.
+    const date::year_month_day lDate{aDate};
+
     const auto lCoordX    = aCoordX - mDateLabelWidth / 2.f;
-    const auto lDateLabel = fmt::format(DEFAULT_DATE_FORMAT_STR, static_cast<unsigned>(aDate.month()), static_cast<unsigned>(aDate.day()));
+    const auto lDateLabel = fmt::format(DEFAULT_DATE_FORMAT_STR, static_cast<unsigned>(lDate.month()), static_cast<unsigned>(lDate.day()));
 
     aCanvas.drawString(lDateLabel.data(), lCoordX, aCoordY, mAxisLabelFont, mAxisPaint);
 
@@ -63,6 +95,19 @@ SkScalar Painter::DrawDateAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const
 }
 
 
+SkScalar Painter::DrawTimeAxis(SkCanvas& aCanvas, const SkScalar aCoordX, const SkScalar aCoordY, const MinuteTime aTime) const
+{
+    const auto lTime = date::make_time(aTime - date::floor<date::days>(aTime));
+
+    const auto lCoordX    = aCoordX - mDateLabelWidth / 2.f;
+    const auto lTimeLabel = fmt::format(DEFAULT_TIME_FORMAT_STR, lTime.hours().count(), lTime.minutes().count());
+
+    aCanvas.drawString(lTimeLabel.data(), lCoordX, aCoordY, mAxisLabelFont, mAxisPaint);
+
+    return lCoordX;
+}
+
+
 void Painter::Highlight(SkCanvas& aCanvas, const MarketDataFields& aCandleData, const SkScalar aCandleWidth)
 {
     SkPaint paint;
@@ -109,6 +154,49 @@ void Painter::Highlight(SkCanvas& aCanvas, const MarketDataFields& aCandleData,
 }
 
 
+void Painter::DrawStatistics(SkCanvas& aCanvas, const SkPoint& aPos, const double aVolume, const double aVwap) const
+{
+    const auto lLabel = fmt::format("VOL {:.2f}  VWAP {:.2f}", aVolume, aVwap);
+
+    aCanvas.drawString(lLabel.data(), aPos.x(), aPos.y(), mAxisLabelFont, mAxisPaint);
+}
+
+
+void Painter::DrawRollingStatistics(SkCanvas& aCanvas, const SkPoint& aPos, const float aVolatility, const float aZScore, const float aDrawdown) const
+{
+    const auto lLabel = fmt::format("VOLAT {:.1f}%  Z {:.2f}  DD {:.1f}%", aVolatility * 100.f, aZScore, aDrawdown * 100.f);
+
+    aCanvas.drawString(lLabel.data(), aPos.x(), aPos.y() + mAxisLabelFont.getSpacing(), mAxisLabelFont, mAxisPaint);
+}
+
+
+void Painter::DrawVolumeProfile(SkCanvas& aCanvas, const VolumeProfile& aProfile, const SkScalar aScaleY, const SkScalar aTransY) const
+{
+    const auto lMaxVolume = aProfile.volumes.empty() ? 0.f : *std::max_element(aProfile.volumes.cbegin(), aProfile.volumes.cend());
+
+    if (!(lMaxVolume > 0.f))
+        return;
+
+    const auto lCanvasClipBounds = aCanvas.getDeviceClipBounds();
+    const auto lRight            = static_cast<SkScalar>(lCanvasClipBounds.width());
+    const auto lScaleX           = lRight * PROFILE_WIDTH / lMaxVolume;
+    const auto lBinHeight        = aProfile.BinHeight();
+
+    SkPath lBars;
+
+    for (size_t i = 0; i < aProfile.volumes.size(); ++i)
+    {
+        const auto lBottom = std::fma(aProfile.low + lBinHeight * static_cast<float>(i), aScaleY, aTransY);
+        const auto lTop    = std::fma(aProfile.low + lBinHeight * static_cast<float>(i + 1), aScaleY, aTransY);
+
+        // One pixel between the bars, the bins stay apart when they are only a few pixels high.
+        lBars.addRect(SkRect::MakeLTRB(lRight - aProfile.volumes[i] * lScaleX, std::min(lTop, lBottom), lRight, std::max(lTop, lBottom) - 1.f));
+    }
+
+    aCanvas.drawPath(lBars, mProfilePaint);
+}
+
+
 void Painter::DrawCandle(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator, DatePriceZipIterator>& lData, const SkScalar aCandleWidth)
 {
     auto lPrevCoordX = std::numeric_limits<float>::max();
@@ -191,5 +279,167 @@ void Painter::DrawCandle(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator
 }
 
 
+void Painter::DrawBars(SkCanvas& aCanvas, const MinuteBarTable& aBars, const BarInterval aInterval)
+{
+    const auto lCanvasClipBounds = aCanvas.getDeviceClipBounds();
+    const auto lWidth            = static_cast<SkScalar>(lCanvasClipBounds.width());
+    const auto lHeight           = static_cast<SkScalar>(lCanvasClipBounds.height());
+
+    const auto lCount = std::min(aBars.size(), static_cast<uint32_t>(lWidth / BAR_SPACING));
+    const auto lFirst = aBars.size() - lCount;
+
+    const auto lTitle = fmt::format("{}  {} bars", BAR_INTERVAL_NAMES[static_cast<size_t>(aInterval)], aBars.size());
+    aCanvas.drawString(lTitle.data(), 0.f, mAxisLabelFont.getSpacing(), mAxisLabelFont, mAxisPaint);
+
+    if (lCount == 0)
+        return;
+
+    auto lLow       = std::numeric_limits<float>::max();
+    auto lHigh      = std::numeric_limits<float>::lowest();
+    auto lMaxVolume = 0.f;
+
+    for (auto i = lFirst; i < aBars.size(); ++i)
+    {
+        lLow       = std::min(lLow, aBars.at<low_tag>(i));
+        lHigh      = std::max(lHigh, aBars.at<high_tag>(i));
+        lMaxVolume = std::max(lMaxVolume, aBars.at<volume_tag>(i));
+    }
+
+    // Prices between the title and the volumes, volumes above the time labels.
+    const auto lLabelHeight  = mAxisLabelFont.getSpacing();
+    const auto lPriceBottom  = lHeight * (1.f - BAR_VOLUME_HEIGHT);
+    const auto lVolumeBottom = lHeight - lLabelHeight;
+    const auto lPriceScale   = lHigh > lLow ? (lPriceBottom - 2.f * lLabelHeight) / (lHigh - lLow) : 0.f;
+    const auto lVolumeScale  = lMaxVolume > 0.f ? (lVolumeBottom - lPriceBottom) / lMaxVolume : 0.f;
+
+    const auto CoordY = [lHigh, lPriceScale, lTop = 2.f * lLabelHeight](const float aPrice) { return lTop + (lHigh - aPrice) * lPriceScale; };
+
+    const auto lHalfWidth = BAR_SPACING * 0.35f;
+    auto lPrevCoordX      = std::numeric_limits<SkScalar>::max();
+
+    SkPath lUpperShadowPath;
+    SkPath lLowerShadowPath;
+    SkPath lVolumes;
+
+    // Newest first from the right edge, so that the labels are spaced from the latest bar as on the daily chart.
+    for (auto i = aBars.size(); i-- > lFirst;)
+    {
+        const auto lCoordX = lWidth - (static_cast<SkScalar>(aBars.size() - i) - 0.5f) * BAR_SPACING;
+        const auto lOpen   = aBars.at<open_tag>(i);
+        const auto lClose  = aBars.at<close_tag>(i);
+        const auto lRising = lClose > lOpen;
+
+        auto& lShadowPath = lRising ? lUpperShadowPath : lLowerShadowPath;
+        lShadowPath.moveTo(lCoordX, CoordY(aBars.at<low_tag>(i)));
+        lShadowPath.lineTo(lCoordX, CoordY(aBars.at<high_tag>(i)));
+
+        SkRect lCandleRect{};
+        lCandleRect.set({lCoordX - lHalfWidth, CoordY(lOpen)}, {lCoordX + lHalfWidth, CoordY(lClose)});
+
+        mCandlePaint.setColor(lRising ? DEFAULT_UPPER_COLOR : DEFAULT_LOWER_COLOR);
+        aCanvas.drawRect(lCandleRect, mCandlePaint);
+
+        lVolumes.addRect(SkRect::MakeLTRB(lCoordX - lHalfWidth, lVolumeBottom - aBars.at<volume_tag>(i) * lVolumeScale, lCoordX + lHalfWidth, lVolumeBottom));
+
+        if (lPrevCoordX - lCoordX >= mDateLabelSpace)
+        {
+            const auto lTime = aBars.at<time_tag>(i);
+
+            lPrevCoordX = aInterval == BarInterval::eDaily ? DrawDateAxis(aCanvas, lCoordX, lHeight, date::floor<date::days>(lTime))
+                                                           : DrawTimeAxis(aCanvas, lCoordX, lHeight, lTime);
+        }
+    }
+
+    mCandlestickPaint.setColor(DEFAULT_UPPER_COLOR);
+    aCanvas.drawPath(lUpperShadowPath, mCandlestickPaint);
+
+    mCandlestickPaint.setColor(DEFAULT_LOWER_COLOR);
+    aCanvas.drawPath(lLowerShadowPath, mCandlestickPaint);
+
+    aCanvas.drawPath(lVolumes, mProfilePaint);
+
+    // Latest close at the right edge, at its height.
+    const auto lLast = fmt::format("{:.2f}", aBars.back<close_tag>());
+    aCanvas.drawString(lLast.data(), lWidth - mDateLabelWidth * 1.5f, CoordY(aBars.back<close_tag>()), mAxisLabelFont, mAxisPaint);
+}
+
+
+void Painter::DrawOverlay(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator, DatePriceZipIterator>& lData, const std::vector<SkScalar>& aCoordsY,
+                          const SkColor aColor)
+{
+    SkPath lPath;
+    auto lDrawing = false;
+    auto lBegin   = lData.first;
+
+    for (size_t i = 0; i < aCoordsY.size() && lBegin != lData.second; ++i, ++lBegin)
+    {
+        if (std::isnan(aCoordsY[i]))
+        {
+            lDrawing = false;
+            continue;
+        }
+
+        const auto lCoordX = thrust::get<1>(*lBegin).transformed.seq;
+
+        if (lDrawing)
+            lPath.lineTo(lCoordX, aCoordsY[i]);
+        else
+            lPath.moveTo(lCoordX, aCoordsY[i]);
+
+        lDrawing = true;
+    }
+
+    mOverlayPaint.setColor(aColor);
+
+    aCanvas.drawPath(lPath, mOverlayPaint);
+}
+
+
+void Painter::DrawPatterns(SkCanvas& aCanvas, const std::pair<DatePriceZipIterator, DatePriceZipIterator>& lData, const CandlePattern aPattern,
+                           const std::vector<uint32_t>& aOffsets, const SkScalar aCandleWidth)
+{
+    if (aOffsets.empty())
+        return;
+
+    bool lBullish{false};
+    SkColor lColor{DEFAULT_NEUTRAL_COLOR};
+
+    switch (aPattern)
+    {
+    case CandlePattern::eHammer:
+    case CandlePattern::eBullishEngulfing:
+    case CandlePattern::eMorningStar:
+    case CandlePattern::eGapUp:
+        lBullish = true;
+        lColor   = DEFAULT_UPPER_COLOR;
+        break;
+    case CandlePattern::eBearishEngulfing:
+    case CandlePattern::eGapDown:
+        lColor = DEFAULT_LOWER_COLOR;
+        break;
+    default:
+        break;
+    }
+
+    const auto lSize = std::clamp(aCandleWidth * 0.6f, 3.f, 8.f);
+
+    std::vector<SkPoint> lPoints;
+    lPoints.reserve(aOffsets.size());
+
+    // The window Y axis points down, below the low is a larger Y.
+    for (const auto lOffset : aOffsets)
+    {
+        const auto& lFields = thrust::get<1>(*(lData.first + lOffset)).transformed;
+
+        lPoints.push_back(lBullish ? SkPoint::Make(lFields.seq, lFields.low + lSize) : SkPoint::Make(lFields.seq, lFields.high - lSize));
+    }
+
+    mPatternPaint.setColor(lColor);
+    mPatternPaint.setStrokeWidth(lSize);
+
+    aCanvas.drawPoints(SkCanvas::kPoints_PointMode, lPoints.size(), lPoints.data(), mPatternPaint);
+}
+
+
 
 }    // namespace abollo
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "Utility/AlignedAllocator.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cstdlib>
+#include <sys/mman.h>
+#endif
+
+
+
+namespace abollo
+{
+
+
+
+namespace
+{
+
+
+
+[[nodiscard]] size_t RoundUp(const size_t aBytes, const size_t aGranularity)
+{
+    return (aBytes + aGranularity - 1) / aGranularity * aGranularity;
+}
+
+
+
+}    // namespace
+
+
+
+void* AllocateAligned(const size_t aBytes, const bool aHugePages)
+{
+    if (!aHugePages || aBytes < HUGE_PAGE_SIZE)
+        return ::operator new(aBytes, std::align_val_t{SIMD_ALIGNMENT});
+
+#ifdef _WIN32
+    // Large pages fail without the privilege or once physical memory is fragmented, normal pages are the fallback.
+    void* lMemory = nullptr;
+
+    if (const auto lLargePage = GetLargePageMinimum(); lLargePage > 0)
+        lMemory = VirtualAlloc(nullptr, RoundUp(aBytes, lLargePage), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+    if (lMemory == nullptr)
+        lMemory = VirtualAlloc(nullptr, aBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    // Transparent huge pages back an aligned range on the next faults if the kernel has them to spare.
+    void* lMemory = std::aligned_alloc(HUGE_PAGE_SIZE, RoundUp(aBytes, HUGE_PAGE_SIZE));
+
+#ifdef MADV_HUGEPAGE
+    if (lMemory != nullptr)
+        madvise(lMemory, RoundUp(aBytes, HUGE_PAGE_SIZE), MADV_HUGEPAGE);
+#endif
+#endif
+
+    if (lMemory == nullptr)
+        throw std::bad_alloc();
+
+    return lMemory;
+}
+
+
+void FreeAligned(void* aMemory, const size_t aBytes, const bool aHugePages)
+{
+    if (aMemory == nullptr)
+        return;
+
+    if (!aHugePages || aBytes < HUGE_PAGE_SIZE)
+    {
+        ::operator delete(aMemory, std::align_val_t{SIMD_ALIGNMENT});
+        return;
+    }
+
+#ifdef _WIN32
+    VirtualFree(aMemory, 0, MEM_RELEASE);
+#else
+    std::free(aMemory);
+#endif
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file
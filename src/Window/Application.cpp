@@ -1,5 +1,7 @@
 #include "Window/Application.h"
 
+#include <future>
+
 #include "Window/EventDispatcher.h"
 
 
@@ -8,71 +10,106 @@ namespace abollo
 {
 
 
-void Application::Run() const
+bool Application::Post(std::function<void()> aTask)
 {
-    for (SDL_Event lEvent; SDL_WaitEvent(&lEvent) && lEvent.type != SDL_QUIT;)
     {
-        try
-        {
-            switch (lEvent.type)
-            {
-            case SDL_WINDOWEVENT:
-            {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.window.windowID);
-                lEventDispatcher.OnWindowEvent(lEvent.window);
-                break;
-            }
+        const std::lock_guard lLock{mTaskMutex};
 
-            case SDL_MOUSEMOTION:
-            {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.motion.windowID);
-                lEventDispatcher.OnMouseMotionEvent(lEvent.motion);
-                break;
-            }
+        if (!mAcceptingTasks)
+            return false;
 
-            case SDL_MOUSEBUTTONDOWN:
-            {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.button.windowID);
-                lEventDispatcher.OnMouseButtonDownEvent(lEvent.button);
-                break;
-            }
+        mTasks.push_back(std::move(aTask));
 
-            case SDL_MOUSEBUTTONUP:
-            {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.button.windowID);
-                lEventDispatcher.OnMouseButtonUpEvent(lEvent.button);
-                break;
-            }
+        // The event already posted for the tasks before this one runs it too.
+        if (mTasks.size() > 1)
+            return true;
+    }
 
-            case SDL_MOUSEWHEEL:
-            {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.wheel.windowID);
-                lEventDispatcher.OnMouseWheelEvent(lEvent.wheel);
-                break;
-            }
+    SDL_Event lEvent{};
+    lEvent.type = mTaskEvent;
 
-            case SDL_KEYDOWN:
-            {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.key.windowID);
-                lEventDispatcher.OnKeyDownEvent(lEvent.key);
+    SDL_PushEvent(&lEvent);
+
+    return true;
+}
+
+
+void Application::Invoke(std::function<void()> aTask)
+{
+    if (std::this_thread::get_id() == mThreadId)
+    {
+        aTask();
+        return;
+    }
+
+    std::packaged_task<void()> lTask{std::move(aTask)};
+    auto lDone = lTask.get_future();
+
+    // A task posted after the event loop is over never runs, there is nothing left to wait for.
+    if (Post([&lTask] { lTask(); }))
+        lDone.get();
+}
+
+
+void Application::Run()
+{
+    auto lOpenWindows = mRoutes.size();
+    auto lOverflowing = false;
+
+    for (SDL_Event lEvent;;)
+    {
+        // While a worker holds events back its queue is polled, otherwise the SDL thread sleeps until the next event.
+        const auto lReceived = lOverflowing ? SDL_WaitEventTimeout(&lEvent, OVERFLOW_RETRY_INTERVAL) : SDL_WaitEvent(&lEvent);
+
+        if (lReceived)
+        {
+            if (lEvent.type == SDL_QUIT)
                 break;
-            }
 
-            case SDL_KEYUP:
+            if (lEvent.type == mTaskEvent)
             {
-                const auto& lEventDispatcher = mEventDispatchers.at(lEvent.key.windowID);
-                lEventDispatcher.OnKeyUpEvent(lEvent.key);
-                break;
+                for (const auto& lTask : TakeTasks())
+                    lTask();
             }
-
-            default:
-                break;
+            else if (const auto lRoute = Find(EventDispatcher::GetWindowId(lEvent)); lRoute != mRoutes.cend())
+            {
+                if (lRoute->pWorker)
+                    lRoute->pWorker->Post(lEvent);
+                else
+                    lRoute->pEventDispatcher->Dispatch(lEvent);
+
+                // SDL only sends SDL_QUIT once the last window is closed, the others are hidden until then.
+                if (lEvent.type == SDL_WINDOWEVENT && lEvent.window.event == SDL_WINDOWEVENT_CLOSE)
+                {
+                    SDL_HideWindow(SDL_GetWindowFromID(lRoute->windowId));
+
+                    if (--lOpenWindows == 0)
+                        break;
+                }
             }
         }
-        catch (const std::out_of_range&)
-        {
-        }
+        else if (!lOverflowing)
+            break;
+
+        lOverflowing = false;
+
+        for (const auto& lRoute : mRoutes)
+            if (lRoute.pWorker && !lRoute.pWorker->Flush())
+                lOverflowing = true;
+    }
+
+    // A worker may be waiting in Invoke for a task queued meanwhile, it is run before the workers are joined.
+    {
+        const std::lock_guard lLock{mTaskMutex};
+        mAcceptingTasks = false;
     }
+
+    for (const auto& lTask : TakeTasks())
+        lTask();
+
+    for (const auto& lRoute : mRoutes)
+        if (lRoute.pWorker)
+            lRoute.pWorker->Stop();
 }
 
 
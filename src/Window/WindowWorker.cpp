@@ -0,0 +1,103 @@
+#include "Window/WindowWorker.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include "Window/EventDispatcher.h"
+
+
+
+namespace abollo
+{
+
+
+
+WindowWorker::WindowWorker(const EventDispatcher& aEventDispatcher)
+    : mEventDispatcher{aEventDispatcher}, mSignal{SDL_CreateSemaphore(0), &SDL_DestroySemaphore}
+{
+    if (!mSignal)
+        throw std::runtime_error("Failed to create window worker semaphore.");
+
+    mThread = std::thread{&WindowWorker::Run, this};
+}
+
+
+WindowWorker::~WindowWorker()
+{
+    Stop();
+}
+
+
+void WindowWorker::Post(const SDL_Event& aEvent)
+{
+    Flush();
+
+    if (!mOverflow.empty() || !mEvents.TryPush(aEvent))
+        mOverflow.push_back(aEvent);
+
+    SDL_SemPost(mSignal.get());
+}
+
+
+bool WindowWorker::Flush()
+{
+    while (!mOverflow.empty() && mEvents.TryPush(mOverflow.front()))
+        mOverflow.pop_front();
+
+    return mOverflow.empty();
+}
+
+
+void WindowWorker::Stop()
+{
+    if (!mThread.joinable())
+        return;
+
+    mRunning.store(false, std::memory_order_release);
+    SDL_SemPost(mSignal.get());
+
+    mThread.join();
+}
+
+
+void WindowWorker::Run()
+{
+    std::vector<SDL_Event> lBatch;
+    lBatch.reserve(EVENT_QUEUE_CAPACITY);
+
+    for (;;)
+    {
+        SDL_SemWait(mSignal.get());
+
+        lBatch.clear();
+
+        while (const auto lEvent = mEvents.TryPop())
+        {
+            // Consecutive motion events are merged into one, so a slow repaint never has to catch up with every intermediate position.
+            if (auto& lMotion = lEvent->motion; lMotion.type == SDL_MOUSEMOTION && !lBatch.empty())
+            {
+                if (auto& lLast = lBatch.back().motion; lLast.type == SDL_MOUSEMOTION && lLast.state == lMotion.state)
+                {
+                    lLast.timestamp = lMotion.timestamp;
+                    lLast.x         = lMotion.x;
+                    lLast.y         = lMotion.y;
+                    lLast.xrel += lMotion.xrel;
+                    lLast.yrel += lMotion.yrel;
+                    continue;
+                }
+            }
+
+            lBatch.push_back(*lEvent);
+        }
+
+        for (const auto& lEvent : lBatch)
+            mEventDispatcher.Dispatch(lEvent);
+
+        if (!mRunning.load(std::memory_order_acquire) && mEvents.Empty())
+            break;
+    }
+}
+
+
+
+}    // namespace abollo
\ No newline at end of file